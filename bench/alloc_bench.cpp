@@ -0,0 +1,173 @@
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#define AGM_TRACK_ALLOCATIONS // counts every heap allocation of this program, whatever the build options
+#define ALLOC_TRACKER_IMPLEMENTATION
+
+// Heap allocations per search: what one search's results and prefetch lists cost the general-purpose heap
+// with the containers the app used before SearchArena (std::vector, std::deque, std::unordered_set) and
+// with the arena's pmr vectors. Each search runs the app's steps: reset the previous results, parse a
+// ten-result reply and intern every movie through a RecordRegistry, sort the list, queue every result
+// for prefetch. Counted with AllocTracker, per step. The parse row includes growing movie_list; the rest of
+// it (long titles, registry records and cells) is on the heap either way and is what the arena cannot save.
+// Usage: alloc_bench [--searches N] [--results R]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <alloc_tracker.h>
+#include <movie_core.h>
+#include <movie_registry.h>
+#include <movie_sort.h>
+#include <search_arena.h>
+
+using MovieRef = RecordRegistry<Movie>::Ref;
+
+enum Step { Reset, Parse, Sort, Prefetch, StepCount };
+const char* const kStepNames[StepCount] = { "reset", "parse+intern", "sort", "prefetch" };
+
+// The containers of one search as the app kept them before SearchArena
+struct HeapLists {
+    std::vector<MovieRef> movie_list;
+    std::deque<std::uint32_t> prefetch_queue;
+    std::unordered_set<std::uint32_t> prefetch_requested;
+
+    void Reset() {
+        movie_list = std::vector<MovieRef>(); // results arrived as a fresh vector moved into place
+        prefetch_queue.clear();
+        prefetch_requested.clear();
+    }
+
+    void Queue(std::uint32_t id) {
+        if (!prefetch_requested.insert(id).second) return;
+        prefetch_queue.push_back(id);
+    }
+};
+
+// As the Session keeps them now (see ResetSearchResults and QueuePrefetch in main.cpp)
+struct ArenaLists {
+    SearchArena search_arena;
+    std::pmr::vector<MovieRef> movie_list{ &search_arena };
+    std::pmr::vector<std::uint32_t> prefetch_queue{ &search_arena };
+    std::pmr::vector<std::uint32_t> prefetch_requested{ &search_arena };
+
+    void Reset() {
+        movie_list = std::pmr::vector<MovieRef>(&search_arena);
+        prefetch_queue = std::pmr::vector<std::uint32_t>(&search_arena);
+        prefetch_requested = std::pmr::vector<std::uint32_t>(&search_arena);
+        search_arena.Reset();
+    }
+
+    void Queue(std::uint32_t id) {
+        if (std::find(prefetch_requested.begin(), prefetch_requested.end(), id) != prefetch_requested.end()) return;
+        prefetch_requested.push_back(id);
+        prefetch_queue.push_back(id);
+    }
+};
+
+// Ten-ish results in OMDb's search format; ids repeat across replies now and then, as real searches do
+std::string SearchReply(std::mt19937& random, int results) {
+    static const char* const words[] = { "The", "Night", "Heat", "Return", "of", "the", "Last", "Blue", "City",
+                                         "River", "Dark", "Summer", "King", "Star", "Road", "House" };
+    std::uniform_int_distribution<int> word(0, 15);
+    std::uniform_int_distribution<int> length(1, 5);
+    std::uniform_int_distribution<int> id(1, 20000);
+    std::string reply = "{\"Search\":[";
+    for (int i = 0; i < results; ++i) {
+        std::string title;
+        for (int n = length(random); n > 0; --n) {
+            if (!title.empty()) title += ' ';
+            title += words[word(random)];
+        }
+        if (i > 0) reply += ',';
+        reply += "{\"Title\":\"" + title + "\",\"Year\":\"" +
+                 std::to_string(std::uniform_int_distribution<int>(1920, 2025)(random)) + "\",\"imdbID\":\"tt" +
+                 std::to_string(1000000 + id(random)) + "\",\"Type\":\"movie\",\"Poster\":\"N/A\"}";
+    }
+    return reply + "],\"totalResults\":\"" + std::to_string(results) + "\",\"Response\":\"True\"}";
+}
+
+// InternMovie from main.cpp
+MovieRef Intern(RecordRegistry<Movie>& registry, Movie movie) {
+    MovieRef existing = registry.Find(movie.id);
+    return existing ? existing : registry.Publish(std::move(movie));
+}
+
+struct Totals {
+    AllocTracker::Counts steps[StepCount];
+};
+
+template <typename Lists>
+Totals Run(Lists& lists, const std::vector<std::string>& replies) {
+    RecordRegistry<Movie> registry;
+    movie_sort::SortState state;
+    Totals totals;
+    auto count = [&totals](Step step, auto fn) {
+        AllocTracker::Counts start = AllocTracker::ThreadCounts();
+        fn();
+        AllocTracker::Counts delta = AllocTracker::ThreadCounts() - start;
+        totals.steps[step].allocations += delta.allocations;
+        totals.steps[step].bytes += delta.bytes;
+    };
+    for (const std::string& reply : replies) {
+        count(Reset, [&] {
+            lists.Reset();
+            state.sorted = false;
+        });
+        count(Parse, [&] {
+            ParseSearchResults(reply, [&](Movie&& movie) { lists.movie_list.push_back(Intern(registry, std::move(movie))); });
+        });
+        count(Sort, [&] { movie_sort::Sort(lists.movie_list, state, movie_sort::Column::Title, true); });
+        count(Prefetch, [&] {
+            for (const MovieRef& movie : lists.movie_list) lists.Queue(movie->id);
+        });
+    }
+    lists.Reset();
+    return totals;
+}
+
+int main(int argc, char** argv) {
+    int searches = 1000;
+    int results = 10;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        int value = std::max(1, std::atoi(argv[i + 1]));
+        if (arg == "--searches") searches = value;
+        else if (arg == "--results") results = value;
+        else {
+            std::fprintf(stderr, "usage: alloc_bench [--searches N] [--results R]\n");
+            return 2;
+        }
+    }
+
+    std::mt19937 random(3);
+    std::vector<std::string> replies;
+    for (int i = 0; i < searches; ++i) replies.push_back(SearchReply(random, results));
+
+    HeapLists heap;
+    Totals before = Run(heap, replies);
+    ArenaLists arena;
+    Totals after = Run(arena, replies);
+
+    std::printf("%d searches of %d results; heap allocations (bytes) per search\n", searches, results);
+    std::printf("%-13s %10s %14s\n", "", "before", "SearchArena");
+    double all_before = 0.0;
+    double all_after = 0.0;
+    for (int step = 0; step < StepCount; ++step) {
+        double a = double(before.steps[step].allocations) / searches;
+        double b = double(after.steps[step].allocations) / searches;
+        all_before += a;
+        all_after += b;
+        std::printf("%-13s %5.1f (%5.0f) %7.1f (%5.0f)\n", kStepNames[step], a,
+                    double(before.steps[step].bytes) / searches, b, double(after.steps[step].bytes) / searches);
+    }
+    std::printf("%-13s %5.1f         %7.1f\n", "total", all_before, all_after);
+    std::printf("arena: %llu heap blocks beyond the first over all searches\n",
+                (unsigned long long)arena.search_arena.HeapBlocks());
+    return 0;
+}
@@ -0,0 +1,234 @@
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#define CPPHTTPLIB_LISTEN_BACKLOG 1024 // httplib's default of 5 drops connection bursts into SYN retries
+#define MOVIE_CORE_IMPLEMENTATION
+
+// Hedging, retries and cancellation against a stub server that injects faults: a share of requests gets
+// a 503, a share stalls before answering. Runs:
+//   flaky    through an Engine, --error-rate and --stall-rate as given: how many still succeed, how fast
+//   outage   through an Engine, every request fails: the circuit breaker and the retry budget keep the
+//            server's load near one attempt per request instead of three
+//   retry    RequestResilience alone, every attempt fails, with a budget that never runs out: 3 attempts each
+//   cancel   the same, with each caller giving up after --cancel-ms: backoffs end there, nothing is retried
+//            after that, and the answer comes at once
+// With --serve PORT it only runs the stub, answering every GET with an OMDb "not found" body, so the app
+// or movie_cli can be pointed at it with AGM_REPLAY=http://127.0.0.1:PORT.
+// Usage: fault_bench [--requests N] [--concurrency C] [--error-rate E] [--stall-rate S] [--stall-ms MS]
+//                    [--cancel-ms MS] [--serve PORT]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <movie_core.h>
+
+struct BenchOptions {
+    int requests = 500;
+    int concurrency = 32;
+    double error_rate = 0.2;  // share of requests answered 503
+    double stall_rate = 0.05; // share of requests that stall before answering
+    int stall_ms = 3000;
+    int cancel_ms = 50;
+    int serve_port = 0;
+};
+
+// The faults currently injected; runs change them between phases
+struct Faults {
+    std::atomic<double> error_rate{ 0.0 };
+    std::atomic<double> stall_rate{ 0.0 };
+    std::atomic<int> stall_ms{ 0 };
+    std::atomic<int> hits{ 0 };
+};
+
+class StubServer {
+public:
+    explicit StubServer(Faults& faults) : faults(faults) {
+        server.set_tcp_nodelay(true);
+        server.Get(".*", [this](const httplib::Request&, httplib::Response& res) { Answer(res); });
+    }
+
+    ~StubServer() {
+        server.stop();
+        if (thread.joinable()) thread.join();
+    }
+
+    // Binds port (any free one for 0) and serves on a thread of its own; returns the port, or -1
+    int Start(const std::string& host, int port) {
+        int bound = port == 0 ? server.bind_to_any_port(host) : (server.bind_to_port(host, port) ? port : -1);
+        if (bound > 0) thread = std::thread([this] { server.listen_after_bind(); });
+        return bound;
+    }
+
+    void Wait() { thread.join(); }
+
+private:
+    void Answer(httplib::Response& res) {
+        ++faults.hits;
+        double roll;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            roll = std::uniform_real_distribution<double>(0.0, 1.0)(random);
+        }
+        if (roll < faults.error_rate) {
+            res.status = 503;
+            return;
+        }
+        if (roll < faults.error_rate + faults.stall_rate) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(faults.stall_ms.load()));
+        }
+        res.set_content(R"({"Response":"False","Error":"Movie not found!"})", "application/json");
+    }
+
+    Faults& faults;
+    httplib::Server server;
+    std::thread thread;
+    std::mutex mutex;
+    std::mt19937 random{ 12345 };
+};
+
+struct RunResult {
+    std::vector<double> latencies_ms; // from the start, or from the cancel when callers give up
+    int succeeded = 0;
+};
+
+// Runs start(i, token, done) for every request with at most concurrency outstanding; done(ok) records it.
+// Each token is cancelled after cancel_after when that is set.
+template <typename Start>
+RunResult Measure(event_http::Client& timers, const BenchOptions& options, std::chrono::milliseconds cancel_after,
+                  Start start) {
+    RunResult result;
+    std::mutex mutex;
+    RunConcurrently(std::size_t(options.requests), options.concurrency, CancelToken(),
+                    [&](std::size_t i, std::function<void()> finished) {
+        auto clock = std::make_shared<std::atomic<std::chrono::steady_clock::rep>>(
+            std::chrono::steady_clock::now().time_since_epoch().count());
+        CancelToken token;
+        if (cancel_after.count() > 0) {
+            timers.After(cancel_after, [token, clock] {
+                clock->store(std::chrono::steady_clock::now().time_since_epoch().count());
+                token.cancel();
+            });
+        }
+        start(i, token, [&, clock, finished](bool ok) {
+            auto since = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(clock->load()));
+            std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - since;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                result.latencies_ms.push_back(latency.count());
+                if (ok) ++result.succeeded;
+            }
+            finished();
+        });
+    });
+    std::sort(result.latencies_ms.begin(), result.latencies_ms.end());
+    return result;
+}
+
+double Percentile(const RunResult& result, double p) {
+    if (result.latencies_ms.empty()) return 0.0;
+    return result.latencies_ms[std::min(result.latencies_ms.size() - 1, std::size_t(p * double(result.latencies_ms.size())))];
+}
+
+void Report(const char* name, const RunResult& result, int hits, const RequestResilience::Stats& stats,
+            int requests) {
+    std::printf("%-7s ok %4d/%d  p50 %7.1f ms  p99 %7.1f ms  server hits %5d (%.2f per request)  "
+                "retries %4llu  hedges %4llu (won %llu)  denied %4llu\n",
+                name, result.succeeded, requests, Percentile(result, 0.50), Percentile(result, 0.99), hits,
+                double(hits) / requests, stats.retries, stats.hedges, stats.hedge_wins, stats.budget_denied);
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        const char* value = argv[i + 1];
+        if (arg == "--requests") options.requests = std::max(1, std::atoi(value));
+        else if (arg == "--concurrency") options.concurrency = std::max(1, std::atoi(value));
+        else if (arg == "--error-rate") options.error_rate = std::atof(value);
+        else if (arg == "--stall-rate") options.stall_rate = std::atof(value);
+        else if (arg == "--stall-ms") options.stall_ms = std::atoi(value);
+        else if (arg == "--cancel-ms") options.cancel_ms = std::max(1, std::atoi(value));
+        else if (arg == "--serve") options.serve_port = std::atoi(value);
+        else {
+            std::fprintf(stderr, "usage: fault_bench [--requests N] [--concurrency C] [--error-rate E] "
+                                 "[--stall-rate S] [--stall-ms MS] [--cancel-ms MS] [--serve PORT]\n");
+            return 2;
+        }
+    }
+
+    Faults faults;
+    faults.error_rate = options.error_rate;
+    faults.stall_rate = options.stall_rate;
+    faults.stall_ms = options.stall_ms;
+    StubServer stub(faults);
+
+    if (options.serve_port > 0) {
+        if (stub.Start("127.0.0.1", options.serve_port) < 0) {
+            std::fprintf(stderr, "cannot bind port %d\n", options.serve_port);
+            return 1;
+        }
+        std::printf("serving on 127.0.0.1:%d: %.0f%% 503, %.0f%% stalled for %d ms\n", options.serve_port,
+                    options.error_rate * 100, options.stall_rate * 100, options.stall_ms);
+        stub.Wait();
+        return 0;
+    }
+
+    int port = stub.Start("127.0.0.1", 0);
+    if (port <= 0) {
+        std::fprintf(stderr, "cannot bind a local port\n");
+        return 1;
+    }
+    std::string origin = "http://127.0.0.1:" + std::to_string(port);
+    std::printf("%d requests, %d in flight; flaky: %.0f%% 503, %.0f%% stalled for %d ms\n", options.requests,
+                options.concurrency, options.error_rate * 100, options.stall_rate * 100, options.stall_ms);
+
+    // A fresh engine per run, so one run's open circuit or spent budget does not leak into the next
+    auto engine_run = [&](const char* name) {
+        Engine engine;
+        faults.hits = 0;
+        RunResult result = Measure(engine.http_client, options, std::chrono::milliseconds(0),
+                                   [&](std::size_t i, const CancelToken& token, std::function<void(bool)> done) {
+            HttpGetAsync(engine, origin, std::string("/item?run=") + name + "&n=" + std::to_string(i), {}, token,
+                         [done](HttpResponse res) { done(res.status == 200); });
+        });
+        Report(name, result, faults.hits, engine.http_resilience.GetStats(origin), options.requests);
+    };
+    engine_run("flaky");
+    faults.error_rate = 1.0;
+    faults.stall_rate = 0.0;
+    engine_run("outage");
+
+    // Latency here is from the cancel to the answer
+    auto retry_run = [&](const char* name, std::chrono::milliseconds cancel_after) {
+        RequestResilience::Options generous;
+        generous.budget_per_request = 2.0;
+        generous.budget_cap = 1e9;
+        RequestResilience resilience(generous);
+        event_http::Client client;
+        faults.hits = 0;
+        RunResult result = Measure(client, options, cancel_after,
+                                   [&](std::size_t i, const CancelToken& token, std::function<void(bool)> done) {
+            std::string url = origin + "/item?run=" + name + "&n=" + std::to_string(i);
+            resilience.RunAsync<event_http::Response>(origin, client, token,
+                [&client, url](AttemptControl& control, std::function<void(event_http::Response)> finished) {
+                    std::uint64_t id = client.Get(url, {}, kHttpTimeout, std::move(finished));
+                    control.set_abort([&client, id] { client.Cancel(id); });
+                },
+                [](const event_http::Response& res) { return res.status == 0 || res.status >= 500; },
+                [done](event_http::Response res) { done(res.status == 200); });
+        });
+        // Retries that outlived their callers (there should be none) would reach the server by now
+        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+        Report(name, result, faults.hits, resilience.GetStats(origin), options.requests);
+    };
+    retry_run("retry", std::chrono::milliseconds(0));
+    retry_run("cancel", std::chrono::milliseconds(options.cancel_ms));
+    return 0;
+}
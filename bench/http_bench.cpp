@@ -0,0 +1,180 @@
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#define CPPHTTPLIB_LISTEN_BACKLOG 1024 // httplib's default of 5 drops connection bursts into SYN retries
+#define MOVIE_CORE_IMPLEMENTATION
+
+// Throughput of the request path against a local httplib server, and how many threads it takes.
+// The server runs in a child process, so the thread counts are the client's alone. Three runs over the
+// same URLs (all distinct, so nothing coalesces):
+//   client   event_http::Client on its own, a window of --concurrency requests in flight
+//   engine   HttpGetAsync through an Engine: coalescing, circuit breaker, hedging and retries on top
+//   threads  one blocking HttpGet per thread, the way every fetch used to hold a thread of its own
+// Usage: http_bench [--requests N] [--concurrency C] [--delay-ms D]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <movie_core.h>
+
+struct BenchOptions {
+    int requests = 2000;
+    int concurrency = 256;
+    int delay_ms = 20; // how long the server takes per request
+};
+
+// Threads of this process right now; -1 where /proc is not available
+int ThreadCount() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 8, "Threads:") == 0) return std::atoi(line.c_str() + 8);
+    }
+    return -1;
+}
+
+// Samples ThreadCount while a run is going and keeps the highest, not counting itself
+class ThreadPeak {
+public:
+    ThreadPeak() : sampler([this] {
+        while (!stop) {
+            peak = std::max(peak.load(), ThreadCount() - 1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }) {}
+
+    int Stop() {
+        stop = true;
+        sampler.join();
+        return peak;
+    }
+
+private:
+    std::atomic<bool> stop{ false };
+    std::atomic<int> peak{ 0 };
+    std::thread sampler;
+};
+
+struct RunResult {
+    std::vector<double> latencies_ms;
+    int failed = 0;
+    double seconds = 0.0;
+    int peak_threads = 0;
+};
+
+void Report(const char* name, RunResult& result) {
+    std::sort(result.latencies_ms.begin(), result.latencies_ms.end());
+    auto percentile = [&](double p) {
+        if (result.latencies_ms.empty()) return 0.0;
+        return result.latencies_ms[std::min(result.latencies_ms.size() - 1, std::size_t(p * double(result.latencies_ms.size())))];
+    };
+    std::printf("%-8s %8.0f req/s  p50 %7.1f ms  p99 %7.1f ms  failed %4d  peak threads %4d\n", name,
+                double(result.latencies_ms.size()) / result.seconds, percentile(0.50), percentile(0.99), result.failed,
+                result.peak_threads);
+}
+
+// Runs start(i, done) for every request with at most concurrency outstanding; done(ok) records it
+template <typename Start>
+RunResult Measure(const BenchOptions& options, Start start) {
+    RunResult result;
+    std::mutex mutex;
+    ThreadPeak peak;
+    auto begin = std::chrono::steady_clock::now();
+    RunConcurrently(std::size_t(options.requests), options.concurrency, CancelToken(),
+                    [&](std::size_t i, std::function<void()> finished) {
+        auto started = std::chrono::steady_clock::now();
+        start(i, [&, started, finished](bool ok) {
+            std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - started;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                result.latencies_ms.push_back(latency.count());
+                if (!ok) ++result.failed;
+            }
+            finished();
+        });
+    });
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    result.peak_threads = peak.Stop();
+    return result;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        int value = std::max(1, std::atoi(argv[i + 1]));
+        if (arg == "--requests") options.requests = value;
+        else if (arg == "--concurrency") options.concurrency = value;
+        else if (arg == "--delay-ms") options.delay_ms = std::atoi(argv[i + 1]);
+        else {
+            std::fprintf(stderr, "usage: http_bench [--requests N] [--concurrency C] [--delay-ms D]\n");
+            return 2;
+        }
+    }
+
+    // Bound before forking, so the port is known here and connections queue until the child accepts them
+    httplib::Server server;
+    int delay_ms = options.delay_ms;
+    server.new_task_queue = [&options] { return new httplib::ThreadPool(std::size_t(options.concurrency) + 8); };
+    server.set_tcp_nodelay(true); // headers and body go out as separate writes; Nagle would hold the body back
+    server.Get("/item", [delay_ms](const httplib::Request& req, httplib::Response& res) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+        res.set_content("item " + req.get_param_value("n"), "text/plain");
+    });
+    int port = server.bind_to_any_port("127.0.0.1");
+    if (port <= 0) {
+        std::fprintf(stderr, "cannot bind a local port\n");
+        return 1;
+    }
+    pid_t child = ::fork();
+    if (child == 0) {
+        server.listen_after_bind();
+        std::_Exit(0);
+    }
+
+    std::string origin = "http://127.0.0.1:" + std::to_string(port);
+    std::printf("%d requests, %d in flight, server takes %d ms each\n", options.requests, options.concurrency,
+                options.delay_ms);
+
+    {
+        event_http::Client client;
+        RunResult result = Measure(options, [&](std::size_t i, std::function<void(bool)> done) {
+            client.Get(origin + "/item?run=client&n=" + std::to_string(i), {}, kHttpTimeout,
+                       [done](event_http::Response res) { done(res.status == 200); });
+        });
+        Report("client", result);
+    }
+    {
+        Engine engine;
+        RunResult result = Measure(options, [&](std::size_t i, std::function<void(bool)> done) {
+            HttpGetAsync(engine, origin, "/item?run=engine&n=" + std::to_string(i), {}, CancelToken(),
+                         [done](HttpResponse res) { done(res.status == 200); });
+        });
+        Report("engine", result);
+    }
+    {
+        Engine engine;
+        RunResult result = Measure(options, [&](std::size_t i, std::function<void(bool)> done) {
+            std::thread([&engine, &origin, i, done] {
+                done(HttpGet(engine, origin, "/item?run=threads&n=" + std::to_string(i)).status == 200);
+            }).detach();
+        });
+        Report("threads", result);
+    }
+
+    ::kill(child, SIGTERM);
+    ::waitpid(child, nullptr, 0);
+    return 0;
+}
@@ -0,0 +1,123 @@
+// Cost of IndexedList operations as the list grows: 1k, 100k and 1M items (--sizes to change).
+// Items are watch-list shaped: a numeric id, a title and a year, ordered the way the app's views are.
+// Every operation runs against the full list, so insertion and removal include the shift of the
+// sorted views that indexed_list.h describes.
+// Usage: indexed_list_bench [--ops N] [--sizes 1000,100000,1000000]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <indexed_list.h>
+
+struct Item {
+    std::uint32_t id = 0;
+    std::string title;
+    int year = 0;
+};
+
+struct ItemTraits {
+    static std::uint32_t key(const Item& item) { return item.id; }
+    static bool title_less(const Item& a, const Item& b) { return a.title < b.title; }
+    static bool year_less(const Item& a, const Item& b) {
+        return a.year != b.year ? a.year < b.year : a.title < b.title;
+    }
+    static auto title_rank(const Item& item) {
+        std::uint64_t rank = 0;
+        for (std::size_t i = 0; i < 8; ++i) {
+            rank = rank << 8 | (i < item.title.size() ? static_cast<unsigned char>(item.title[i]) : 0);
+        }
+        return rank;
+    }
+};
+
+using List = IndexedList<Item, std::uint32_t, ItemTraits>;
+
+Item RandomItem(std::mt19937& random, std::uint32_t id) {
+    static const char* const words[] = { "The", "Night", "Heat", "Return", "Of", "Last", "Blue", "City",
+                                         "River", "Dark", "Summer", "King", "Star", "Road", "House", "War" };
+    std::uniform_int_distribution<int> word(0, 15);
+    std::uniform_int_distribution<int> length(1, 4);
+    Item item;
+    item.id = id;
+    for (int i = length(random); i > 0; --i) {
+        if (!item.title.empty()) item.title += ' ';
+        item.title += words[word(random)];
+    }
+    item.title += ' ' + std::to_string(id % 1000);
+    item.year = std::uniform_int_distribution<int>(1920, 2025)(random);
+    return item;
+}
+
+// ns per call of fn(i) for i in [0, ops)
+template <typename F>
+double NsPerOp(int ops, F fn) {
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < ops; ++i) fn(i);
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - begin;
+    return elapsed.count() / ops;
+}
+
+void Run(std::size_t n, int ops) {
+    std::mt19937 random(42);
+    std::vector<Item> items;
+    items.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) items.push_back(RandomItem(random, std::uint32_t(i)));
+
+    List list;
+    auto begin = std::chrono::steady_clock::now();
+    list.assign(items);
+    std::chrono::duration<double, std::milli> assign_ms = std::chrono::steady_clock::now() - begin;
+
+    std::vector<Item> fresh;
+    for (int i = 0; i < ops; ++i) fresh.push_back(RandomItem(random, std::uint32_t(n + i)));
+    std::vector<std::uint32_t> keys;
+    std::uniform_int_distribution<std::uint32_t> any(0, std::uint32_t(n - 1));
+    for (int i = 0; i < ops; ++i) keys.push_back(any(random));
+
+    volatile std::size_t sink = 0;
+    double contains = NsPerOp(ops, [&](int i) { sink = sink + list.contains(keys[i]); });
+    list.set_view(List::Order::Title, true);
+    double row_of = NsPerOp(ops, [&](int i) { sink = sink + list.row_of(keys[i]); });
+    double row = NsPerOp(ops, [&](int i) { sink = sink + list[keys[i] % list.size()].title.size(); });
+    double insert = NsPerOp(ops, [&](int i) { list.insert(fresh[i]); });
+    double update = NsPerOp(ops, [&](int i) {
+        list.update(keys[i], [](Item& item) { item.year = item.year == 2025 ? 1920 : item.year + 1; });
+    });
+    double erase = NsPerOp(ops, [&](int i) { list.erase(fresh[i].id); });
+
+    std::printf("%8zu items  assign %8.1f ms  contains %6.0f ns  row_of %7.0f ns  [row] %5.0f ns  "
+                "insert %9.0f ns  update %9.0f ns  erase %9.0f ns\n",
+                n, assign_ms.count(), contains, row_of, row, insert, update, erase);
+}
+
+int main(int argc, char** argv) {
+    int ops = 2000;
+    std::vector<std::size_t> sizes = { 1000, 100000, 1000000 };
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--ops") {
+            ops = std::max(1, std::atoi(argv[i + 1]));
+        }
+        else if (arg == "--sizes") {
+            sizes.clear();
+            for (const char* p = argv[i + 1]; *p != '\0';) {
+                char* end = nullptr;
+                sizes.push_back(std::max<std::size_t>(1, std::strtoull(p, &end, 10)));
+                p = *end == ',' ? end + 1 : end;
+            }
+        }
+        else {
+            std::fprintf(stderr, "usage: indexed_list_bench [--ops N] [--sizes 1000,100000,1000000]\n");
+            return 2;
+        }
+    }
+    for (std::size_t n : sizes) Run(n, ops);
+    return 0;
+}
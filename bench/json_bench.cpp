@@ -0,0 +1,283 @@
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#define MOVIE_CORE_IMPLEMENTATION
+
+// Decoding OMDb replies into Movie records: ParseMovieDetails and ParseSearchResults (omdb_json.h, one pass,
+// no DOM) against the nlohmann::json parse the app used before, over the same corpus. Both must agree on
+// every record, or the run fails. The default corpus is generated in OMDb's format, not captured from the
+// live API: title replies with every field OMDb sends (Ratings array, escaped quotes and newlines in the
+// plot, \u escapes, en-dash year ranges), ten-result search replies and "not found" replies.
+// --traffic FILE uses the OMDb replies in a log recorded with AGM_RECORD_TRAFFIC instead.
+// Usage: json_bench [--replies N] [--traffic FILE] [--min-ms MS]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <json.hpp>
+
+#include <movie_core.h>
+
+using json = nlohmann::json;
+
+struct Corpus {
+    std::vector<std::string> titles;   // ?i= / ?t= replies
+    std::vector<std::string> searches; // ?s= replies
+    std::vector<std::string> misses;   // "Response":"False"
+};
+
+std::string Pick(std::mt19937& random, std::initializer_list<const char*> choices) {
+    std::uniform_int_distribution<std::size_t> index(0, choices.size() - 1);
+    return *(choices.begin() + index(random));
+}
+
+std::string RandomName(std::mt19937& random) {
+    return Pick(random, { "Tom", "Emma", "Jos\\u00e9", "Zoë", "Cate", "Denis", "Mar\\u00eda", "Ken" }) + " " +
+           Pick(random, { "Hanks", "Stone", "Ferrer", "Kravitz", "Blanchett", "Villeneuve", "Watanabe", "O'Brien" });
+}
+
+std::string RandomTitle(std::mt19937& random) {
+    return Pick(random, { "The", "A", "Return of the", "Night of the", "\\\"Last\\\"" }) + " " +
+           Pick(random, { "River", "King", "Caf\\u00e9", "Summer", "Heat", "Blade Runner", "Amélie" }) +
+           Pick(random, { "", ": Part II", " & Sons", " \\/ Redux" });
+}
+
+// "2010", or for a series "2008–2013" / "2019–" with the en dash raw or as \u2013
+std::string RandomYear(std::mt19937& random, bool series) {
+    int start = std::uniform_int_distribution<int>(1920, 2024)(random);
+    std::string year = std::to_string(start);
+    if (!series) return year;
+    year += std::uniform_int_distribution<int>(0, 1)(random) ? "–" : "\\u2013";
+    if (std::uniform_int_distribution<int>(0, 1)(random)) year += std::to_string(std::min(2025, start + 5));
+    return year;
+}
+
+std::string TitleReply(std::mt19937& random) {
+    std::uniform_int_distribution<int> id(100000, 9999999);
+    bool series = std::uniform_int_distribution<int>(0, 4)(random) == 0;
+    std::string actors = RandomName(random) + ", " + RandomName(random) + ", " + RandomName(random);
+    std::string rating = std::to_string(std::uniform_int_distribution<int>(10, 99)(random));
+    rating.insert(1, ".");
+    return std::string("{\"Title\":\"") + RandomTitle(random) + "\",\"Year\":\"" + RandomYear(random, series) +
+           "\",\"Rated\":\"PG-13\",\"Released\":\"16 Jul 2010\",\"Runtime\":\"" +
+           std::to_string(std::uniform_int_distribution<int>(60, 200)(random)) + " min\",\"Genre\":\"" +
+           Pick(random, { "Action, Adventure, Sci-Fi", "Drama", "Comedy, Romance", "Crime, Drama, Thriller" }) +
+           "\",\"Director\":\"" + (series ? std::string("N/A") : RandomName(random)) +
+           "\",\"Writer\":\"" + RandomName(random) + " (screenplay), " + RandomName(random) +
+           "\",\"Actors\":\"" + actors +
+           "\",\"Plot\":\"A thief who steals \\\"corporate secrets\\\" through the use of dream-sharing technology "
+           "is given the inverse task of planting an idea into the mind of a C.E.O.\\nBut his tragic past may "
+           "doom the project and his team to disaster.\",\"Language\":\"English, Japanese, French\","
+           "\"Country\":\"United States, United Kingdom\",\"Awards\":\"Won 4 Oscars. 159 wins & 220 nominations total\","
+           "\"Poster\":\"https:\\/\\/m.media-amazon.com\\/images\\/M\\/MV5BMjAxMzY3NjcxNF5BMl5BanBnXkFtZTcwNTI5OTM0Mw@@._V1_SX300.jpg\","
+           "\"Ratings\":[{\"Source\":\"Internet Movie Database\",\"Value\":\"" + rating + "/10\"},"
+           "{\"Source\":\"Rotten Tomatoes\",\"Value\":\"87%\"},{\"Source\":\"Metacritic\",\"Value\":\"74/100\"}],"
+           "\"Metascore\":\"74\",\"imdbRating\":\"" + rating + "\",\"imdbVotes\":\"" +
+           std::to_string(std::uniform_int_distribution<int>(1, 2500)(random)) + "," +
+           std::to_string(std::uniform_int_distribution<int>(100, 999)(random)) + "\",\"imdbID\":\"tt" +
+           std::to_string(id(random)) + "\",\"Type\":\"" + (series ? "series" : "movie") +
+           "\",\"DVD\":\"07 Dec 2010\",\"BoxOffice\":\"$292,587,330\",\"Production\":\"N/A\",\"Website\":\"N/A\","
+           "\"Response\":\"True\"}";
+}
+
+std::string SearchReply(std::mt19937& random) {
+    std::uniform_int_distribution<int> id(100000, 9999999);
+    std::string reply = "{\"Search\":[";
+    for (int i = 0; i < 10; ++i) {
+        bool series = std::uniform_int_distribution<int>(0, 4)(random) == 0;
+        if (i > 0) reply += ',';
+        reply += "{\"Title\":\"" + RandomTitle(random) + "\",\"Year\":\"" + RandomYear(random, series) +
+                 "\",\"imdbID\":\"tt" + std::to_string(id(random)) + "\",\"Type\":\"" + (series ? "series" : "movie") +
+                 "\",\"Poster\":\"" +
+                 (i % 4 == 3 ? std::string("N/A")
+                             : "https:\\/\\/m.media-amazon.com\\/images\\/M\\/MV5BMTM0MjUzNjkwMl5BMl5BanBnXkFtZTcwNjY0OTk1Mw@@._V1_SX300.jpg") +
+                 "\"}";
+    }
+    return reply + "],\"totalResults\":\"" + std::to_string(std::uniform_int_distribution<int>(10, 3000)(random)) +
+           "\",\"Response\":\"True\"}";
+}
+
+Corpus Generate(int replies) {
+    std::mt19937 random(7);
+    Corpus corpus;
+    for (int i = 0; i < replies; ++i) {
+        corpus.titles.push_back(TitleReply(random));
+        corpus.searches.push_back(SearchReply(random));
+    }
+    corpus.misses.push_back(R"({"Response":"False","Error":"Movie not found!"})");
+    corpus.misses.push_back(R"({"Response":"False","Error":"Too many results."})");
+    return corpus;
+}
+
+// The OMDb replies (status 200, JSON bodies) in a traffic log
+bool LoadTraffic(const std::string& file, Corpus& corpus) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in) return false;
+    std::string text;
+    while (std::getline(in, text)) {
+        json line = json::parse(text, nullptr, false);
+        if (line.is_discarded() || line.value("status", 0) != 200 || !line.contains("body")) continue;
+        std::string body = line.value("body", std::string());
+        json reply = json::parse(body, nullptr, false);
+        if (reply.is_discarded() || !reply.is_object() || !reply.contains("Response")) continue;
+        if (reply.value("Response", "") != "True") corpus.misses.push_back(std::move(body));
+        else if (reply.contains("Search")) corpus.searches.push_back(std::move(body));
+        else corpus.titles.push_back(std::move(body));
+    }
+    return true;
+}
+
+// How the app decoded replies before omdb_json.h
+void BaselineDetails(const std::string& body, Movie& movie) {
+    json response = json::parse(body);
+    if (response.value("Response", "") != "True") return;
+    movie.title = response.value("Title", movie.title);
+    std::string director = response.value("Director", "");
+    movie.director = director == "N/A" ? 0 : StringInterner::Global().Intern(movie_record::Trim(director));
+    if (response.contains("Year")) {
+        movie_record::ParseYear(response.value("Year", ""), movie.year_start, movie.year_end);
+    }
+    movie.runtime_minutes = movie_record::ParseRuntime(response.value("Runtime", ""));
+    movie.rating_x10 = movie_record::ParseRating(response.value("imdbRating", ""));
+    movie.votes = movie_record::ParseVotes(response.value("imdbVotes", ""));
+    movie.id = movie_record::ParseImdbId(response.value("imdbID", ""));
+    movie.genres = movie_record::ParseGenres(response.value("Genre", ""));
+    movie_sort::ComputeSortKeys(movie);
+    movie.has_details = true;
+    movie.cast_count = 0;
+    movie_record::InternList(response.value("Actors", ""), [&](StringInterner::Handle actor) {
+        if (movie.cast_count < movie.cast.size()) {
+            movie.cast[movie.cast_count++] = actor;
+        }
+    });
+    if (response.contains("Poster") && response["Poster"] != "N/A") {
+        movie.poster_url = response["Poster"].get<std::string>();
+    }
+    else {
+        movie.poster_url = "";
+    }
+}
+
+void BaselineSearch(const std::string& body, std::vector<Movie>& movies) {
+    json response = json::parse(body);
+    if (response["Response"] == "True" && response.contains("Search")) {
+        for (const auto& item : response["Search"]) {
+            Movie movie;
+            movie.id = movie_record::ParseImdbId(item.value("imdbID", ""));
+            movie.title = item.value("Title", "Unknown");
+            movie_record::ParseYear(item.value("Year", ""), movie.year_start, movie.year_end);
+            std::string poster = item.value("Poster", "");
+            movie.poster_url = poster == "N/A" ? "" : poster;
+            movie_sort::ComputeSortKeys(movie);
+            movies.push_back(std::move(movie));
+        }
+    }
+}
+
+bool Same(const Movie& a, const Movie& b) {
+    return a.id == b.id && a.title == b.title && a.year_start == b.year_start && a.year_end == b.year_end &&
+           a.runtime_minutes == b.runtime_minutes && a.rating_x10 == b.rating_x10 && a.votes == b.votes &&
+           a.genres == b.genres && a.director == b.director && a.cast_count == b.cast_count && a.cast == b.cast &&
+           a.poster_url == b.poster_url && a.title_key == b.title_key && a.year_key == b.year_key &&
+           a.has_details == b.has_details;
+}
+
+// us per reply of decode(reply), repeating the corpus for at least min_ms
+template <typename F>
+double UsPerReply(const std::vector<std::string>& replies, double min_ms, F decode) {
+    std::size_t decoded = 0;
+    auto begin = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::milli> elapsed{};
+    do {
+        for (const std::string& reply : replies) decode(reply);
+        decoded += replies.size();
+        elapsed = std::chrono::steady_clock::now() - begin;
+    } while (elapsed.count() < min_ms);
+    return elapsed.count() * 1000.0 / double(decoded);
+}
+
+double MeanBytes(const std::vector<std::string>& replies) {
+    double total = 0.0;
+    for (const std::string& reply : replies) total += double(reply.size());
+    return total / double(replies.size());
+}
+
+int main(int argc, char** argv) {
+    int replies = 1000;
+    std::string traffic;
+    double min_ms = 500.0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--replies") replies = std::max(1, std::atoi(argv[i + 1]));
+        else if (arg == "--traffic") traffic = argv[i + 1];
+        else if (arg == "--min-ms") min_ms = std::max(1.0, std::atof(argv[i + 1]));
+        else {
+            std::fprintf(stderr, "usage: json_bench [--replies N] [--traffic FILE] [--min-ms MS]\n");
+            return 2;
+        }
+    }
+
+    Corpus corpus;
+    if (traffic.empty()) {
+        corpus = Generate(replies);
+    }
+    else if (!LoadTraffic(traffic, corpus)) {
+        std::fprintf(stderr, "cannot read %s\n", traffic.c_str());
+        return 1;
+    }
+    std::printf("corpus: %zu title, %zu search, %zu not-found replies (%s)\n", corpus.titles.size(),
+                corpus.searches.size(), corpus.misses.size(), traffic.empty() ? "generated" : traffic.c_str());
+
+    // Both decoders have to produce the same records before their speed means anything
+    for (const std::string& reply : corpus.titles) {
+        Movie before;
+        Movie after;
+        BaselineDetails(reply, before);
+        if (ParseMovieDetails(reply, after) != omdb_json::Reply::True || !Same(before, after)) {
+            std::fprintf(stderr, "decoders disagree on %s\n", reply.c_str());
+            return 1;
+        }
+    }
+    for (const std::string& reply : corpus.searches) {
+        std::vector<Movie> before;
+        std::vector<Movie> after;
+        BaselineSearch(reply, before);
+        ParseSearchResults(reply, [&](Movie&& movie) { after.push_back(std::move(movie)); });
+        if (!std::equal(before.begin(), before.end(), after.begin(), after.end(), Same)) {
+            std::fprintf(stderr, "decoders disagree on %s\n", reply.c_str());
+            return 1;
+        }
+    }
+
+    auto run = [&](const char* name, const std::vector<std::string>& replies, auto baseline, auto single_pass) {
+        if (replies.empty()) return;
+        double before = UsPerReply(replies, min_ms, baseline);
+        double after = UsPerReply(replies, min_ms, single_pass);
+        std::printf("%-9s %6.0f bytes  nlohmann %7.2f us  omdb_json %6.2f us  (%.1fx)\n", name, MeanBytes(replies),
+                    before, after, before / after);
+    };
+    auto baseline_details = [](const std::string& reply) {
+        Movie movie;
+        BaselineDetails(reply, movie);
+    };
+    auto single_pass_details = [](const std::string& reply) {
+        Movie movie;
+        ParseMovieDetails(reply, movie);
+    };
+    run("title", corpus.titles, baseline_details, single_pass_details);
+    run("search", corpus.searches,
+        [](const std::string& reply) {
+            std::vector<Movie> movies;
+            BaselineSearch(reply, movies);
+        },
+        [](const std::string& reply) {
+            std::vector<Movie> movies;
+            ParseSearchResults(reply, [&](Movie&& movie) { movies.push_back(std::move(movie)); });
+        });
+    run("not found", corpus.misses, baseline_details, single_pass_details);
+    return 0;
+}
@@ -0,0 +1,328 @@
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#define CPPHTTPLIB_LISTEN_BACKLOG 1024 // httplib's default of 5 drops connection bursts into SYN retries
+
+// Load test of `movie_cli serve`. Starts the movie_cli built next to it (or --cli PATH) with a fresh root
+// (AGM_ROOT) and AGM_REPLAY pointing at a stub OMDb in this process, which answers search and title
+// lookups after --upstream-ms. --concurrency clients then send --requests requests in this mix:
+// 40% GET /search over 20 titles, 40% GET /movies/ID over 200 ids, 15% GET of a user's watch list and
+// 5% POST to it (answered after the journal sync). Every other request to a URL the client has seen
+// revalidates it with If-None-Match. Runs:
+//   keepalive  one kept-alive connection per client; the first requests of each URL miss the cache
+//   connect    a new connection per request, as clients without pooling do: what accept and the listen
+//              backlog cost
+// --url http://HOST:PORT load-tests a server that is already running instead (upstream hits are then 0).
+// Usage: serve_bench [--requests N] [--concurrency C] [--jobs J] [--upstream-ms MS] [--cli PATH] [--url URL]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <httplib.h>
+
+#ifndef AGM_MOVIE_CLI
+#define AGM_MOVIE_CLI "movie_cli"
+#endif
+
+struct BenchOptions {
+    int requests = 20000;
+    int concurrency = 64;
+    int jobs = 16;         // serve's worker threads
+    int upstream_ms = 20;  // how long the stub OMDb takes per lookup
+    std::string cli = AGM_MOVIE_CLI;
+    std::string url;
+};
+
+enum Kind { Search, Movie, ListGet, ListAdd, KindCount };
+const char* const kKindNames[KindCount] = { "search", "movie", "list", "list-add" };
+
+constexpr int kTitles = 20;
+constexpr int kIds = 200;
+constexpr int kUsers = 8;
+
+// OMDb answering `movie_cli replay`-style: GET /replay?url=<recorded URL>
+class StubOmdb {
+public:
+    explicit StubOmdb(int delay_ms) : delay_ms(delay_ms) {
+        // Enough workers that the stub's delay, not its queue, is what serve waits for
+        server.new_task_queue = [] { return new httplib::ThreadPool(256); };
+        server.set_tcp_nodelay(true);
+        server.Get("/replay", [this](const httplib::Request& req, httplib::Response& res) { Answer(req, res); });
+    }
+
+    ~StubOmdb() {
+        server.stop();
+        if (thread.joinable()) thread.join();
+    }
+
+    int Start() {
+        int port = server.bind_to_any_port("127.0.0.1");
+        if (port > 0) thread = std::thread([this] { server.listen_after_bind(); });
+        return port;
+    }
+
+    int Hits() const { return hits; }
+
+private:
+    static std::string Param(const std::string& url, const char* name) {
+        std::string key = std::string(name) + "=";
+        std::size_t at = url.find(key);
+        if (at == std::string::npos || (at > 0 && url[at - 1] != '?' && url[at - 1] != '&')) return {};
+        at += key.size();
+        return url.substr(at, url.find('&', at) - at);
+    }
+
+    static std::string TitleReply(const std::string& id) {
+        unsigned n = unsigned(std::strtoul(id.c_str() + 2, nullptr, 10));
+        return "{\"Title\":\"Movie " + std::to_string(n) + "\",\"Year\":\"" + std::to_string(1950 + n % 70) +
+               "\",\"Runtime\":\"" + std::to_string(80 + n % 90) + " min\",\"Genre\":\"Drama, Thriller\","
+               "\"Director\":\"Jane Doe\",\"Actors\":\"Ann Lee, Bo Kim, Cy Diaz\",\"Plot\":\"Someone does something.\","
+               "\"Poster\":\"N/A\",\"imdbRating\":\"7.1\",\"imdbVotes\":\"12,345\",\"imdbID\":\"" + id +
+               "\",\"Type\":\"movie\",\"Response\":\"True\"}";
+    }
+
+    static std::string SearchReply(const std::string& title) {
+        std::size_t hash = std::hash<std::string>()(title);
+        std::string reply = "{\"Search\":[";
+        for (int i = 0; i < 10; ++i) {
+            std::string id = "tt" + std::to_string(1000000 + (hash + std::size_t(i)) % kIds);
+            if (i > 0) reply += ',';
+            reply += "{\"Title\":\"" + title + " " + std::to_string(i) + "\",\"Year\":\"" + std::to_string(1990 + i) +
+                     "\",\"imdbID\":\"" + id + "\",\"Type\":\"movie\",\"Poster\":\"N/A\"}";
+        }
+        return reply + "],\"totalResults\":\"10\",\"Response\":\"True\"}";
+    }
+
+    void Answer(const httplib::Request& req, httplib::Response& res) {
+        ++hits;
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+        std::string url = req.get_param_value("url");
+        std::string id = Param(url, "i");
+        std::string title = Param(url, "s");
+        if (!id.empty()) res.set_content(TitleReply(id), "application/json");
+        else if (!title.empty()) res.set_content(SearchReply(httplib::detail::decode_url(title, true)), "application/json");
+        else res.set_content(R"({"Response":"False","Error":"Incorrect IMDb ID."})", "application/json");
+    }
+
+    int delay_ms;
+    std::atomic<int> hits{ 0 };
+    httplib::Server server;
+    std::thread thread;
+};
+
+// `movie_cli serve` in a child process, rooted in a directory of its own
+class ServeProcess {
+public:
+    ~ServeProcess() { Stop(); }
+
+    bool Start(const BenchOptions& options, int port, int upstream_port) {
+        root = std::filesystem::temp_directory_path() / ("serve_bench_" + std::to_string(::getpid()));
+        std::filesystem::create_directories(root / "users");
+        std::string replay = "http://127.0.0.1:" + std::to_string(upstream_port);
+        std::string port_text = std::to_string(port);
+        std::string jobs_text = std::to_string(options.jobs);
+        child = ::fork();
+        if (child == 0) {
+            ::setenv("AGM_ROOT", root.c_str(), 1);
+            ::setenv("AGM_REPLAY", replay.c_str(), 1);
+            int null = ::open("/dev/null", O_WRONLY);
+            ::dup2(null, STDERR_FILENO); // serve logs every request there
+            ::execl(options.cli.c_str(), options.cli.c_str(), "serve", "--port", port_text.c_str(), "--jobs",
+                    jobs_text.c_str(), static_cast<char*>(nullptr));
+            std::_Exit(127);
+        }
+        return child > 0;
+    }
+
+    bool Running() {
+        return child > 0 && ::waitpid(child, nullptr, WNOHANG) == 0;
+    }
+
+    void Stop() {
+        if (child > 0) {
+            ::kill(child, SIGTERM);
+            ::waitpid(child, nullptr, 0);
+            child = -1;
+        }
+        if (!root.empty()) {
+            std::error_code error;
+            std::filesystem::remove_all(root, error);
+            root.clear();
+        }
+    }
+
+private:
+    pid_t child = -1;
+    std::filesystem::path root;
+};
+
+// A port nothing listens on right now, for the child to take
+int FreePort() {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    int port = -1;
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), length) == 0 &&
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) == 0) {
+        port = ntohs(address.sin_port);
+    }
+    ::close(fd);
+    return port;
+}
+
+struct RunResult {
+    std::vector<double> latencies_ms[KindCount];
+    int not_modified = 0;
+    int failed = 0;
+    double seconds = 0.0;
+};
+
+double Percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    return sorted[std::min(sorted.size() - 1, std::size_t(p * double(sorted.size())))];
+}
+
+RunResult Measure(const BenchOptions& options, const std::string& origin, bool keep_alive) {
+    RunResult result;
+    std::mutex mutex;
+    std::atomic<int> next{ 0 };
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> clients;
+    for (int c = 0; c < options.concurrency; ++c) {
+        clients.emplace_back([&, c] {
+            httplib::Client client(origin);
+            client.set_keep_alive(keep_alive);
+            client.set_tcp_nodelay(true);
+            client.set_read_timeout(std::chrono::seconds(30));
+            std::unordered_map<std::string, std::string> tags; // ETag by URL, as a caching client keeps them
+            RunResult local;
+            for (int i = next++; i < options.requests; i = next++) {
+                int slot = i % 20;
+                Kind kind = slot < 8 ? Search : slot < 16 ? Movie : slot < 19 ? ListGet : ListAdd;
+                std::string user = "bench" + std::to_string(c % kUsers);
+                std::string path;
+                if (kind == Search) path = "/search?s=title" + std::to_string((i / 20) % kTitles);
+                else if (kind == Movie) path = "/movies/tt" + std::to_string(1000000 + (i * 7) % kIds);
+                else path = "/users/" + user + "/watchlist";
+
+                httplib::Headers headers;
+                auto tag = tags.find(path);
+                if (kind != ListAdd && tag != tags.end() && (i / 20) % 2 == 0) {
+                    headers.emplace("If-None-Match", tag->second);
+                }
+                auto started = std::chrono::steady_clock::now();
+                httplib::Result res = kind == ListAdd
+                    ? client.Post(path, headers,
+                                  "{\"imdbID\":\"tt" + std::to_string(1000000 + i % kIds) + "\",\"title\":\"Movie " +
+                                      std::to_string(i % kIds) + "\",\"year\":\"2001\"}",
+                                  "application/json")
+                    : client.Get(path, headers);
+                std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - started;
+                local.latencies_ms[kind].push_back(latency.count());
+                if (!res || res->status >= 400) {
+                    ++local.failed;
+                }
+                else if (res->status == 304) {
+                    ++local.not_modified;
+                }
+                else if (res->has_header("ETag")) {
+                    tags[path] = res->get_header_value("ETag");
+                }
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            for (int k = 0; k < KindCount; ++k) {
+                result.latencies_ms[k].insert(result.latencies_ms[k].end(), local.latencies_ms[k].begin(),
+                                              local.latencies_ms[k].end());
+            }
+            result.not_modified += local.not_modified;
+            result.failed += local.failed;
+        });
+    }
+    for (auto& client : clients) client.join();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return result;
+}
+
+void Report(const char* name, RunResult& result, int upstream_hits) {
+    std::size_t total = 0;
+    for (auto& latencies : result.latencies_ms) total += latencies.size();
+    std::printf("%-9s %8.0f req/s  304 %5d  failed %4d  upstream hits %4d\n", name, double(total) / result.seconds,
+                result.not_modified, result.failed, upstream_hits);
+    for (int k = 0; k < KindCount; ++k) {
+        std::vector<double>& latencies = result.latencies_ms[k];
+        std::sort(latencies.begin(), latencies.end());
+        std::printf("  %-8s %6zu requests  p50 %7.2f ms  p99 %7.2f ms  max %7.1f ms\n", kKindNames[k],
+                    latencies.size(), Percentile(latencies, 0.50), Percentile(latencies, 0.99),
+                    latencies.empty() ? 0.0 : latencies.back());
+    }
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        const char* value = argv[i + 1];
+        if (arg == "--requests") options.requests = std::max(1, std::atoi(value));
+        else if (arg == "--concurrency") options.concurrency = std::max(1, std::atoi(value));
+        else if (arg == "--jobs") options.jobs = std::max(1, std::atoi(value));
+        else if (arg == "--upstream-ms") options.upstream_ms = std::max(0, std::atoi(value));
+        else if (arg == "--cli") options.cli = value;
+        else if (arg == "--url") options.url = value;
+        else {
+            std::fprintf(stderr, "usage: serve_bench [--requests N] [--concurrency C] [--jobs J] [--upstream-ms MS] "
+                                 "[--cli PATH] [--url URL]\n");
+            return 2;
+        }
+    }
+
+    StubOmdb upstream(options.upstream_ms);
+    ServeProcess serve;
+    std::string origin = options.url;
+    if (origin.empty()) {
+        int upstream_port = upstream.Start();
+        int port = FreePort();
+        if (upstream_port <= 0 || port <= 0 || !serve.Start(options, port, upstream_port)) {
+            std::fprintf(stderr, "cannot start the stub OMDb or %s\n", options.cli.c_str());
+            return 1;
+        }
+        origin = "http://127.0.0.1:" + std::to_string(port);
+        // Ready once it answers anything
+        httplib::Client probe(origin);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!probe.Get("/search")) {
+            if (!serve.Running() || std::chrono::steady_clock::now() > deadline) {
+                std::fprintf(stderr, "%s serve did not come up on %s\n", options.cli.c_str(), origin.c_str());
+                return 1;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        std::printf("%s serve --jobs %d, upstream takes %d ms\n", options.cli.c_str(), options.jobs,
+                    options.upstream_ms);
+    }
+    std::printf("%d requests from %d clients against %s\n", options.requests, options.concurrency, origin.c_str());
+
+    RunResult kept = Measure(options, origin, true);
+    int hits = upstream.Hits();
+    Report("keepalive", kept, hits);
+    RunResult fresh = Measure(options, origin, false);
+    Report("connect", fresh, upstream.Hits() - hits);
+    return 0;
+}
@@ -0,0 +1,177 @@
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+
+// Sorting a search-results table of --count movies (100k by default), held the way the app holds it: a vector
+// of registry Refs. Titles and years are random but search-shaped: a few words, many shared prefixes, some
+// series with a year range. Runs, each from the same shuffled order:
+//   baseline  std::sort with the comparator the table used before movie_sort.h: one lambda branching on
+//             column and direction per comparison, titles compared as std::string
+//   serial    std::sort with the movie_sort comparator for the column and direction
+//   sort      movie_sort::Sort: the same comparator, in parallel chunks above kParallelThreshold
+//   flip      movie_sort::Sort after a click on the column that is already sorted: a reverse
+// and then, on the sorted list, the cost of one record changing its title (details arriving):
+//   reposition  movie_sort::Reposition of that record, against a full Sort of the list again
+// Usage: sort_bench [--count N] [--repeat R] [--updates U]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <movie_core.h>
+#include <movie_registry.h>
+#include <movie_sort.h>
+
+using MovieRef = RecordRegistry<Movie>::Ref;
+using movie_sort::Column;
+
+std::string RandomTitle(std::mt19937& random) {
+    static const char* const words[] = { "The", "Night", "Heat", "Return", "of", "the", "Last", "Blue", "City",
+                                         "River", "Dark", "Summer", "King", "Star", "Road", "House", "War",
+                                         "Man", "Love", "Story" };
+    std::uniform_int_distribution<int> word(0, 19);
+    std::uniform_int_distribution<int> length(1, 5);
+    std::string title;
+    for (int i = length(random); i > 0; --i) {
+        if (!title.empty()) title += ' ';
+        title += words[word(random)];
+    }
+    return title;
+}
+
+Movie RandomMovie(std::mt19937& random, std::uint32_t id) {
+    Movie movie;
+    movie.id = id;
+    movie.title = RandomTitle(random);
+    movie.year_start = std::int16_t(std::uniform_int_distribution<int>(1920, 2025)(random));
+    int series = std::uniform_int_distribution<int>(0, 9)(random);
+    if (series == 0) movie.year_end = movie_record::kOpenEnded;
+    else if (series == 1) movie.year_end = std::int16_t(std::min(2025, movie.year_start + 4));
+    movie_sort::ComputeSortKeys(movie);
+    return movie;
+}
+
+// The table's comparator before movie_sort.h, with the column and direction read on every call
+bool sort_by_year = false;
+bool sort_ascending = true;
+
+bool BaselineLess(const MovieRef& first, const MovieRef& second) {
+    const Movie& a = *first;
+    const Movie& b = *second;
+    if (sort_by_year) {
+        const Movie& x = sort_ascending ? a : b;
+        const Movie& y = sort_ascending ? b : a;
+        return x.year_start != y.year_start ? x.year_start < y.year_start : x.year_end < y.year_end;
+    }
+    return sort_ascending ? a.title < b.title : a.title > b.title;
+}
+
+template <typename F>
+double MsPerRun(int repeat, const std::vector<MovieRef>& shuffled, std::vector<MovieRef>& list, F fn) {
+    double total = 0.0;
+    for (int r = 0; r < repeat; ++r) {
+        list = shuffled;
+        auto begin = std::chrono::steady_clock::now();
+        fn();
+        total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    }
+    return total / repeat;
+}
+
+int main(int argc, char** argv) {
+    std::size_t count = 100000;
+    int repeat = 5;
+    int updates = 1000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        int value = std::max(1, std::atoi(argv[i + 1]));
+        if (arg == "--count") count = std::size_t(value);
+        else if (arg == "--repeat") repeat = value;
+        else if (arg == "--updates") updates = value;
+        else {
+            std::fprintf(stderr, "usage: sort_bench [--count N] [--repeat R] [--updates U]\n");
+            return 2;
+        }
+    }
+
+    std::mt19937 random(42);
+    RecordRegistry<Movie> registry;
+    std::vector<MovieRef> shuffled;
+    shuffled.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) shuffled.push_back(registry.Publish(RandomMovie(random, std::uint32_t(i + 1))));
+
+    std::printf("%zu movies, %u hardware threads, parallel above %zu; ms per sort, mean of %d\n", count,
+                std::max(1u, std::thread::hardware_concurrency()), movie_sort::kParallelThreshold, repeat);
+    std::vector<MovieRef> list;
+    for (Column column : { Column::Title, Column::Year }) {
+        for (bool ascending : { true, false }) {
+            sort_by_year = column == Column::Year;
+            sort_ascending = ascending;
+            double baseline = MsPerRun(repeat, shuffled, list, [&] {
+                std::sort(list.begin(), list.end(), BaselineLess);
+            });
+            double serial = MsPerRun(repeat, shuffled, list, [&] {
+                movie_sort::Dispatch(column, ascending, [&](auto cmp) {
+                    std::sort(list.begin(), list.end(), cmp);
+                    return 0;
+                });
+            });
+            double sorted = MsPerRun(repeat, shuffled, list, [&] {
+                movie_sort::SortState state;
+                movie_sort::Sort(list, state, column, ascending);
+            });
+            bool in_order = movie_sort::Dispatch(column, ascending, [&](auto cmp) {
+                return std::is_sorted(list.begin(), list.end(), cmp);
+            });
+            if (!in_order) {
+                std::fprintf(stderr, "list out of order after sort\n");
+                return 1;
+            }
+            double flip = MsPerRun(repeat, shuffled, list, [&] {
+                movie_sort::SortState state{ column, !ascending, true };
+                movie_sort::Sort(list, state, column, ascending);
+            });
+            std::printf("%-5s %-4s  baseline %7.2f  serial %7.2f  sort %7.2f  flip %5.2f\n",
+                        column == Column::Title ? "title" : "year", ascending ? "asc" : "desc", baseline, serial,
+                        sorted, flip);
+        }
+    }
+
+    // Details arriving for one movie at a time: its title changes and the row moves to its new place
+    list = shuffled;
+    movie_sort::SortState state;
+    movie_sort::Sort(list, state, Column::Title, true);
+    std::uniform_int_distribution<std::size_t> any(0, count - 1);
+    std::vector<std::size_t> rows;
+    std::vector<std::string> titles;
+    for (int i = 0; i < updates; ++i) {
+        rows.push_back(any(random));
+        titles.push_back(RandomTitle(random));
+    }
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < updates; ++i) {
+        std::size_t row = rows[std::size_t(i)];
+        Movie movie = *list[row];
+        movie.title = titles[std::size_t(i)];
+        movie_sort::ComputeSortKeys(movie);
+        registry.Publish(std::move(movie));
+        movie_sort::Reposition(list, state, row);
+    }
+    double reposition_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count() / updates;
+    if (!std::is_sorted(list.begin(), list.end(), movie_sort::Comparator<Column::Title, true>{})) {
+        std::fprintf(stderr, "list out of order after reposition\n");
+        return 1;
+    }
+    begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; ++i) {
+        state.sorted = false;
+        movie_sort::Sort(list, state, Column::Title, true);
+    }
+    double resort_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count() / repeat;
+    std::printf("one title change: reposition %.1f us, full re-sort %.1f us\n", reposition_us, resort_us);
+    return 0;
+}
@@ -0,0 +1,158 @@
+// CPU time per frame of a movie table with 1k, 10k and 100k rows (--sizes to change), drawn headless: an
+// ImGui context with a built font atlas and no platform or renderer backend, so NewFrame to Render is all
+// ImGui's own work (layout, clipping, draw lists) and nothing reaches a GPU. Runs:
+//   all      every row submitted each frame with a "title##index" label, the way the tables were drawn before
+//            movie_table.h
+//   clipped  movie_table::Begin and DrawRows as main.cpp uses them: only the rows in view
+// The table sits in a child window 30% of a 1280x800 display high, as in the app, scrolled to the top.
+// Usage: table_bench [--frames N] [--sizes 1000,10000,100000]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <imgui.h>
+
+#include <movie_table.h>
+
+struct Row {
+    std::uint32_t id = 0;
+    std::string title;
+    std::int16_t year_start = 0;
+    std::int16_t year_end = 0;
+};
+
+std::vector<Row> RandomRows(std::size_t count) {
+    static const char* const words[] = { "The", "Night", "Heat", "Return", "of", "the", "Last", "Blue", "City",
+                                         "River", "Dark", "Summer", "King", "Star", "Road", "House" };
+    std::mt19937 random(11);
+    std::uniform_int_distribution<int> word(0, 15);
+    std::uniform_int_distribution<int> length(1, 5);
+    std::vector<Row> rows(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        rows[i].id = std::uint32_t(1000000 + i);
+        for (int n = length(random); n > 0; --n) {
+            if (!rows[i].title.empty()) rows[i].title += ' ';
+            rows[i].title += words[word(random)];
+        }
+        rows[i].year_start = std::int16_t(std::uniform_int_distribution<int>(1920, 2025)(random));
+    }
+    return rows;
+}
+
+// The table as it was drawn before movie_table.h: no ScrollY, so the child window scrolled a table holding
+// every row, each with a label string built for it
+void DrawAllRows(const std::vector<Row>& rows, const std::vector<std::string>& years) {
+    if (!ImGui::BeginTable("AllRowsTable", 2, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Sortable |
+                                           ImGuiTableFlags_Resizable | ImGuiTableFlags_SizingStretchProp)) {
+        return;
+    }
+    for (int i = 0; i < int(rows.size()); ++i) {
+        ImGui::TableNextRow();
+        ImGui::TableSetColumnIndex(0);
+        std::string selectable_label = rows[i].title + "##" + std::to_string(i);
+        ImGui::Selectable(selectable_label.c_str(), false, ImGuiSelectableFlags_SpanAllColumns);
+        ImGui::TableSetColumnIndex(1);
+        ImGui::Text("%s", years[i].c_str());
+    }
+    ImGui::EndTable();
+}
+
+void DrawClipped(const std::vector<Row>& rows) {
+    if (!movie_table::Begin("ClippedTable")) return;
+    bool by_year = false;
+    bool ascending = true;
+    movie_table::SortRequested(by_year, ascending);
+    movie_table::DrawRows(int(rows.size()), -1, [&rows](int i) -> const Row& { return rows[i]; },
+                          [](int i) { return i; }, [](int, bool) {});
+    ImGui::EndTable();
+}
+
+struct FrameStats {
+    double mean_ms = 0.0;
+    double max_ms = 0.0;
+    int vertices = 0;
+};
+
+// One frame from NewFrame to Render per iteration, up to frames of them or about two seconds
+template <typename Draw>
+FrameStats Measure(int frames, Draw draw) {
+    ImGuiIO& io = ImGui::GetIO();
+    FrameStats stats;
+    double total = 0.0;
+    int measured = 0;
+    for (int frame = 0; frame < frames + 2 && total < 2000.0; ++frame) {
+        auto begin = std::chrono::steady_clock::now();
+        io.DeltaTime = 1.0f / 60.0f;
+        ImGui::NewFrame();
+        ImGui::SetNextWindowPos(ImVec2(0, 0));
+        ImGui::SetNextWindowSize(io.DisplaySize);
+        ImGui::Begin("Main", nullptr, ImGuiWindowFlags_NoDecoration);
+        ImGui::BeginChild("Rows", ImVec2(0, io.DisplaySize.y * 0.3f), true);
+        draw();
+        ImGui::EndChild();
+        ImGui::End();
+        ImGui::Render();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+        if (frame < 2) continue; // the first frames size the table's columns
+        total += elapsed.count();
+        stats.max_ms = std::max(stats.max_ms, elapsed.count());
+        ++measured;
+    }
+    stats.mean_ms = total / std::max(1, measured);
+    stats.vertices = ImGui::GetDrawData()->TotalVtxCount;
+    return stats;
+}
+
+int main(int argc, char** argv) {
+    int frames = 300;
+    std::vector<std::size_t> sizes = { 1000, 10000, 100000 };
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--frames") {
+            frames = std::max(1, std::atoi(argv[i + 1]));
+        }
+        else if (arg == "--sizes") {
+            sizes.clear();
+            for (const char* p = argv[i + 1]; *p != '\0';) {
+                char* end = nullptr;
+                sizes.push_back(std::max<std::size_t>(1, std::strtoull(p, &end, 10)));
+                p = *end == ',' ? end + 1 : end;
+            }
+        }
+        else {
+            std::fprintf(stderr, "usage: table_bench [--frames N] [--sizes 1000,10000,100000]\n");
+            return 2;
+        }
+    }
+
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(1280, 800);
+    unsigned char* pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height); // builds the atlas a renderer would upload
+
+    for (std::size_t n : sizes) {
+        std::vector<Row> rows = RandomRows(n);
+        std::vector<std::string> years;
+        years.reserve(n);
+        for (const Row& row : rows) years.push_back(std::to_string(row.year_start));
+
+        FrameStats all = Measure(frames, [&] { DrawAllRows(rows, years); });
+        FrameStats clipped = Measure(frames, [&] { DrawClipped(rows); });
+        std::printf("%7zu rows  all %9.3f ms/frame (max %8.3f, %7d vertices)  clipped %6.3f ms/frame "
+                    "(max %6.3f, %5d vertices)\n",
+                    n, all.mean_ms, all.max_ms, all.vertices, clipped.mean_ms, clipped.max_ms, clipped.vertices);
+    }
+    ImGui::DestroyContext();
+    return 0;
+}
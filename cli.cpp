@@ -0,0 +1,922 @@
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#define CPPHTTPLIB_LISTEN_BACKLOG 1024 // serve and replay: httplib's default of 5 drops connection bursts into SYN retries
+#define MOVIE_CORE_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+
+#include <iostream>
+#include <string>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <thread>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <string_view>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+
+#include <movie_core.h>
+#include <watch_list_store.h>
+#include <watch_list_import.h>
+#include <poster_thumbnail.h>
+
+#include <json.hpp>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+// Headless front end: the lookups, cache, quota and watch-list storage of the desktop app without a window,
+// for scripted bulk work (nightly cache pre-warming, imports) on machines without a display. Every batch
+// command writes one JSON object per line to stdout and a summary to stderr; serve answers the same
+// lookups over HTTP for a whole team from one cache and one quota; replay answers from a recording of the
+// app's traffic, so latency can be measured on machines without network access.
+
+struct Options {
+    std::string command;
+    std::vector<std::string> files; // positional arguments; "-" or none reads stdin
+    std::string user;
+    int jobs = 16;
+    double rate = 0.0; // requests per second over all jobs; 0 is unpaced
+    QuotaManager::Priority priority = QuotaManager::Priority::Interactive;
+    bool posters = false;
+    std::string host = "127.0.0.1"; // serve, replay
+    int port = 8080;
+    double latency_scale = 0.0; // replay: 0 answers at once, 1 as slowly as when recorded
+};
+
+// Counts of one run, printed to stderr at the end
+struct Summary {
+    int found = 0;
+    int not_found = 0;
+    int failed = 0;
+    int deferred = 0;
+    int duplicates = 0;
+};
+
+// Functions:
+
+// General
+bool ParseArguments(int argc, char** argv, Options& options);
+void PrintUsage();
+std::vector<watch_list_import::Item> ReadItems(const std::vector<std::string>& files);
+std::string ItemQuery(const watch_list_import::Item& item);
+void WriteLine(const json& line);
+void PrintSummary(const std::string& command, const Summary& summary);
+int ExitStatus(const Summary& summary);
+
+// Movie
+json MovieJson(const Movie& movie);
+json EntryJson(const WatchListStore::Entry& entry);
+bool MatchesYear(const Movie& movie, const std::string& year);
+const char* StatusName(LookupResult result);
+ImportOptions LookupOptions(const Options& options);
+void Count(Summary& summary, LookupResult result);
+void FetchPosters(Engine& engine, const std::vector<ImportResult>& results, int jobs);
+
+// Commands
+int RunLookup(Engine& engine, const Options& options);
+int RunSearch(Engine& engine, const Options& options);
+int RunImport(Engine& engine, const Options& options);
+int RunExport(const Options& options);
+int RunHydrate(Engine& engine, const Options& options);
+int RunServe(Engine& engine, const Options& options);
+int RunReplay(const Options& options);
+
+// Watch list
+bool OpenWatchList(const std::string& user, WatchListStore& store, std::vector<WatchListStore::Entry>& entries);
+
+// Server
+struct ServedList;
+struct ServerState;
+void SendBody(const httplib::Request& req, httplib::Response& res, std::string body, const char* content_type,
+              const char* cache_control);
+void SendJson(const httplib::Request& req, httplib::Response& res, const json& body, const char* cache_control);
+void SendError(httplib::Response& res, int status, const std::string& message);
+std::string ContentTag(std::string_view body);
+bool TagMatches(const std::string& if_none_match, const std::string& tag);
+int HttpStatus(LookupResult result);
+void HandleSearch(Engine& engine, const httplib::Request& req, httplib::Response& res);
+void HandleMovie(Engine& engine, const httplib::Request& req, httplib::Response& res);
+void HandlePoster(Engine& engine, const httplib::Request& req, httplib::Response& res);
+void HandleListGet(ServerState& state, const httplib::Request& req, httplib::Response& res);
+void HandleListAdd(Engine& engine, ServerState& state, const httplib::Request& req, httplib::Response& res);
+void HandleListRemove(ServerState& state, const httplib::Request& req, httplib::Response& res);
+ServedList* ServedWatchList(ServerState& state, const std::string& user);
+bool ListenUntilStopped(httplib::Server& server, const Options& options);
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseArguments(argc, argv, options)) {
+        PrintUsage();
+        return 2;
+    }
+
+    if (options.command == "replay") {
+        return RunReplay(options); // answers from the log alone, without an engine
+    }
+
+    Engine engine;
+    ConfigureTraffic(engine);
+    read_api_key(engine, 0.0); // nothing here is speculative
+    engine.response_cache.Open(fs::path(GetExecutablePath()) / "cache", kResponseCacheBytes);
+
+    int status = 2;
+    if (options.command == "lookup") status = RunLookup(engine, options);
+    else if (options.command == "search") status = RunSearch(engine, options);
+    else if (options.command == "import") status = RunImport(engine, options);
+    else if (options.command == "export") status = RunExport(options);
+    else if (options.command == "hydrate") status = RunHydrate(engine, options);
+    else if (options.command == "serve") status = RunServe(engine, options);
+
+    engine.omdb_quota.Save();
+    return status;
+}
+
+bool ParseArguments(int argc, char** argv, Options& options) {
+    if (argc < 2) return false;
+    options.command = argv[1];
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--user" && has_value) {
+            options.user = argv[++i];
+        }
+        else if (arg == "--jobs" && has_value) {
+            options.jobs = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--rate" && has_value) {
+            options.rate = std::max(0.0, std::atof(argv[++i]));
+        }
+        else if (arg == "--background") {
+            options.priority = QuotaManager::Priority::Background;
+        }
+        else if (arg == "--posters") {
+            options.posters = true;
+        }
+        else if (arg == "--host" && has_value) {
+            options.host = argv[++i];
+        }
+        else if (arg == "--port" && has_value) {
+            options.port = std::atoi(argv[++i]);
+        }
+        else if (arg == "--latency" && has_value) {
+            options.latency_scale = std::max(0.0, std::atof(argv[++i]));
+        }
+        else if (arg.size() > 1 && arg[0] == '-' && arg != "-") {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return false;
+        }
+        else {
+            options.files.push_back(arg);
+        }
+    }
+
+    bool needs_user = options.command == "import" || options.command == "export" || options.command == "hydrate";
+    if (needs_user && options.user.empty()) {
+        std::cerr << options.command << " needs --user NAME" << std::endl;
+        return false;
+    }
+    if (options.command == "import" && options.files.empty()) {
+        std::cerr << "import needs a file" << std::endl;
+        return false;
+    }
+    if (options.command == "replay" && options.files.size() != 1) {
+        std::cerr << "replay needs one traffic log" << std::endl;
+        return false;
+    }
+    return options.command == "lookup" || options.command == "search" || options.command == "serve" ||
+           options.command == "replay" || needs_user;
+}
+
+void PrintUsage() {
+    std::cerr <<
+        "Usage: movie_cli <command> [options] [FILE...]\n"
+        "\n"
+        "Commands (one JSON object per line on stdout):\n"
+        "  lookup [FILE...]           details for titles or IMDb ids, one per line (\"Heat (1995)\", \"tt0113277\",\n"
+        "                             IMDb URLs) or an IMDb CSV export; stdin when no FILE or \"-\"\n"
+        "  search [FILE...]           search results for each title\n"
+        "  import --user NAME FILE    add the file's movies to NAME's watch list\n"
+        "  export --user NAME         NAME's watch list\n"
+        "  hydrate --user NAME        details for every movie in NAME's watch list\n"
+        "  serve                      HTTP service: GET /search?s=TITLE[&y=YEAR], GET /movies/ID,\n"
+        "                             GET /posters/ID[?w=WIDTH] (PNG thumbnail), GET/POST /users/NAME/watchlist,\n"
+        "                             DELETE /users/NAME/watchlist/ID\n"
+        "  replay FILE                HTTP server answering GET /replay?url=URL from a log recorded with\n"
+        "                             AGM_RECORD_TRAFFIC=FILE; run the app or movie_cli with\n"
+        "                             AGM_REPLAY=http://HOST:PORT to send every request to it\n"
+        "\n"
+        "Options:\n"
+        "  --jobs N        concurrent lookups, or serve's worker threads (default 16); each kept-alive\n"
+        "                  connection holds a worker, so give serve at least as many as it has clients\n"
+        "  --rate R        requests per second over all jobs (default unpaced)\n"
+        "  --background    background quota priority: leaves the day's interactive share to the app\n"
+        "  --posters       lookup, hydrate: download posters too, warming the cache\n"
+        "  --host H        serve, replay: address to listen on (default 127.0.0.1)\n"
+        "  --port P        serve, replay: port (default 8080)\n"
+        "  --latency S     replay: answer after S times the recorded latency (default 0, at once)\n"
+        "\n"
+        "api_key.txt, users/ and cache/ are read from AGM_ROOT, or two levels above the binary.\n";
+}
+
+// Items of every file, in order. Plain lists and IMDb CSV exports are told apart by watch_list_import.
+std::vector<watch_list_import::Item> ReadItems(const std::vector<std::string>& files) {
+    std::vector<watch_list_import::Item> items;
+    std::vector<std::string> paths = files.empty() ? std::vector<std::string>{ "-" } : files;
+    for (const std::string& path : paths) {
+        std::vector<watch_list_import::Item> read;
+        if (path == "-") {
+            std::stringstream contents;
+            contents << std::cin.rdbuf();
+            read = watch_list_import::ParseText(contents.str());
+        }
+        else if (fs::exists(path)) {
+            read = watch_list_import::ParseFile(path);
+        }
+        else {
+            std::cerr << "No such file: " << path << std::endl;
+            continue;
+        }
+        items.insert(items.end(), std::make_move_iterator(read.begin()), std::make_move_iterator(read.end()));
+    }
+    return items;
+}
+
+// The item as the input named it, to match output lines to input lines
+std::string ItemQuery(const watch_list_import::Item& item) {
+    if (!item.id.empty()) return item.id;
+    return item.year.empty() ? item.title : item.title + " (" + item.year + ")";
+}
+
+void WriteLine(const json& line) {
+    std::cout << line.dump(-1, ' ', false, json::error_handler_t::replace) << '\n';
+}
+
+void PrintSummary(const std::string& command, const Summary& summary) {
+    std::cerr << command << ": " << summary.found << " found, " << summary.not_found << " not found, "
+              << summary.failed << " failed, " << summary.deferred << " skipped (request quota reached)";
+    if (summary.duplicates > 0) {
+        std::cerr << ", " << summary.duplicates << " already in the list";
+    }
+    std::cerr << std::endl;
+}
+
+// Failed lookups (network, malformed replies) and quota shortfalls fail the run so a nightly job notices;
+// movies OMDb does not know do not
+int ExitStatus(const Summary& summary) {
+    return summary.failed > 0 || summary.deferred > 0 ? 1 : 0;
+}
+
+// Numbers stay numbers and unknown fields are null
+json MovieJson(const Movie& movie) {
+    char year[32];
+    movie_record::FormatYear(movie.year_start, movie.year_end, year, sizeof(year));
+    json line = {
+        { "imdbID", movie_record::ImdbIdString(movie.id) },
+        { "title", movie.title },
+        { "year", movie.year_start != 0 ? json(year) : json(nullptr) },
+        { "poster", movie.poster_url.empty() || movie.poster_url == "N/A" ? json(nullptr) : json(movie.poster_url) },
+    };
+    if (!movie.has_details) {
+        return line;
+    }
+
+    const std::string& director = StringInterner::Global().Get(movie.director);
+    line["director"] = director.empty() ? json(nullptr) : json(director);
+    line["runtime_minutes"] = movie.runtime_minutes != 0 ? json(movie.runtime_minutes) : json(nullptr);
+    line["rating"] = movie.rating_x10 >= 0 ? json(movie.rating_x10 / 10.0) : json(nullptr);
+    line["votes"] = movie.votes != 0 ? json(movie.votes) : json(nullptr);
+    json genres = json::array();
+    for (std::size_t g = 0; g < movie_record::kGenreNames.size(); ++g) {
+        if (movie.genres & (1u << g)) genres.push_back(movie_record::kGenreNames[g]);
+    }
+    line["genres"] = std::move(genres);
+    json cast = json::array();
+    for (int c = 0; c < movie.cast_count; ++c) {
+        cast.push_back(StringInterner::Global().Get(movie.cast[c]));
+    }
+    line["cast"] = std::move(cast);
+    return line;
+}
+
+json EntryJson(const WatchListStore::Entry& entry) {
+    return { { "imdbID", entry.id }, { "title", entry.title }, { "year", entry.year } };
+}
+
+// Same rule as the app's year field: the year appears in the movie's year or range
+bool MatchesYear(const Movie& movie, const std::string& year) {
+    if (year.empty()) return true;
+    char year_text[16];
+    movie_record::FormatYear(movie.year_start, movie.year_end, year_text, sizeof(year_text));
+    return std::string_view(year_text).find(year) != std::string_view::npos;
+}
+
+const char* StatusName(LookupResult result) {
+    switch (result) {
+        case LookupResult::Found: return "found";
+        case LookupResult::NotFound: return "not_found";
+        case LookupResult::Failed: return "failed";
+        case LookupResult::QuotaExceeded: return "quota_exceeded";
+    }
+    return "failed";
+}
+
+// Details for every item, at full parallelism and with all of today's remaining quota
+ImportOptions LookupOptions(const Options& options) {
+    ImportOptions lookup;
+    lookup.concurrency = options.jobs;
+    lookup.requests_per_second = options.rate;
+    lookup.quota_share = 1.0;
+    lookup.priority = options.priority;
+    lookup.refresh = true;
+    return lookup;
+}
+
+void Count(Summary& summary, LookupResult result) {
+    switch (result) {
+        case LookupResult::Found: ++summary.found; break;
+        case LookupResult::NotFound: ++summary.not_found; break;
+        case LookupResult::Failed: ++summary.failed; break;
+        case LookupResult::QuotaExceeded: ++summary.deferred; break;
+    }
+}
+
+// Downloads go through the same coalescing and cache as the app's, so the app finds the posters on disk
+void FetchPosters(Engine& engine, const std::vector<ImportResult>& results, int jobs) {
+    std::vector<std::string> urls;
+    std::unordered_set<std::string> seen;
+    for (const ImportResult& result : results) {
+        const std::string& url = result.movie.poster_url;
+        if (result.result == LookupResult::Found && !url.empty() && url != "N/A" && seen.insert(url).second) {
+            urls.push_back(url);
+        }
+    }
+    std::atomic<int> failed{ 0 };
+    RunConcurrently(urls.size(), jobs, CancelToken(), [&](std::size_t i, std::function<void()> finished) {
+        auto [host, path] = SplitUrl(urls[i]);
+        HttpGetAsync(engine, host, path, PosterHeaders(), CancelToken(), [&failed, finished](HttpResponse res) {
+            if (res.status != 200) ++failed;
+            finished();
+        });
+    });
+    std::cerr << "posters: " << urls.size() - std::size_t(failed.load()) << " of " << urls.size() << " cached" << std::endl;
+}
+
+int RunLookup(Engine& engine, const Options& options) {
+    std::vector<watch_list_import::Item> items = ReadItems(options.files);
+    watch_list_import::Progress progress;
+    std::vector<ImportResult> results = ResolveImportItems(engine, items, CancelToken(), progress, LookupOptions(options));
+    if (options.posters) {
+        FetchPosters(engine, results, options.jobs);
+    }
+
+    Summary summary;
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        json line = results[i].result == LookupResult::Found ? MovieJson(results[i].movie) : json::object();
+        line["query"] = ItemQuery(items[i]);
+        line["status"] = StatusName(results[i].result);
+        WriteLine(line);
+        Count(summary, results[i].result);
+    }
+    PrintSummary("lookup", summary);
+    return ExitStatus(summary);
+}
+
+// One search per title; a year on the line filters the results the way the app's year field does
+int RunSearch(Engine& engine, const Options& options) {
+    std::vector<watch_list_import::Item> items = ReadItems(options.files);
+    std::vector<HttpResponse> responses(items.size());
+    RunConcurrently(items.size(), options.jobs, CancelToken(), [&](std::size_t i, std::function<void()> finished) {
+        if (items[i].title.empty()) {
+            finished();
+            return;
+        }
+        OmdbGetAsync(engine, SearchQuery(items[i].title), QuotaManager::Priority::Interactive, CancelToken(),
+                     [&responses, i, finished](HttpResponse res) {
+            responses[i] = std::move(res);
+            finished();
+        });
+    });
+
+    Summary summary;
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        const HttpResponse& res = responses[i];
+        std::string query = ItemQuery(items[i]);
+        LookupResult result = LookupResult::Failed;
+        if (items[i].title.empty()) {
+            result = LookupResult::NotFound; // an IMDb id alone is nothing to search for; use lookup
+        }
+        else if (res.status == kQuotaRejectedStatus) {
+            result = LookupResult::QuotaExceeded;
+        }
+        else if (res.status == 200) {
+            const std::string& year = items[i].year;
+            omdb_json::Reply reply = ParseSearchResults(res.body, [&](Movie&& movie) {
+                if (MatchesYear(movie, year)) {
+                    json line = MovieJson(movie);
+                    line["query"] = query;
+                    line["status"] = "found";
+                    WriteLine(line);
+                }
+            });
+            if (reply == omdb_json::Reply::True) result = LookupResult::Found;
+            else if (reply == omdb_json::Reply::False) result = LookupResult::NotFound;
+        }
+        Count(summary, result);
+        if (result != LookupResult::Found) {
+            WriteLine({ { "query", query }, { "status", StatusName(result) } });
+        }
+    }
+    PrintSummary("search", summary);
+    return ExitStatus(summary);
+}
+
+// Same rules as the app's import: entries the list has and repeats within the input are dropped before
+// any request is spent on them, and found movies are journaled as one batch
+int RunImport(Engine& engine, const Options& options) {
+    WatchListStore store;
+    std::vector<WatchListStore::Entry> existing;
+    if (!OpenWatchList(options.user, store, existing)) return 1;
+    std::unordered_set<std::uint32_t> known;
+    for (const WatchListStore::Entry& entry : existing) {
+        known.insert(movie_record::ParseImdbId(entry.id));
+    }
+
+    Summary summary;
+    std::vector<watch_list_import::Item> pending;
+    std::unordered_set<std::string> seen;
+    for (auto& item : ReadItems(options.files)) {
+        std::string key = item.id.empty() ? "title:" + item.title + "|" + item.year : item.id;
+        bool in_list = !item.id.empty() && known.count(movie_record::ParseImdbId(item.id)) != 0;
+        if (in_list || !seen.insert(std::move(key)).second) {
+            WriteLine({ { "query", ItemQuery(item) }, { "status", "duplicate" } });
+            ++summary.duplicates;
+            continue;
+        }
+        pending.push_back(std::move(item));
+    }
+
+    ImportOptions import;
+    import.concurrency = options.jobs;
+    import.requests_per_second = options.rate;
+    import.quota_share = 1.0;
+    import.priority = options.priority;
+    watch_list_import::Progress progress;
+    std::vector<ImportResult> results = ResolveImportItems(engine, pending, CancelToken(), progress, import);
+
+    std::vector<WatchListStore::Entry> entries;
+    for (std::size_t i = 0; i < pending.size(); ++i) {
+        const ImportResult& result = results[i];
+        json line = result.result == LookupResult::Found ? MovieJson(result.movie) : json::object();
+        line["query"] = ItemQuery(pending[i]);
+        if (result.result == LookupResult::Found && !known.insert(result.movie.id).second) {
+            // A title that resolved to a movie the list already has
+            line["status"] = "duplicate";
+            ++summary.duplicates;
+        }
+        else {
+            line["status"] = result.result == LookupResult::Found ? "added" : StatusName(result.result);
+            Count(summary, result.result);
+        }
+        if (line["status"] == "added") {
+            char year_text[16];
+            movie_record::FormatYear(result.movie.year_start, result.movie.year_end, year_text, sizeof(year_text));
+            entries.push_back({ movie_record::ImdbIdString(result.movie.id), result.movie.title, year_text });
+        }
+        WriteLine(line);
+    }
+    store.AppendAdds(entries);
+    store.Close();
+    PrintSummary("import", summary);
+    return ExitStatus(summary);
+}
+
+int RunExport(const Options& options) {
+    WatchListStore store;
+    std::vector<WatchListStore::Entry> entries;
+    if (!OpenWatchList(options.user, store, entries)) return 1;
+    for (const WatchListStore::Entry& entry : entries) {
+        WriteLine(EntryJson(entry));
+    }
+    store.Close();
+    std::cerr << "export: " << entries.size() << " movies" << std::endl;
+    return 0;
+}
+
+// Looks every movie up by id, so the app's hydration and selections are answered from the cache
+int RunHydrate(Engine& engine, const Options& options) {
+    WatchListStore store;
+    std::vector<WatchListStore::Entry> entries;
+    if (!OpenWatchList(options.user, store, entries)) return 1;
+    store.Close(); // read-only from here on
+
+    std::vector<watch_list_import::Item> items;
+    items.reserve(entries.size());
+    for (const WatchListStore::Entry& entry : entries) {
+        items.push_back({ entry.id, entry.title, entry.year });
+    }
+    watch_list_import::Progress progress;
+    std::vector<ImportResult> results = ResolveImportItems(engine, items, CancelToken(), progress, LookupOptions(options));
+    if (options.posters) {
+        FetchPosters(engine, results, options.jobs);
+    }
+
+    Summary summary;
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        json line = results[i].result == LookupResult::Found ? MovieJson(results[i].movie) : json::object();
+        line["query"] = items[i].id;
+        line["status"] = StatusName(results[i].result);
+        WriteLine(line);
+        Count(summary, results[i].result);
+    }
+    PrintSummary("hydrate", summary);
+    return ExitStatus(summary);
+}
+
+// The user's store in the same place the app keeps it, created on first use like a login does
+bool OpenWatchList(const std::string& user, WatchListStore& store, std::vector<WatchListStore::Entry>& entries) {
+    fs::path user_dir = fs::path(GetExecutablePath()) / USER_DIRECTORY;
+    std::error_code error;
+    fs::create_directories(user_dir, error);
+    fs::path user_file = user_dir / (user + ".txt");
+    if (!fs::exists(user_file)) {
+        std::ofstream file(user_file);
+        if (!file.is_open()) {
+            std::cerr << "Unable to create watch list for " << user << " at " << user_file << std::endl;
+            return false;
+        }
+    }
+    std::unordered_set<std::string_view> ids; // views into the open store
+    store.Open(user_dir, user, [&](const WatchListStore::Record& entry) {
+        if (ids.insert(entry.id).second) {
+            entries.push_back({ std::string(entry.id), std::string(entry.title), std::string(entry.year) });
+        }
+    });
+    return true;
+}
+
+// One user's watch list while the server runs: the open store and the live entries it replayed.
+// mutex guards entries and the order of appends; Flush runs outside it so concurrent edits share a sync.
+struct ServedList {
+    std::mutex mutex;
+    WatchListStore store;
+    std::vector<WatchListStore::Entry> entries;
+};
+
+struct ServerState {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::unique_ptr<ServedList>> lists; // opened on first request
+};
+
+// Set by SIGINT/SIGTERM; serve's watcher stops the server when it sees it
+std::atomic<bool> stop_requested{ false };
+
+constexpr const char* kCacheShared = "public, max-age=3600";        // search results and details
+constexpr const char* kCacheImages = "public, max-age=604800";      // thumbnails; a poster hardly changes
+constexpr const char* kCachePrivate = "private, no-cache";          // watch lists: revalidate every time
+constexpr int kDefaultThumbnailWidth = 200;
+
+// Every response is built on the worker thread that received it, through the same single-flight requests,
+// response cache, quota and circuit breakers as the app, so a warm cache answers the whole team.
+int RunServe(Engine& engine, const Options& options) {
+    httplib::Server server;
+    ServerState state;
+    int jobs = options.jobs;
+    server.new_task_queue = [jobs] { return new httplib::ThreadPool(std::size_t(jobs)); };
+
+    server.Get("/search", [&engine](const httplib::Request& req, httplib::Response& res) {
+        HandleSearch(engine, req, res);
+    });
+    server.Get(R"(/movies/(tt\d+))", [&engine](const httplib::Request& req, httplib::Response& res) {
+        HandleMovie(engine, req, res);
+    });
+    server.Get(R"(/posters/(tt\d+))", [&engine](const httplib::Request& req, httplib::Response& res) {
+        HandlePoster(engine, req, res);
+    });
+    server.Get(R"(/users/([A-Za-z0-9_-]+)/watchlist)", [&state](const httplib::Request& req, httplib::Response& res) {
+        HandleListGet(state, req, res);
+    });
+    server.Post(R"(/users/([A-Za-z0-9_-]+)/watchlist)", [&engine, &state](const httplib::Request& req, httplib::Response& res) {
+        HandleListAdd(engine, state, req, res);
+    });
+    server.Delete(R"(/users/([A-Za-z0-9_-]+)/watchlist/(tt\d+))", [&state](const httplib::Request& req, httplib::Response& res) {
+        HandleListRemove(state, req, res);
+    });
+    server.set_logger([](const httplib::Request& req, const httplib::Response& res) {
+        std::cerr << req.method << " " << req.path << " " << res.status << std::endl;
+    });
+
+    bool listened = ListenUntilStopped(server, options);
+    for (auto& [user, list] : state.lists) {
+        list->store.Close();
+    }
+    return listened ? 0 : 1;
+}
+
+// Serves the recordings of one log. Requests of a URL get its recordings in the order they were made, so
+// a replayed session sees the same answers, retries and failures included, as the recorded one.
+int RunReplay(const Options& options) {
+    traffic_log::Replay replay;
+    std::string error;
+    if (!replay.Load(options.files[0], error)) {
+        std::cerr << "replay: " << error << std::endl;
+        return 1;
+    }
+    std::cerr << "replay: " << replay.Size() << " recordings";
+    if (replay.Skipped() > 0) std::cerr << ", " << replay.Skipped() << " unreadable lines skipped";
+    std::cerr << std::endl;
+
+    httplib::Server server;
+    int jobs = options.jobs;
+    server.new_task_queue = [jobs] { return new httplib::ThreadPool(std::size_t(jobs)); };
+
+    double scale = options.latency_scale;
+    server.Get("/replay", [&replay, scale](const httplib::Request& req, httplib::Response& res) {
+        std::string url = req.get_param_value("url");
+        std::optional<traffic_log::Exchange> exchange = replay.Next(url);
+        if (!exchange) {
+            std::cerr << "replay: not recorded: " << url << std::endl;
+            return SendError(res, 404, "not recorded");
+        }
+        if (scale > 0.0) {
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(exchange->latency_ms * scale));
+        }
+        res.status = exchange->status;
+        res.set_content(std::move(exchange->body), "application/octet-stream");
+    });
+
+    return ListenUntilStopped(server, options) ? 0 : 1;
+}
+
+// Blocks until SIGINT or SIGTERM stops the server. False when it could not listen at all.
+bool ListenUntilStopped(httplib::Server& server, const Options& options) {
+    std::signal(SIGINT, [](int) { stop_requested = true; });
+    std::signal(SIGTERM, [](int) { stop_requested = true; });
+    std::atomic<bool> done{ false };
+    std::thread watcher([&] {
+        while (!stop_requested && !done) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+        server.stop();
+    });
+
+    std::cerr << options.command << ": listening on " << options.host << ":" << options.port << " with "
+              << options.jobs << " workers" << std::endl;
+    bool listened = server.listen(options.host, options.port);
+    done = true;
+    watcher.join();
+    if (!listened && !stop_requested) {
+        std::cerr << options.command << ": cannot listen on " << options.host << ":" << options.port << std::endl;
+    }
+    return listened || stop_requested;
+}
+
+// Answers with body, or with 304 when the client's If-None-Match already names it
+void SendBody(const httplib::Request& req, httplib::Response& res, std::string body, const char* content_type,
+              const char* cache_control) {
+    std::string tag = ContentTag(body);
+    res.set_header("ETag", tag);
+    res.set_header("Cache-Control", cache_control);
+    if (TagMatches(req.get_header_value("If-None-Match"), tag)) {
+        res.status = 304;
+        return;
+    }
+    res.set_content(std::move(body), content_type);
+}
+
+void SendJson(const httplib::Request& req, httplib::Response& res, const json& body, const char* cache_control) {
+    SendBody(req, res, body.dump(-1, ' ', false, json::error_handler_t::replace), "application/json", cache_control);
+}
+
+void SendError(httplib::Response& res, int status, const std::string& message) {
+    res.status = status;
+    res.set_header("Cache-Control", "no-store");
+    res.set_content(json({ { "error", message } }).dump(), "application/json");
+}
+
+// Strong validator from the body's FNV-1a hash; equal bodies get equal tags whichever worker built them
+std::string ContentTag(std::string_view body) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (char c : body) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    char tag[24];
+    std::snprintf(tag, sizeof(tag), "\"%016llx\"", static_cast<unsigned long long>(hash));
+    return tag;
+}
+
+// If-None-Match is "*" or a comma-separated list of tags, possibly weak (W/"...")
+bool TagMatches(const std::string& if_none_match, const std::string& tag) {
+    std::string_view rest = if_none_match;
+    while (!rest.empty()) {
+        std::size_t comma = rest.find(',');
+        std::string_view candidate = movie_record::Trim(rest.substr(0, comma));
+        rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+        if (candidate.substr(0, 2) == "W/") candidate.remove_prefix(2);
+        if (candidate == "*" || candidate == tag) return true;
+    }
+    return false;
+}
+
+int HttpStatus(LookupResult result) {
+    switch (result) {
+        case LookupResult::Found: return 200;
+        case LookupResult::NotFound: return 404;
+        case LookupResult::Failed: return 502;
+        case LookupResult::QuotaExceeded: return 429;
+    }
+    return 502;
+}
+
+// GET /search?s=TITLE[&y=YEAR]
+void HandleSearch(Engine& engine, const httplib::Request& req, httplib::Response& res) {
+    std::string title = req.get_param_value("s");
+    std::string year = req.get_param_value("y");
+    if (title.empty()) {
+        return SendError(res, 400, "s (title) is required");
+    }
+
+    HttpResponse found = FetchMovieList(engine, title);
+    if (found.status == kQuotaRejectedStatus) {
+        return SendError(res, 429, "request quota reached");
+    }
+    if (found.status != 200) {
+        return SendError(res, 502, "OMDb is unavailable");
+    }
+    json results = json::array();
+    omdb_json::Reply reply = ParseSearchResults(found.body, [&](Movie&& movie) {
+        if (MatchesYear(movie, year)) results.push_back(MovieJson(movie));
+    });
+    if (reply == omdb_json::Reply::Malformed) {
+        return SendError(res, 502, "invalid response from OMDb");
+    }
+    SendJson(req, res, { { "query", title }, { "results", std::move(results) } }, kCacheShared);
+}
+
+// GET /movies/ID
+void HandleMovie(Engine& engine, const httplib::Request& req, httplib::Response& res) {
+    Movie movie;
+    LookupResult result = RequestMovieDetails(engine, "i=" + std::string(req.matches[1]),
+                                              QuotaManager::Priority::Interactive, movie);
+    if (result != LookupResult::Found) {
+        return SendError(res, HttpStatus(result), StatusName(result));
+    }
+    SendJson(req, res, MovieJson(movie), kCacheShared);
+}
+
+// GET /posters/ID[?w=WIDTH]: the poster as a PNG WIDTH pixels wide. Thumbnails are cached next to the
+// posters and built once however many clients ask for one at the same time.
+void HandlePoster(Engine& engine, const httplib::Request& req, httplib::Response& res) {
+    int width = kDefaultThumbnailWidth;
+    if (req.has_param("w")) {
+        width = std::clamp(std::atoi(req.get_param_value("w").c_str()), poster_thumbnail::kMinWidth,
+                           poster_thumbnail::kMaxWidth);
+    }
+
+    Movie movie;
+    LookupResult result = RequestMovieDetails(engine, "i=" + std::string(req.matches[1]),
+                                              QuotaManager::Priority::Interactive, movie);
+    if (result != LookupResult::Found) {
+        return SendError(res, HttpStatus(result), StatusName(result));
+    }
+    if (movie.poster_url.empty() || movie.poster_url == "N/A") {
+        return SendError(res, 404, "no poster");
+    }
+
+    std::string key = "thumbnail:" + std::to_string(width) + ":" + movie.poster_url;
+    std::optional<HttpResponse> thumbnail = engine.http_requests.Do(key, CancelToken(), [&] {
+        if (std::optional<std::string> cached = engine.response_cache.Get(key)) {
+            return HttpResponse{ 200, std::move(*cached) };
+        }
+        auto [host, path] = SplitUrl(movie.poster_url);
+        HttpResponse poster = HttpGet(engine, host, path, PosterHeaders());
+        if (poster.status != 200) {
+            return HttpResponse{ poster.status, {} };
+        }
+        std::string png = poster_thumbnail::Make(poster.body, width);
+        if (png.empty()) {
+            logError("Failed to decode poster: " + movie.poster_url);
+            return HttpResponse{ 415, {} };
+        }
+        engine.response_cache.Put(key, png);
+        return HttpResponse{ 200, std::move(png) };
+    });
+    if (!thumbnail || thumbnail->status != 200) {
+        return SendError(res, 502, "poster is unavailable");
+    }
+    SendBody(req, res, std::move(thumbnail->body), "image/png", kCacheImages);
+}
+
+// GET /users/NAME/watchlist
+void HandleListGet(ServerState& state, const httplib::Request& req, httplib::Response& res) {
+    ServedList* list = ServedWatchList(state, req.matches[1]);
+    if (list == nullptr) {
+        return SendError(res, 500, "watch list cannot be opened");
+    }
+    json entries = json::array();
+    {
+        std::lock_guard<std::mutex> lock(list->mutex);
+        for (const WatchListStore::Entry& entry : list->entries) {
+            entries.push_back(EntryJson(entry));
+        }
+    }
+    SendJson(req, res, entries, kCachePrivate);
+}
+
+// POST /users/NAME/watchlist with {"imdbID": ...} or {"title": ...[, "year": ...]}. Answers 201 once the
+// entry is on disk, or 200 with the entry the list already had.
+void HandleListAdd(Engine& engine, ServerState& state, const httplib::Request& req, httplib::Response& res) {
+    json body = json::parse(req.body, nullptr, false);
+    if (!body.is_object()) {
+        return SendError(res, 400, "body must be a JSON object");
+    }
+    watch_list_import::Item item;
+    if (body.contains("imdbID") && body["imdbID"].is_string()) {
+        std::uint32_t id = movie_record::ParseImdbId(body["imdbID"].get<std::string>());
+        if (id != 0) item.id = movie_record::ImdbIdString(id);
+    }
+    if (body.contains("title") && body["title"].is_string()) item.title = body["title"].get<std::string>();
+    if (body.contains("year") && body["year"].is_string()) item.year = body["year"].get<std::string>();
+    if (item.id.empty() && item.title.empty()) {
+        return SendError(res, 400, "imdbID or title is required");
+    }
+
+    ServedList* list = ServedWatchList(state, req.matches[1]);
+    if (list == nullptr) {
+        return SendError(res, 500, "watch list cannot be opened");
+    }
+
+    // Looked up before taking the list's lock, so one slow lookup holds up nobody else's edits
+    ImportOptions lookup;
+    Movie movie;
+    LookupResult result = LookupImportItem(engine, item, movie, lookup);
+    if (result != LookupResult::Found) {
+        return SendError(res, HttpStatus(result), StatusName(result));
+    }
+    char year_text[16];
+    movie_record::FormatYear(movie.year_start, movie.year_end, year_text, sizeof(year_text));
+    WatchListStore::Entry entry{ movie_record::ImdbIdString(movie.id), movie.title, year_text };
+
+    {
+        std::lock_guard<std::mutex> lock(list->mutex);
+        auto existing = std::find_if(list->entries.begin(), list->entries.end(),
+                                     [&](const WatchListStore::Entry& e) { return e.id == entry.id; });
+        if (existing != list->entries.end()) {
+            res.status = 200;
+            res.set_header("Cache-Control", "no-store");
+            res.set_content(EntryJson(*existing).dump(-1, ' ', false, json::error_handler_t::replace), "application/json");
+            return;
+        }
+        list->entries.push_back(entry);
+        list->store.AppendAdd(entry);
+    }
+    list->store.Flush();
+
+    res.status = 201;
+    res.set_header("Location", req.path + "/" + entry.id);
+    res.set_header("Cache-Control", "no-store");
+    res.set_content(EntryJson(entry).dump(-1, ' ', false, json::error_handler_t::replace), "application/json");
+}
+
+// DELETE /users/NAME/watchlist/ID
+void HandleListRemove(ServerState& state, const httplib::Request& req, httplib::Response& res) {
+    ServedList* list = ServedWatchList(state, req.matches[1]);
+    if (list == nullptr) {
+        return SendError(res, 500, "watch list cannot be opened");
+    }
+    std::string id = req.matches[2];
+    {
+        std::lock_guard<std::mutex> lock(list->mutex);
+        auto existing = std::find_if(list->entries.begin(), list->entries.end(),
+                                     [&](const WatchListStore::Entry& e) { return e.id == id; });
+        if (existing == list->entries.end()) {
+            return SendError(res, 404, "not in the watch list");
+        }
+        list->entries.erase(existing);
+        list->store.AppendRemove(id);
+    }
+    list->store.Flush();
+    res.status = 204;
+}
+
+// The user's list, opened on first use and kept open until the server stops; nullptr if it cannot be opened
+ServedList* ServedWatchList(ServerState& state, const std::string& user) {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    std::unique_ptr<ServedList>& list = state.lists[user];
+    if (!list) {
+        auto opened = std::make_unique<ServedList>();
+        if (!OpenWatchList(user, opened->store, opened->entries)) {
+            state.lists.erase(user);
+            return nullptr;
+        }
+        list = std::move(opened);
+    }
+    return list.get();
+}
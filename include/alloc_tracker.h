@@ -0,0 +1,207 @@
+//
+// Opt-in heap allocation tracker. Build with AGM_TRACK_ALLOCATIONS and define ALLOC_TRACKER_IMPLEMENTATION
+// in exactly one source file to replace the global operator new/delete with counting versions.
+//
+
+#ifndef FINALPROJECT_ALLOC_TRACKER_H
+#define FINALPROJECT_ALLOC_TRACKER_H
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+class AllocTracker {
+public:
+    static constexpr int kMaxScopes = 16;
+    static constexpr int kWarmupFrames = 120; // ImGui and the caches grow during the first frames
+
+    struct Counts {
+        std::uint64_t allocations = 0;
+        std::uint64_t frees = 0;
+        std::uint64_t bytes = 0;
+
+        Counts operator-(const Counts& other) const {
+            return { allocations - other.allocations, frees - other.frees, bytes - other.bytes };
+        }
+    };
+
+    static constexpr bool Enabled() {
+#ifdef AGM_TRACK_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Hooks called by the replaced operators.
+    static void RecordAlloc(std::size_t size) {
+        Counts& counts = thread_counts();
+        ++counts.allocations;
+        counts.bytes += size;
+        process_allocations().fetch_add(1, std::memory_order_relaxed);
+        process_bytes().fetch_add(size, std::memory_order_relaxed);
+    }
+
+    static void RecordFree() {
+        ++thread_counts().frees;
+    }
+
+    // Allocations made by the calling thread so far.
+    static Counts ThreadCounts() { return thread_counts(); }
+
+    static std::uint64_t ProcessAllocations() { return process_allocations().load(std::memory_order_relaxed); }
+    static std::uint64_t ProcessBytes() { return process_bytes().load(std::memory_order_relaxed); }
+
+    // Finds or registers a named scope. Names must be string literals.
+    int ScopeId(const char* name) {
+        for (int i = 0; i < scope_count; ++i) {
+            if (std::strcmp(scope_names[i], name) == 0) return i;
+        }
+        if (scope_count == kMaxScopes) return -1;
+        scope_names[scope_count] = name;
+        return scope_count++;
+    }
+
+    // Per-frame accounting covers the thread that calls BeginFrame/EndFrame (the UI thread);
+    // background downloads and decodes are expected to allocate.
+    void BeginFrame() {
+        frame_start = ThreadCounts();
+        scope_frame.fill(Counts{});
+    }
+
+    // Returns false when a steady-state idle frame allocated.
+    bool EndFrame(bool idle_frame) {
+        last_frame = ThreadCounts() - frame_start;
+        scope_last = scope_frame;
+        ++frames;
+        if (!idle_frame || frames <= kWarmupFrames) {
+            return true;
+        }
+        ++idle_frames;
+        if (last_frame.allocations == 0) {
+            return true;
+        }
+        ++idle_frames_with_allocations;
+        last_idle_violation = last_frame;
+        return false;
+    }
+
+    void AddToScope(int scope, const Counts& delta) {
+        if (scope < 0 || scope >= scope_count) return;
+        scope_frame[scope].allocations += delta.allocations;
+        scope_frame[scope].frees += delta.frees;
+        scope_frame[scope].bytes += delta.bytes;
+    }
+
+    const Counts& LastFrame() const { return last_frame; }
+    const Counts& LastIdleViolation() const { return last_idle_violation; }
+    std::uint64_t IdleFrames() const { return idle_frames; }
+    std::uint64_t IdleFramesWithAllocations() const { return idle_frames_with_allocations; }
+    int ScopeCount() const { return scope_count; }
+    const char* ScopeName(int scope) const { return scope_names[scope]; }
+    const Counts& ScopeLastFrame(int scope) const { return scope_last[scope]; }
+
+private:
+    static Counts& thread_counts() {
+        static thread_local Counts counts;
+        return counts;
+    }
+
+    static std::atomic<std::uint64_t>& process_allocations() {
+        static std::atomic<std::uint64_t> value{ 0 };
+        return value;
+    }
+
+    static std::atomic<std::uint64_t>& process_bytes() {
+        static std::atomic<std::uint64_t> value{ 0 };
+        return value;
+    }
+
+    std::array<const char*, kMaxScopes> scope_names{};
+    std::array<Counts, kMaxScopes> scope_frame{};
+    std::array<Counts, kMaxScopes> scope_last{};
+    int scope_count = 0;
+
+    Counts frame_start;
+    Counts last_frame;
+    Counts last_idle_violation;
+    std::uint64_t frames = 0;
+    std::uint64_t idle_frames = 0;
+    std::uint64_t idle_frames_with_allocations = 0;
+};
+
+// Attributes the calling thread's allocations inside the enclosing scope to a named bucket.
+class AllocScope {
+public:
+    AllocScope(AllocTracker& tracker, int scope)
+        : tracker(tracker), scope(scope), start(AllocTracker::ThreadCounts()) {}
+
+    ~AllocScope() {
+        tracker.AddToScope(scope, AllocTracker::ThreadCounts() - start);
+    }
+
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+private:
+    AllocTracker& tracker;
+    int scope;
+    AllocTracker::Counts start;
+};
+
+#if defined(ALLOC_TRACKER_IMPLEMENTATION) && defined(AGM_TRACK_ALLOCATIONS)
+
+namespace alloc_tracker_detail {
+    inline void* Allocate(std::size_t size) {
+        AllocTracker::RecordAlloc(size);
+        if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+        throw std::bad_alloc();
+    }
+
+    inline void* AllocateAligned(std::size_t size, std::align_val_t alignment) {
+        AllocTracker::RecordAlloc(size);
+        std::size_t align = static_cast<std::size_t>(alignment);
+        std::size_t rounded = (size + align - 1) / align * align; // aligned_alloc wants a multiple of the alignment
+        if (void* p = std::aligned_alloc(align, rounded == 0 ? align : rounded)) return p;
+        throw std::bad_alloc();
+    }
+
+    inline void Free(void* p) noexcept {
+        if (p == nullptr) return;
+        AllocTracker::RecordFree();
+        std::free(p);
+    }
+}
+
+void* operator new(std::size_t size) { return alloc_tracker_detail::Allocate(size); }
+void* operator new[](std::size_t size) { return alloc_tracker_detail::Allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return alloc_tracker_detail::AllocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return alloc_tracker_detail::AllocateAligned(size, alignment); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try { return alloc_tracker_detail::Allocate(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try { return alloc_tracker_detail::Allocate(size); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept { alloc_tracker_detail::Free(p); }
+void operator delete[](void* p) noexcept { alloc_tracker_detail::Free(p); }
+void operator delete(void* p, std::size_t) noexcept { alloc_tracker_detail::Free(p); }
+void operator delete[](void* p, std::size_t) noexcept { alloc_tracker_detail::Free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { alloc_tracker_detail::Free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { alloc_tracker_detail::Free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { alloc_tracker_detail::Free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { alloc_tracker_detail::Free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { alloc_tracker_detail::Free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { alloc_tracker_detail::Free(p); }
+
+#endif
+
+#endif //FINALPROJECT_ALLOC_TRACKER_H
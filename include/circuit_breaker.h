@@ -0,0 +1,104 @@
+//
+// Per-host circuit breakers.
+// After kFailureThreshold consecutive failures a host's circuit opens and requests to it are refused
+// without touching the network. Once the cooldown has passed one probe request is let through
+// (half-open): success closes the circuit, failure reopens it with twice the cooldown, up to kMaxCooldown.
+//
+
+#ifndef FINALPROJECT_CIRCUIT_BREAKER_H
+#define FINALPROJECT_CIRCUIT_BREAKER_H
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+class CircuitBreaker {
+public:
+    enum class State { Closed, Open, HalfOpen };
+
+    static constexpr int kFailureThreshold = 3;
+    static constexpr std::chrono::seconds kInitialCooldown{ 5 };
+    static constexpr std::chrono::seconds kMaxCooldown{ 60 };
+
+    // True if a request to host may go out now. In half-open state only the first caller gets through;
+    // it must report back with Record.
+    bool Allow(const std::string& host) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Circuit& circuit = circuits[host];
+        switch (circuit.state) {
+            case State::Closed:
+                return true;
+            case State::Open:
+                if (std::chrono::steady_clock::now() < circuit.opened_at + circuit.cooldown) return false;
+                circuit.state = State::HalfOpen;
+                circuit.probe_in_flight = true;
+                return true;
+            case State::HalfOpen:
+                if (circuit.probe_in_flight) return false;
+                circuit.probe_in_flight = true;
+                return true;
+        }
+        return true;
+    }
+
+    void Record(const std::string& host, bool success) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Circuit& circuit = circuits[host];
+        circuit.probe_in_flight = false;
+        if (success) {
+            circuit.state = State::Closed;
+            circuit.failures = 0;
+            circuit.cooldown = kInitialCooldown;
+            return;
+        }
+        if (circuit.state == State::HalfOpen) {
+            circuit.cooldown = std::min<std::chrono::steady_clock::duration>(circuit.cooldown * 2, kMaxCooldown);
+            Open(circuit);
+        }
+        else if (++circuit.failures >= kFailureThreshold && circuit.state == State::Closed) {
+            Open(circuit);
+        }
+    }
+
+    // The caller let through gave up before reaching the host (e.g. no quota); nothing was learned.
+    void Abandon(const std::string& host) {
+        std::lock_guard<std::mutex> lock(mutex);
+        circuits[host].probe_in_flight = false;
+    }
+
+    State GetState(const std::string& host) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = circuits.find(host);
+        return it == circuits.end() ? State::Closed : it->second.state;
+    }
+
+    // Hosts whose circuit is not closed.
+    int OpenCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return int(std::count_if(circuits.begin(), circuits.end(),
+                                 [](const auto& entry) { return entry.second.state != State::Closed; }));
+    }
+
+private:
+    struct Circuit {
+        State state = State::Closed;
+        int failures = 0;
+        bool probe_in_flight = false;
+        std::chrono::steady_clock::time_point opened_at;
+        std::chrono::steady_clock::duration cooldown = kInitialCooldown;
+    };
+
+    static void Open(Circuit& circuit) {
+        circuit.state = State::Open;
+        circuit.opened_at = std::chrono::steady_clock::now();
+    }
+
+    mutable std::mutex mutex;
+    std::map<std::string, Circuit> circuits;
+};
+
+#endif //FINALPROJECT_CIRCUIT_BREAKER_H
@@ -0,0 +1,128 @@
+//
+// Vectorized search for field and record delimiters in pipe-delimited text.
+// 64-byte blocks are reduced to a bitmask of delimiter positions with AVX2 when the CPU has it,
+// SSE2 otherwise on x86, and a scalar loop elsewhere; callers walk the set bits.
+//
+
+#ifndef FINALPROJECT_DELIMITER_SCAN_H
+#define FINALPROJECT_DELIMITER_SCAN_H
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DELIMITER_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace delimiter_scan {
+
+    inline std::uint64_t MaskScalar(const char* p, char a, char b) {
+        std::uint64_t mask = 0;
+        for (int i = 0; i < 64; ++i) {
+            if (p[i] == a || p[i] == b) mask |= std::uint64_t(1) << i;
+        }
+        return mask;
+    }
+
+#ifdef DELIMITER_SCAN_X86
+    inline std::uint64_t MaskSse2(const char* p, char a, char b) {
+        const __m128i va = _mm_set1_epi8(a);
+        const __m128i vb = _mm_set1_epi8(b);
+        std::uint64_t mask = 0;
+        for (int i = 0; i < 4; ++i) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+            __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(bytes, va), _mm_cmpeq_epi8(bytes, vb));
+            mask |= std::uint64_t(std::uint32_t(_mm_movemask_epi8(hits))) << (16 * i);
+        }
+        return mask;
+    }
+
+    __attribute__((target("avx2"))) inline std::uint64_t MaskAvx2(const char* p, char a, char b) {
+        const __m256i va = _mm256_set1_epi8(a);
+        const __m256i vb = _mm256_set1_epi8(b);
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+        __m256i hits_lo = _mm256_or_si256(_mm256_cmpeq_epi8(lo, va), _mm256_cmpeq_epi8(lo, vb));
+        __m256i hits_hi = _mm256_or_si256(_mm256_cmpeq_epi8(hi, va), _mm256_cmpeq_epi8(hi, vb));
+        return std::uint64_t(std::uint32_t(_mm256_movemask_epi8(hits_lo))) |
+               (std::uint64_t(std::uint32_t(_mm256_movemask_epi8(hits_hi))) << 32);
+    }
+
+    inline bool HasAvx2() {
+        static const bool has_avx2 = __builtin_cpu_supports("avx2");
+        return has_avx2;
+    }
+#endif
+
+    inline int CountTrailingZeros(std::uint64_t mask) {
+#if defined(__GNUC__)
+        return __builtin_ctzll(mask);
+#else
+        int n = 0;
+        while ((mask & 1) == 0) {
+            mask >>= 1;
+            ++n;
+        }
+        return n;
+#endif
+    }
+
+    // Calls fn(offset) for every byte equal to a or b, in order.
+    template <typename F>
+    void ForEach(std::string_view text, char a, char b, F fn) {
+        const char* data = text.data();
+        std::size_t size = text.size();
+        std::size_t offset = 0;
+
+        using MaskFn = std::uint64_t (*)(const char*, char, char);
+        MaskFn mask_of = MaskScalar;
+#ifdef DELIMITER_SCAN_X86
+        mask_of = HasAvx2() ? MaskAvx2 : MaskSse2;
+#endif
+        for (; offset + 64 <= size; offset += 64) {
+            for (std::uint64_t mask = mask_of(data + offset, a, b); mask != 0; mask &= mask - 1) {
+                fn(offset + std::size_t(CountTrailingZeros(mask)));
+            }
+        }
+        for (; offset < size; ++offset) {
+            if (data[offset] == a || data[offset] == b) fn(offset);
+        }
+    }
+
+    // Splits text into lines and each line at its first kMaxFields - 1 '|' separators.
+    // fn(fields, count) receives the fields of every non-empty line; the last field runs to the end
+    // of the line, so it may itself contain '|'. A final line without '\n' is included.
+    template <int kMaxFields, typename F>
+    void ForEachRecord(std::string_view text, F fn) {
+        std::string_view fields[kMaxFields];
+        std::size_t line_start = 0;
+        std::size_t field_start = 0;
+        int count = 0;
+
+        auto finish_line = [&](std::size_t end) {
+            if (end > line_start) {
+                fields[count++] = text.substr(field_start, end - field_start);
+                fn(fields, count);
+            }
+        };
+
+        ForEach(text, '|', '\n', [&](std::size_t offset) {
+            if (text[offset] == '\n') {
+                finish_line(offset);
+                line_start = field_start = offset + 1;
+                count = 0;
+            }
+            else if (count < kMaxFields - 1) {
+                fields[count++] = text.substr(field_start, offset - field_start);
+                field_start = offset + 1;
+            }
+        });
+        finish_line(text.size());
+    }
+
+} // namespace delimiter_scan
+
+#endif //FINALPROJECT_DELIMITER_SCAN_H
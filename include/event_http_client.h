@@ -0,0 +1,1164 @@
+//
+// Non-blocking HTTP/1.1 client: one I/O thread multiplexes every connection with epoll (poll() where
+// epoll is unavailable), TLS runs through OpenSSL in non-blocking mode, and finished connections are kept
+// alive per host for reuse. Requests carry a deadline and complete through a callback invoked on the I/O
+// thread, so callbacks must only hand the result off. Timers (After) run on the same thread, so callers
+// can wait out a backoff or a hedge delay without a thread of their own.
+// GET only, without compression; redirects are followed. Host names are resolved on a resolver thread
+// and cached, so a slow DNS answer only holds up the requests for that host.
+//
+
+#ifndef FINALPROJECT_EVENT_HTTP_CLIENT_H
+#define FINALPROJECT_EVENT_HTTP_CLIENT_H
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+namespace event_http {
+
+    using Headers = std::vector<std::pair<std::string, std::string>>;
+
+    struct Response {
+        int status = 0;    // 0 when no response arrived; see error
+        std::string body;
+        std::string error; // empty on success
+    };
+
+    using Callback = std::function<void(Response)>;
+
+    struct Url {
+        bool tls = false;
+        std::string host;
+        int port = 0;
+        std::string target; // path and query
+
+        // "https://host[:port]/path?query"; a missing path becomes "/".
+        static std::optional<Url> Parse(std::string_view text) {
+            Url url;
+            if (text.substr(0, 8) == "https://") {
+                url.tls = true;
+                text.remove_prefix(8);
+            }
+            else if (text.substr(0, 7) == "http://") {
+                text.remove_prefix(7);
+            }
+            else {
+                return std::nullopt;
+            }
+            std::size_t slash = text.find('/');
+            std::string_view authority = text.substr(0, slash);
+            url.target = slash == std::string_view::npos ? "/" : std::string(text.substr(slash));
+            std::size_t colon = authority.rfind(':');
+            if (colon != std::string_view::npos) {
+                url.port = std::atoi(std::string(authority.substr(colon + 1)).c_str());
+                authority = authority.substr(0, colon);
+            }
+            if (url.port <= 0) url.port = url.tls ? 443 : 80;
+            url.host = std::string(authority);
+            if (url.host.empty()) return std::nullopt;
+            return url;
+        }
+
+        std::string Origin() const {
+            std::string origin = (tls ? "https://" : "http://") + host;
+            if (port != (tls ? 443 : 80)) origin += ":" + std::to_string(port);
+            return origin;
+        }
+
+        std::string PoolKey() const { return Origin(); }
+    };
+
+    // Readiness notification: epoll on Linux, poll() elsewhere.
+    class Poller {
+    public:
+        struct Event {
+            void* tag = nullptr;
+            bool readable = false;
+            bool writable = false;
+            bool failed = false;
+        };
+
+        Poller() {
+#ifdef __linux__
+            epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+#endif
+        }
+
+        ~Poller() {
+#ifdef __linux__
+            if (epoll_fd >= 0) ::close(epoll_fd);
+#endif
+        }
+
+        Poller(const Poller&) = delete;
+        Poller& operator=(const Poller&) = delete;
+
+        void Set(int fd, bool read, bool write, void* tag) {
+#ifdef __linux__
+            epoll_event event{};
+            event.events = (read ? EPOLLIN : 0u) | (write ? EPOLLOUT : 0u) | EPOLLRDHUP;
+            event.data.ptr = tag;
+            if (::epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event) != 0) {
+                ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+            }
+#else
+            short events = short((read ? POLLIN : 0) | (write ? POLLOUT : 0));
+            for (auto& entry : entries) {
+                if (entry.first.fd == fd) {
+                    entry.first.events = events;
+                    entry.second = tag;
+                    return;
+                }
+            }
+            entries.push_back({ pollfd{ fd, events, 0 }, tag });
+#endif
+        }
+
+        void Remove(int fd) {
+#ifdef __linux__
+            ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+#else
+            entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                         [fd](const auto& entry) { return entry.first.fd == fd; }),
+                          entries.end());
+#endif
+        }
+
+        void Wait(std::vector<Event>& events, int timeout_ms) {
+            events.clear();
+#ifdef __linux__
+            epoll_event ready[64];
+            int count = ::epoll_wait(epoll_fd, ready, 64, timeout_ms);
+            for (int i = 0; i < count; ++i) {
+                events.push_back({ ready[i].data.ptr, (ready[i].events & (EPOLLIN | EPOLLRDHUP)) != 0,
+                                   (ready[i].events & EPOLLOUT) != 0, (ready[i].events & (EPOLLERR | EPOLLHUP)) != 0 });
+            }
+#else
+            std::vector<pollfd> fds;
+            fds.reserve(entries.size());
+            for (const auto& entry : entries) fds.push_back(entry.first);
+            if (::poll(fds.data(), nfds_t(fds.size()), timeout_ms) <= 0) return;
+            for (std::size_t i = 0; i < fds.size(); ++i) {
+                if (fds[i].revents == 0) continue;
+                events.push_back({ entries[i].second, (fds[i].revents & POLLIN) != 0, (fds[i].revents & POLLOUT) != 0,
+                                   (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) != 0 });
+            }
+#endif
+        }
+
+    private:
+#ifdef __linux__
+        int epoll_fd = -1;
+#else
+        std::vector<std::pair<pollfd, void*>> entries;
+#endif
+    };
+
+    class Client {
+    public:
+        static constexpr int kMaxConnectionsPerHost = 16;
+        static constexpr int kMaxRedirects = 5;
+        static constexpr std::size_t kMaxResponseBytes = 64u << 20;
+        static constexpr std::chrono::seconds kIdleTimeout{ 30 };
+        static constexpr std::chrono::minutes kDnsTtl{ 5 };
+        static constexpr std::chrono::seconds kFailedDnsTtl{ 10 }; // requests queued behind a failed lookup fail at once
+
+        struct Stats {
+            std::uint64_t requests = 0;
+            std::uint64_t connections_opened = 0;
+            std::uint64_t connections_reused = 0;
+            std::uint64_t timeouts = 0;
+            int open_connections = 0;
+            int in_flight = 0;
+        };
+
+        Client() = default;
+        Client(const Client&) = delete;
+        Client& operator=(const Client&) = delete;
+
+        ~Client() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!io_thread.joinable()) return;
+                stopping = true;
+            }
+            lookup_wanted.notify_all();
+            Wake();
+            io_thread.join();
+            resolver_thread.join();
+            ::close(wake_pipe[0]);
+            ::close(wake_pipe[1]);
+            if (ssl_context != nullptr) SSL_CTX_free(ssl_context);
+        }
+
+        // Starts a GET of url. callback runs exactly once, on the I/O thread, with the response or an error
+        // (including a timeout or Cancel); an invalid URL or a client shutting down fails it on the calling
+        // thread instead. Returns an id for Cancel.
+        std::uint64_t Get(const std::string& url, Headers headers, std::chrono::milliseconds timeout, Callback callback) {
+            auto request = std::make_unique<Request>();
+            request->id = next_id++;
+            request->headers = std::move(headers);
+            request->deadline = std::chrono::steady_clock::now() + timeout;
+            request->callback = std::move(callback);
+            std::optional<Url> parsed = Url::Parse(url);
+            std::uint64_t id = request->id;
+            if (!parsed) {
+                request->callback(Response{ 0, {}, "invalid URL: " + url });
+                return id;
+            }
+            request->url = std::move(*parsed);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!stopping) {
+                    EnsureStarted();
+                    Command command;
+                    command.request = std::move(request);
+                    commands.push_back(std::move(command));
+                }
+            }
+            if (request) {
+                request->callback(Response{ 0, {}, "client shut down" });
+                return id;
+            }
+            Wake();
+            return id;
+        }
+
+        // Runs fn on the I/O thread once delay has passed, in deadline order with other timers. When the
+        // client shuts down, pending timers run at once and later ones run on the calling thread, so a
+        // chain of requests and timers always comes to an end. Returns an id for Cancel.
+        std::uint64_t After(std::chrono::milliseconds delay, std::function<void()> fn) {
+            std::uint64_t id = next_id++;
+            bool queued = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!stopping) {
+                    EnsureStarted();
+                    Command command;
+                    command.id = id;
+                    command.due = std::chrono::steady_clock::now() + delay;
+                    command.timer = std::move(fn);
+                    commands.push_back(std::move(command));
+                    queued = true;
+                }
+            }
+            if (!queued) {
+                fn();
+                return id;
+            }
+            Wake();
+            return id;
+        }
+
+        // A request completes with error "cancelled" unless it already finished; a timer that has not run
+        // yet is dropped without running.
+        void Cancel(std::uint64_t id) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!io_thread.joinable() || stopping) return;
+                Command command;
+                command.cancel_id = id;
+                commands.push_back(std::move(command));
+            }
+            Wake();
+        }
+
+        Stats GetStats() const {
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            return stats;
+        }
+
+    private:
+        struct Request {
+            std::uint64_t id = 0;
+            Url url;
+            Headers headers;
+            std::chrono::steady_clock::time_point deadline;
+            Callback callback;
+            int redirects = 0;
+            bool stale_retry = false; // already retried once after a kept-alive connection turned out closed
+        };
+
+        struct DnsEntry {
+            std::vector<char> address; // sockaddr bytes; empty when the name did not resolve
+            socklen_t length = 0;
+            int family = AF_INET;
+            std::chrono::steady_clock::time_point expires;
+        };
+
+        // One of: a new request, the id to cancel, a timer to arm, or the answer to a host name lookup.
+        struct Command {
+            std::unique_ptr<Request> request;
+            std::uint64_t cancel_id = 0;
+            std::uint64_t id = 0;
+            std::chrono::steady_clock::time_point due;
+            std::function<void()> timer;
+            std::string resolved_host; // host:port
+            DnsEntry resolved;
+        };
+
+        struct Timer {
+            std::uint64_t id = 0;
+            std::function<void()> fn;
+        };
+
+        struct Lookup {
+            std::string host;
+            int port = 0;
+        };
+
+        enum class Phase { Connecting, Handshaking, Writing, Reading, Idle };
+
+        struct Connection {
+            int fd = -1;
+            SSL* ssl = nullptr;
+            std::string pool_key;
+            Phase phase = Phase::Connecting;
+            bool reused = false;
+            bool want_read = false;  // what the last TLS call asked for
+            bool want_write = false;
+            std::chrono::steady_clock::time_point idle_since;
+            std::unique_ptr<Request> request;
+
+            std::string out;
+            std::size_t out_offset = 0;
+            std::string in;
+            std::size_t received = 0; // response bytes seen for the current request
+
+            // response parsing
+            bool head_done = false;
+            int status = 0;
+            bool keep_alive = true;
+            bool chunked = false;
+            long long content_length = -1;
+            std::string location;
+            std::size_t parse_pos = 0;
+            long long chunk_remaining = -1; // -1: expecting a size line
+            bool chunk_crlf = false;        // expecting the CRLF after chunk data
+            std::string body;
+        };
+
+        struct HostPool {
+            std::vector<Connection*> idle;
+            std::deque<std::unique_ptr<Request>> waiting;
+            int open = 0;
+        };
+
+        // Called with mutex held.
+        void EnsureStarted() {
+            if (io_thread.joinable()) return;
+#ifdef __APPLE__
+            // SO_NOSIGPIPE is set per socket below
+#else
+            // OpenSSL writes with write(), which raises SIGPIPE on a connection the peer closed
+            std::signal(SIGPIPE, SIG_IGN);
+#endif
+            if (::pipe(wake_pipe) == 0) {
+                for (int fd : wake_pipe) {
+                    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+                    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+                }
+            }
+            ssl_context = SSL_CTX_new(TLS_client_method());
+            if (ssl_context != nullptr) {
+                SSL_CTX_set_default_verify_paths(ssl_context);
+                SSL_CTX_set_verify(ssl_context, SSL_VERIFY_PEER, nullptr);
+                SSL_CTX_set_mode(ssl_context, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+            }
+            io_thread = std::thread([this] { Loop(); });
+            resolver_thread = std::thread([this] { ResolveLoop(); });
+        }
+
+        void Wake() {
+            char byte = 1;
+            [[maybe_unused]] ssize_t written = ::write(wake_pipe[1], &byte, 1);
+        }
+
+        void Loop() {
+            poller.Set(wake_pipe[0], true, false, nullptr);
+            std::vector<Poller::Event> events;
+            while (true) {
+                std::vector<Command> batch;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (stopping) break;
+                    batch.swap(commands);
+                }
+                for (Command& command : batch) {
+                    if (command.request) {
+                        UpdateStats([](Stats& s) { ++s.requests; ++s.in_flight; });
+                        Dispatch(std::move(command.request));
+                    }
+                    else if (command.timer) {
+                        timers.emplace(command.due, Timer{ command.id, std::move(command.timer) });
+                    }
+                    else if (!command.resolved_host.empty()) {
+                        OnResolved(command.resolved_host, std::move(command.resolved));
+                    }
+                    else {
+                        CancelRequest(command.cancel_id);
+                    }
+                }
+
+                poller.Wait(events, NextTimeoutMs());
+                for (const Poller::Event& event : events) {
+                    if (event.tag == nullptr) {
+                        char drain[64];
+                        while (::read(wake_pipe[0], drain, sizeof(drain)) > 0) {}
+                        continue;
+                    }
+                    auto* connection = static_cast<Connection*>(event.tag);
+                    if (owned.count(connection) == 0) continue; // closed earlier in this batch
+                    OnReady(connection, event);
+                }
+                ExpireDeadlines();
+                RunTimers(std::chrono::steady_clock::now());
+            }
+
+            // Shutting down: fail whatever is left, then run the timers so whoever waits on them moves on.
+            // Get and After no longer queue anything once stopping is set.
+            std::vector<Command> unprocessed;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                unprocessed.swap(commands);
+            }
+            std::vector<std::unique_ptr<Request>> leftover;
+            for (Command& command : unprocessed) {
+                if (command.request) {
+                    UpdateStats([](Stats& s) { ++s.requests; ++s.in_flight; });
+                    leftover.push_back(std::move(command.request));
+                }
+                else if (command.timer) {
+                    timers.emplace(command.due, Timer{ command.id, std::move(command.timer) });
+                }
+            }
+            for (auto& [key, parked] : resolving) {
+                for (auto& request : parked) leftover.push_back(std::move(request));
+            }
+            resolving.clear();
+            for (auto& [key, pool] : pools) {
+                for (auto& request : pool.waiting) leftover.push_back(std::move(request));
+                pool.waiting.clear();
+            }
+            while (!owned.empty()) {
+                Connection* connection = owned.begin()->first;
+                if (connection->request) leftover.push_back(std::move(connection->request));
+                Close(connection);
+            }
+            for (auto& request : leftover) Finish(std::move(request), Response{ 0, {}, "client shut down" });
+            RunTimers(std::chrono::steady_clock::time_point::max());
+        }
+
+        int NextTimeoutMs() const {
+            auto now = std::chrono::steady_clock::now();
+            auto next = now + std::chrono::seconds(1);
+            for (const auto& [connection, holder] : owned) {
+                if (connection->request) next = std::min(next, connection->request->deadline);
+            }
+            for (const auto& [key, pool] : pools) {
+                for (const auto& request : pool.waiting) next = std::min(next, request->deadline);
+            }
+            for (const auto& [key, parked] : resolving) {
+                for (const auto& request : parked) next = std::min(next, request->deadline);
+            }
+            if (!timers.empty()) next = std::min(next, timers.begin()->first);
+            // Rounded up: waking a little early would only spin until the deadline
+            auto wait = std::chrono::ceil<std::chrono::milliseconds>(next - now).count();
+            return int(std::max<long long>(0, wait));
+        }
+
+        // Timers are few and short-lived; a timer cancelled after it was taken off here has already run
+        void RunTimers(std::chrono::steady_clock::time_point now) {
+            while (!timers.empty() && timers.begin()->first <= now) {
+                std::function<void()> fn = std::move(timers.begin()->second.fn);
+                timers.erase(timers.begin());
+                fn();
+            }
+        }
+
+        void Dispatch(std::unique_ptr<Request> request) {
+            HostPool& pool = pools[request->url.PoolKey()];
+            if (!pool.idle.empty()) {
+                Connection* connection = pool.idle.back();
+                pool.idle.pop_back();
+                UpdateStats([](Stats& s) { ++s.connections_reused; });
+                StartRequest(connection, std::move(request), true);
+                return;
+            }
+            if (pool.open >= kMaxConnectionsPerHost) {
+                pool.waiting.push_back(std::move(request));
+                return;
+            }
+            OpenConnection(std::move(request));
+        }
+
+        static std::string HostKey(const Url& url) { return url.host + ":" + std::to_string(url.port); }
+
+        // Takes one of the host's connection slots for request and connects once the host name is known:
+        // right away from the DNS cache, otherwise parked until the resolver thread answers.
+        void OpenConnection(std::unique_ptr<Request> request) {
+            ++pools[request->url.PoolKey()].open;
+            std::string key = HostKey(request->url);
+            auto cached = dns.find(key);
+            if (cached != dns.end() && cached->second.expires > std::chrono::steady_clock::now()) {
+                Connect(std::move(request), cached->second);
+                return;
+            }
+            auto [parked, first] = resolving.try_emplace(key);
+            parked->second.push_back(std::move(request));
+            if (first) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    lookups.push_back({ parked->second.back()->url.host, parked->second.back()->url.port });
+                }
+                lookup_wanted.notify_one();
+            }
+        }
+
+        void OnResolved(const std::string& key, DnsEntry entry) {
+            std::chrono::seconds ttl = entry.length == 0 ? kFailedDnsTtl : std::chrono::seconds(kDnsTtl);
+            entry.expires = std::chrono::steady_clock::now() + ttl;
+            const DnsEntry& address = dns[key] = std::move(entry);
+            auto parked = resolving.find(key);
+            if (parked == resolving.end()) return;
+            std::deque<std::unique_ptr<Request>> requests = std::move(parked->second);
+            resolving.erase(parked);
+            for (auto& request : requests) Connect(std::move(request), address);
+        }
+
+        // Frees a connection slot of the host, handing it to the next request waiting for one
+        void ReleaseSlot(const std::string& pool_key) {
+            HostPool& pool = pools[pool_key];
+            --pool.open;
+            if (!pool.waiting.empty() && pool.open < kMaxConnectionsPerHost) {
+                std::unique_ptr<Request> next = std::move(pool.waiting.front());
+                pool.waiting.pop_front();
+                OpenConnection(std::move(next));
+            }
+        }
+
+        // The request holds a slot of its host from OpenConnection
+        void Connect(std::unique_ptr<Request> request, const DnsEntry& address) {
+            auto fail = [this, &request](const std::string& error) {
+                ReleaseSlot(request->url.PoolKey());
+                Finish(std::move(request), Response{ 0, {}, error });
+            };
+            if (address.length == 0) {
+                fail("cannot resolve " + request->url.host);
+                return;
+            }
+            int fd = ::socket(address.family, SOCK_STREAM, 0);
+            if (fd < 0) {
+                fail("socket failed");
+                return;
+            }
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+            ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef __APPLE__
+            ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+            if (::connect(fd, reinterpret_cast<const sockaddr*>(address.address.data()), address.length) != 0 &&
+                errno != EINPROGRESS) {
+                ::close(fd);
+                fail("connect failed");
+                return;
+            }
+
+            auto holder = std::make_unique<Connection>();
+            Connection* connection = holder.get();
+            connection->fd = fd;
+            connection->pool_key = request->url.PoolKey();
+            connection->phase = Phase::Connecting;
+            connection->request = std::move(request);
+            owned.emplace(connection, std::move(holder));
+            UpdateStats([](Stats& s) { ++s.connections_opened; ++s.open_connections; });
+            poller.Set(fd, false, true, connection);
+        }
+
+        // Resolver thread: getaddrinfo blocks for as long as the DNS server takes, so it never runs on the
+        // I/O thread. One lookup at a time is plenty for the few hosts this app talks to.
+        void ResolveLoop() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true) {
+                lookup_wanted.wait(lock, [this] { return stopping || !lookups.empty(); });
+                if (stopping) return;
+                Lookup lookup = std::move(lookups.front());
+                lookups.pop_front();
+                lock.unlock();
+
+                Command command;
+                command.resolved_host = lookup.host + ":" + std::to_string(lookup.port);
+                addrinfo hints{};
+                hints.ai_family = AF_UNSPEC;
+                hints.ai_socktype = SOCK_STREAM;
+                addrinfo* result = nullptr;
+                if (::getaddrinfo(lookup.host.c_str(), std::to_string(lookup.port).c_str(), &hints, &result) == 0 &&
+                    result != nullptr) {
+                    command.resolved.family = result->ai_family;
+                    command.resolved.length = socklen_t(result->ai_addrlen);
+                    command.resolved.address.assign(reinterpret_cast<const char*>(result->ai_addr),
+                                                    reinterpret_cast<const char*>(result->ai_addr) + result->ai_addrlen);
+                    ::freeaddrinfo(result);
+                }
+
+                lock.lock();
+                commands.push_back(std::move(command));
+                Wake();
+            }
+        }
+
+        void StartRequest(Connection* connection, std::unique_ptr<Request> request, bool reused) {
+            connection->request = std::move(request);
+            connection->reused = reused;
+            const Request& r = *connection->request;
+            connection->out = "GET " + r.url.target + " HTTP/1.1\r\nHost: " + r.url.host;
+            if (r.url.port != (r.url.tls ? 443 : 80)) connection->out += ":" + std::to_string(r.url.port);
+            connection->out += "\r\nAccept-Encoding: identity\r\nConnection: keep-alive\r\n";
+            bool has_agent = false;
+            for (const auto& [name, value] : r.headers) {
+                connection->out += name + ": " + value + "\r\n";
+                has_agent |= EqualsIgnoreCase(name, "User-Agent");
+            }
+            if (!has_agent) connection->out += "User-Agent: finalProject\r\n";
+            connection->out += "\r\n";
+            connection->out_offset = 0;
+            ResetResponse(*connection);
+            connection->phase = Phase::Writing;
+            DoWrite(connection);
+        }
+
+        static void ResetResponse(Connection& connection) {
+            connection.in.clear();
+            connection.received = 0;
+            connection.head_done = false;
+            connection.status = 0;
+            connection.keep_alive = true;
+            connection.chunked = false;
+            connection.content_length = -1;
+            connection.location.clear();
+            connection.parse_pos = 0;
+            connection.chunk_remaining = -1;
+            connection.chunk_crlf = false;
+            connection.body.clear();
+        }
+
+        void OnReady(Connection* connection, const Poller::Event& event) {
+            switch (connection->phase) {
+                case Phase::Connecting: {
+                    int error = 0;
+                    socklen_t length = sizeof(error);
+                    ::getsockopt(connection->fd, SOL_SOCKET, SO_ERROR, &error, &length);
+                    if (error != 0 || (event.failed && !event.writable)) {
+                        Fail(connection, "connect failed");
+                        return;
+                    }
+                    if (!event.writable) return;
+                    if (connection->request->url.tls) {
+                        if (!StartTls(connection)) return;
+                        connection->phase = Phase::Handshaking;
+                        DoHandshake(connection);
+                    }
+                    else {
+                        StartRequest(connection, std::move(connection->request), false);
+                    }
+                    return;
+                }
+                case Phase::Handshaking:
+                    DoHandshake(connection);
+                    return;
+                case Phase::Writing:
+                    if (event.failed && !event.writable) {
+                        FailOrRetryStale(connection, "connection closed");
+                        return;
+                    }
+                    DoWrite(connection);
+                    return;
+                case Phase::Reading:
+                    DoRead(connection);
+                    return;
+                case Phase::Idle:
+                    // The server closed a kept-alive connection (or sent something unasked for)
+                    Close(connection);
+                    return;
+            }
+        }
+
+        bool StartTls(Connection* connection) {
+            if (ssl_context == nullptr) {
+                Fail(connection, "TLS unavailable");
+                return false;
+            }
+            connection->ssl = SSL_new(ssl_context);
+            const std::string& host = connection->request->url.host;
+            SSL_set_fd(connection->ssl, connection->fd);
+            SSL_set_tlsext_host_name(connection->ssl, host.c_str());
+            SSL_set1_host(connection->ssl, host.c_str());
+            return true;
+        }
+
+        // Maps the last TLS result to readiness interest; false on a hard error.
+        bool TlsWants(Connection* connection, int result) {
+            int error = SSL_get_error(connection->ssl, result);
+            connection->want_read = error == SSL_ERROR_WANT_READ;
+            connection->want_write = error == SSL_ERROR_WANT_WRITE;
+            if (!connection->want_read && !connection->want_write) {
+                ERR_clear_error();
+                return false;
+            }
+            poller.Set(connection->fd, connection->want_read, connection->want_write, connection);
+            return true;
+        }
+
+        void DoHandshake(Connection* connection) {
+            int result = SSL_connect(connection->ssl);
+            if (result == 1) {
+                StartRequest(connection, std::move(connection->request), false);
+                return;
+            }
+            if (!TlsWants(connection, result)) {
+                long verify = SSL_get_verify_result(connection->ssl);
+                Fail(connection, verify != X509_V_OK ? std::string("certificate: ") + X509_verify_cert_error_string(verify)
+                                                     : std::string("TLS handshake failed"));
+            }
+        }
+
+        void DoWrite(Connection* connection) {
+            while (connection->out_offset < connection->out.size()) {
+                const char* data = connection->out.data() + connection->out_offset;
+                std::size_t size = connection->out.size() - connection->out_offset;
+                if (connection->ssl != nullptr) {
+                    int written = SSL_write(connection->ssl, data, int(size));
+                    if (written <= 0) {
+                        if (!TlsWants(connection, written)) FailOrRetryStale(connection, "write failed");
+                        return;
+                    }
+                    connection->out_offset += std::size_t(written);
+                }
+                else {
+#ifdef MSG_NOSIGNAL
+                    ssize_t written = ::send(connection->fd, data, size, MSG_NOSIGNAL);
+#else
+                    ssize_t written = ::send(connection->fd, data, size, 0);
+#endif
+                    if (written < 0) {
+                        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                            poller.Set(connection->fd, false, true, connection);
+                            return;
+                        }
+                        FailOrRetryStale(connection, "write failed");
+                        return;
+                    }
+                    connection->out_offset += std::size_t(written);
+                }
+            }
+            connection->phase = Phase::Reading;
+            poller.Set(connection->fd, true, false, connection);
+            DoRead(connection);
+        }
+
+        void DoRead(Connection* connection) {
+            char buffer[16384];
+            while (true) {
+                long long got = 0;
+                bool closed = false;
+                if (connection->ssl != nullptr) {
+                    int result = SSL_read(connection->ssl, buffer, int(sizeof(buffer)));
+                    if (result > 0) {
+                        got = result;
+                    }
+                    else if (SSL_get_error(connection->ssl, result) == SSL_ERROR_ZERO_RETURN) {
+                        closed = true;
+                    }
+                    else if (TlsWants(connection, result)) {
+                        return;
+                    }
+                    else {
+                        closed = true; // reset or a truncated TLS stream: treat like EOF
+                    }
+                }
+                else {
+                    ssize_t result = ::recv(connection->fd, buffer, sizeof(buffer), 0);
+                    if (result > 0) {
+                        got = result;
+                    }
+                    else if (result == 0) {
+                        closed = true;
+                    }
+                    else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                        return;
+                    }
+                    else {
+                        closed = true;
+                    }
+                }
+
+                if (closed) {
+                    if (connection->received == 0) {
+                        FailOrRetryStale(connection, "connection closed");
+                    }
+                    else if (connection->head_done && !connection->chunked && connection->content_length < 0) {
+                        connection->keep_alive = false; // body delimited by the close
+                        Complete(connection);
+                    }
+                    else {
+                        Fail(connection, "connection closed mid-response");
+                    }
+                    return;
+                }
+
+                connection->received += std::size_t(got);
+                connection->in.append(buffer, std::size_t(got));
+                if (connection->in.size() + connection->body.size() > kMaxResponseBytes) {
+                    Fail(connection, "response too large");
+                    return;
+                }
+                switch (Parse(*connection)) {
+                    case ParseResult::NeedMore: break;
+                    case ParseResult::Done: Complete(connection); return;
+                    case ParseResult::Error: Fail(connection, "malformed response"); return;
+                }
+            }
+        }
+
+        enum class ParseResult { NeedMore, Done, Error };
+
+        static bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+            return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+                return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+            });
+        }
+
+        static bool ContainsToken(std::string_view value, std::string_view token) {
+            std::string lower(value);
+            for (char& c : lower) c = char(std::tolower(static_cast<unsigned char>(c)));
+            return lower.find(token) != std::string::npos;
+        }
+
+        static ParseResult Parse(Connection& c) {
+            if (!c.head_done) {
+                std::size_t end = c.in.find("\r\n\r\n");
+                if (end == std::string::npos) return c.in.size() > 65536 ? ParseResult::Error : ParseResult::NeedMore;
+                std::string_view head(c.in.data(), end);
+                std::size_t line_end = head.find("\r\n");
+                std::string_view status_line = head.substr(0, line_end);
+                if (status_line.substr(0, 5) != "HTTP/" || status_line.size() < 12) return ParseResult::Error;
+                c.status = std::atoi(std::string(status_line.substr(9, 3)).c_str());
+                c.keep_alive = status_line.substr(5, 3) == "1.1";
+                while (line_end != std::string_view::npos) {
+                    head.remove_prefix(line_end + 2);
+                    line_end = head.find("\r\n");
+                    std::string_view line = head.substr(0, line_end);
+                    std::size_t colon = line.find(':');
+                    if (colon == std::string_view::npos) continue;
+                    std::string_view name = line.substr(0, colon);
+                    std::string_view value = line.substr(colon + 1);
+                    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+                    if (EqualsIgnoreCase(name, "Content-Length")) c.content_length = std::atoll(std::string(value).c_str());
+                    else if (EqualsIgnoreCase(name, "Transfer-Encoding")) c.chunked = ContainsToken(value, "chunked");
+                    else if (EqualsIgnoreCase(name, "Connection")) {
+                        if (ContainsToken(value, "close")) c.keep_alive = false;
+                        else if (ContainsToken(value, "keep-alive")) c.keep_alive = true;
+                    }
+                    else if (EqualsIgnoreCase(name, "Location")) c.location = std::string(value);
+                }
+                c.head_done = true;
+                c.parse_pos = end + 4;
+                if (c.status / 100 == 1 || c.status == 204 || c.status == 304) {
+                    c.content_length = 0;
+                    c.chunked = false;
+                }
+            }
+
+            if (c.chunked) return ParseChunks(c);
+            if (c.content_length >= 0) {
+                std::size_t available = c.in.size() - c.parse_pos;
+                if (available < std::size_t(c.content_length)) return ParseResult::NeedMore;
+                if (available > std::size_t(c.content_length)) c.keep_alive = false; // unexpected extra bytes
+                c.body.assign(c.in, c.parse_pos, std::size_t(c.content_length));
+                return ParseResult::Done;
+            }
+            return ParseResult::NeedMore; // until the server closes
+        }
+
+        static ParseResult ParseChunks(Connection& c) {
+            while (true) {
+                if (c.chunk_crlf) {
+                    if (c.in.size() - c.parse_pos < 2) break;
+                    c.parse_pos += 2;
+                    c.chunk_crlf = false;
+                    c.chunk_remaining = -1;
+                }
+                if (c.chunk_remaining < 0) {
+                    std::size_t eol = c.in.find("\r\n", c.parse_pos);
+                    if (eol == std::string::npos) break;
+                    char* end = nullptr;
+                    long long size = std::strtoll(c.in.c_str() + c.parse_pos, &end, 16);
+                    if (end == c.in.c_str() + c.parse_pos || size < 0) return ParseResult::Error;
+                    if (size == 0) {
+                        // Last chunk, then optional trailers and an empty line
+                        std::size_t end = c.in.compare(eol + 2, 2, "\r\n") == 0 ? eol + 2 : c.in.find("\r\n\r\n", eol);
+                        if (end == std::string::npos) break;
+                        if (c.in.size() > end + 4) c.keep_alive = false; // unexpected extra bytes
+                        return ParseResult::Done;
+                    }
+                    c.parse_pos = eol + 2;
+                    c.chunk_remaining = size;
+                }
+                std::size_t take = std::min<std::size_t>(std::size_t(c.chunk_remaining), c.in.size() - c.parse_pos);
+                c.body.append(c.in, c.parse_pos, take);
+                c.parse_pos += take;
+                c.chunk_remaining -= (long long)take;
+                if (c.chunk_remaining > 0) break;
+                c.chunk_crlf = true;
+            }
+            // Drop what was consumed so the buffer does not grow with the body
+            if (c.parse_pos > 65536) {
+                c.in.erase(0, c.parse_pos);
+                c.parse_pos = 0;
+            }
+            return ParseResult::NeedMore;
+        }
+
+        void Complete(Connection* connection) {
+            std::unique_ptr<Request> request = std::move(connection->request);
+            Response response{ connection->status, std::move(connection->body), {} };
+            std::string location = std::move(connection->location);
+            bool reusable = connection->keep_alive;
+            ResetResponse(*connection);
+            if (reusable) {
+                Release(connection);
+            }
+            else {
+                Close(connection);
+            }
+
+            bool redirect = response.status == 301 || response.status == 302 || response.status == 303 ||
+                            response.status == 307 || response.status == 308;
+            if (redirect && !location.empty() && request->redirects < kMaxRedirects) {
+                std::string target = location.find("://") == std::string::npos ? request->url.Origin() + location : location;
+                std::optional<Url> next = Url::Parse(target);
+                if (next) {
+                    ++request->redirects;
+                    request->url = std::move(*next);
+                    request->stale_retry = false;
+                    Dispatch(std::move(request));
+                    return;
+                }
+            }
+            Finish(std::move(request), std::move(response));
+        }
+
+        // Back to the host's idle list, or straight on to a request waiting for this host.
+        void Release(Connection* connection) {
+            HostPool& pool = pools[connection->pool_key];
+            if (!pool.waiting.empty()) {
+                std::unique_ptr<Request> next = std::move(pool.waiting.front());
+                pool.waiting.pop_front();
+                UpdateStats([](Stats& s) { ++s.connections_reused; });
+                StartRequest(connection, std::move(next), true);
+                return;
+            }
+            connection->phase = Phase::Idle;
+            connection->idle_since = std::chrono::steady_clock::now();
+            pool.idle.push_back(connection);
+            poller.Set(connection->fd, true, false, connection);
+        }
+
+        // A reused connection that fails before any response byte was most likely closed by the server
+        // while idle; GET is idempotent, so try once more on a fresh connection.
+        void FailOrRetryStale(Connection* connection, const std::string& error) {
+            if (connection->reused && connection->received == 0 && connection->request && !connection->request->stale_retry) {
+                std::unique_ptr<Request> request = std::move(connection->request);
+                request->stale_retry = true;
+                Close(connection);
+                OpenConnection(std::move(request));
+                return;
+            }
+            Fail(connection, error);
+        }
+
+        void Fail(Connection* connection, const std::string& error) {
+            std::unique_ptr<Request> request = std::move(connection->request);
+            Close(connection);
+            if (request) Finish(std::move(request), Response{ 0, {}, error });
+        }
+
+        void Close(Connection* connection) {
+            std::string pool_key = std::move(connection->pool_key);
+            HostPool& pool = pools[pool_key];
+            pool.idle.erase(std::remove(pool.idle.begin(), pool.idle.end(), connection), pool.idle.end());
+            poller.Remove(connection->fd);
+            if (connection->ssl != nullptr) {
+                SSL_free(connection->ssl);
+            }
+            ::close(connection->fd);
+            std::unique_ptr<Request> orphan = std::move(connection->request);
+            owned.erase(connection);
+            UpdateStats([](Stats& s) { --s.open_connections; });
+
+            ReleaseSlot(pool_key);
+            if (orphan) Finish(std::move(orphan), Response{ 0, {}, "connection closed" });
+        }
+
+        void Finish(std::unique_ptr<Request> request, Response response) {
+            UpdateStats([](Stats& s) { --s.in_flight; });
+            request->callback(std::move(response));
+        }
+
+        void CancelRequest(std::uint64_t id) {
+            for (auto it = timers.begin(); it != timers.end(); ++it) {
+                if (it->second.id == id) {
+                    timers.erase(it);
+                    return;
+                }
+            }
+            for (auto& [key, parked] : resolving) {
+                for (auto it = parked.begin(); it != parked.end(); ++it) {
+                    if ((*it)->id == id) {
+                        std::unique_ptr<Request> request = std::move(*it);
+                        parked.erase(it);
+                        ReleaseSlot(request->url.PoolKey());
+                        Finish(std::move(request), Response{ 0, {}, "cancelled" });
+                        return;
+                    }
+                }
+            }
+            for (auto& [key, pool] : pools) {
+                for (auto it = pool.waiting.begin(); it != pool.waiting.end(); ++it) {
+                    if ((*it)->id == id) {
+                        std::unique_ptr<Request> request = std::move(*it);
+                        pool.waiting.erase(it);
+                        Finish(std::move(request), Response{ 0, {}, "cancelled" });
+                        return;
+                    }
+                }
+            }
+            for (auto& [connection, holder] : owned) {
+                if (connection->request && connection->request->id == id) {
+                    Fail(connection, "cancelled");
+                    return;
+                }
+            }
+        }
+
+        void ExpireDeadlines() {
+            auto now = std::chrono::steady_clock::now();
+            // Collected first: releasing a slot can park another request and rehash resolving
+            std::vector<std::unique_ptr<Request>> unresolved;
+            for (auto& [key, parked] : resolving) {
+                for (auto it = parked.begin(); it != parked.end();) {
+                    if ((*it)->deadline <= now) {
+                        unresolved.push_back(std::move(*it));
+                        it = parked.erase(it);
+                    }
+                    else {
+                        ++it;
+                    }
+                }
+            }
+            for (auto& request : unresolved) {
+                ReleaseSlot(request->url.PoolKey());
+                UpdateStats([](Stats& s) { ++s.timeouts; });
+                Finish(std::move(request), Response{ 0, {}, "timed out" });
+            }
+            for (auto& [key, pool] : pools) {
+                for (auto it = pool.waiting.begin(); it != pool.waiting.end();) {
+                    if ((*it)->deadline <= now) {
+                        std::unique_ptr<Request> request = std::move(*it);
+                        it = pool.waiting.erase(it);
+                        UpdateStats([](Stats& s) { ++s.timeouts; });
+                        Finish(std::move(request), Response{ 0, {}, "timed out" });
+                    }
+                    else {
+                        ++it;
+                    }
+                }
+            }
+            std::vector<Connection*> expired;
+            for (auto& [connection, holder] : owned) {
+                if (connection->request ? connection->request->deadline <= now
+                                        : connection->phase == Phase::Idle && now - connection->idle_since > kIdleTimeout) {
+                    expired.push_back(connection);
+                }
+            }
+            for (Connection* connection : expired) {
+                if (connection->request) {
+                    UpdateStats([](Stats& s) { ++s.timeouts; });
+                    Fail(connection, "timed out");
+                }
+                else {
+                    Close(connection);
+                }
+            }
+        }
+
+        template <typename F>
+        void UpdateStats(F update) {
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            update(stats);
+        }
+
+        // Shared with callers
+        std::mutex mutex;
+        std::vector<Command> commands;
+        bool stopping = false;
+        std::thread io_thread;
+        std::thread resolver_thread;
+        std::condition_variable lookup_wanted;
+        std::deque<Lookup> lookups;
+        int wake_pipe[2] = { -1, -1 };
+        std::atomic<std::uint64_t> next_id{ 1 };
+        mutable std::mutex stats_mutex;
+        Stats stats;
+
+        // I/O thread only
+        SSL_CTX* ssl_context = nullptr;
+        Poller poller;
+        std::unordered_map<Connection*, std::unique_ptr<Connection>> owned;
+        std::map<std::string, HostPool> pools;
+        std::unordered_map<std::string, DnsEntry> dns;
+        std::unordered_map<std::string, std::deque<std::unique_ptr<Request>>> resolving; // by host:port, waiting on the resolver
+        std::multimap<std::chrono::steady_clock::time_point, Timer> timers;
+    };
+
+} // namespace event_http
+
+#endif //FINALPROJECT_EVENT_HTTP_CLIENT_H
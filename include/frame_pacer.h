@@ -0,0 +1,138 @@
+//
+// Decides how long the main loop may sleep between frames and keeps frame-rate / CPU statistics.
+//
+
+#ifndef FINALPROJECT_FRAME_PACER_H
+#define FINALPROJECT_FRAME_PACER_H
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+
+class FramePacer {
+public:
+    struct Settings {
+        double animation_fps = 10.0;     // spinners and "loading" text while work is pending
+        double text_input_timeout = 0.5; // keeps the caret blinking in an active input field
+        double idle_timeout = 2.0;       // nothing pending, nothing changing
+        double unfocused_timeout = 3.0;
+        double minimized_timeout = 5.0;
+        int settle_frames = 3;           // ImGui needs a few frames after input for hover/layout to settle
+    };
+
+    // What the loop knows about the current state of the application.
+    struct Activity {
+        bool work_pending = false;
+        bool text_input = false;
+        bool focused = true;
+        bool minimized = false;
+    };
+
+    struct Stats {
+        double fps = 0.0;            // rendered frames per second, last sample window
+        double wakeups_per_sec = 0.0;
+        double frame_ms = 0.0;       // CPU time spent building and submitting the last frame
+        double cpu_percent = 0.0;    // process CPU time over wall time, all threads
+        long long frames = 0;
+        long long wakeups = 0;
+    };
+
+    FramePacer() = default;
+    explicit FramePacer(Settings s) : settings(s) {}
+
+    // Called from input callbacks: the next few frames render without waiting.
+    void NotifyInput() {
+        pending_input.store(true);
+    }
+
+    // Seconds to wait for events before the next frame; 0 means poll and render right away.
+    double WaitTimeout(const Activity& activity) {
+        idle_wait = false;
+        if (pending_input.exchange(false)) {
+            settle_remaining = settings.settle_frames;
+        }
+        if (activity.minimized) {
+            return settings.minimized_timeout;
+        }
+        if (settle_remaining > 0) {
+            --settle_remaining;
+            return 0.0;
+        }
+        if (activity.work_pending) {
+            return activity.focused ? 1.0 / settings.animation_fps : settings.unfocused_timeout;
+        }
+        idle_wait = true;
+        if (!activity.focused) {
+            return settings.unfocused_timeout;
+        }
+        if (activity.text_input) {
+            return settings.text_input_timeout;
+        }
+        return settings.idle_timeout;
+    }
+
+    // True when the last wait had nothing pending and no input arrived during it:
+    // the frame that follows should only redraw an unchanged screen.
+    bool IdleWake() const {
+        return idle_wait && !pending_input.load();
+    }
+
+    void Woke() {
+        ++stats.wakeups;
+        ++window_wakeups;
+    }
+
+    void BeginFrame() {
+        frame_start = Clock::now();
+    }
+
+    void EndFrame() {
+        auto now = Clock::now();
+        stats.frame_ms = std::chrono::duration<double, std::milli>(now - frame_start).count();
+        ++stats.frames;
+        ++window_frames;
+
+        double elapsed = std::chrono::duration<double>(now - window_start).count();
+        if (elapsed >= 1.0) {
+            std::clock_t cpu_now = std::clock();
+            double cpu_seconds = double(cpu_now - window_cpu_start) / CLOCKS_PER_SEC;
+            stats.fps = window_frames / elapsed;
+            stats.wakeups_per_sec = window_wakeups / elapsed;
+            stats.cpu_percent = 100.0 * cpu_seconds / elapsed;
+            window_start = now;
+            window_cpu_start = cpu_now;
+            window_frames = 0;
+            window_wakeups = 0;
+        }
+    }
+
+    const Stats& GetStats() const { return stats; }
+    const Settings& GetSettings() const { return settings; }
+
+    // Phase of a reduced-rate animation, e.g. the number of dots after "Searching".
+    int AnimationStep(int steps) const {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now().time_since_epoch()).count();
+        long long period_ms = std::max(1LL, (long long)(1000.0 / settings.animation_fps) * 3);
+        return int((ms / period_ms) % steps);
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Settings settings;
+    Stats stats;
+    std::atomic<bool> pending_input{ true };
+    int settle_remaining = 0;
+    bool idle_wait = false;
+
+    Clock::time_point frame_start = Clock::now();
+    Clock::time_point window_start = Clock::now();
+    std::clock_t window_cpu_start = std::clock();
+    int window_frames = 0;
+    int window_wakeups = 0;
+};
+
+#endif //FINALPROJECT_FRAME_PACER_H
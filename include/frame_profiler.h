@@ -0,0 +1,179 @@
+//
+// Per-frame CPU section timings with a ring-buffered history, percentile summaries and a JSON dump.
+//
+
+#ifndef FINALPROJECT_FRAME_PROFILER_H
+#define FINALPROJECT_FRAME_PROFILER_H
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include <json.hpp>
+
+class FrameProfiler {
+public:
+    static constexpr int kMaxSections = 16;
+    static constexpr int kHistory = 240; // frames kept per section
+
+    struct Summary {
+        float last = 0.0f;
+        float avg = 0.0f;
+        float p50 = 0.0f;
+        float p95 = 0.0f;
+        float p99 = 0.0f;
+        float max = 0.0f;
+    };
+
+    FrameProfiler() {
+        SectionId("frame"); // section 0 is always the whole frame
+    }
+
+    // Finds or registers a section. Names must outlive the profiler (string literals).
+    int SectionId(const char* name) {
+        for (int i = 0; i < section_count; ++i) {
+            if (std::strcmp(names[i], name) == 0) return i;
+        }
+        if (section_count == kMaxSections) return -1;
+        names[section_count] = name;
+        history[section_count].fill(0.0f);
+        return section_count++;
+    }
+
+    void BeginFrame() {
+        ++frame_index;
+        int slot = Slot(frame_index);
+        for (int i = 0; i < section_count; ++i) {
+            history[i][slot] = 0.0f;
+        }
+        frame_start = Clock::now();
+    }
+
+    void EndFrame() {
+        Add(0, std::chrono::duration<float, std::milli>(Clock::now() - frame_start).count());
+    }
+
+    // For sections that span code which cannot be wrapped in one scope.
+    void BeginSection(int section) {
+        if (section < 0 || section >= section_count) return;
+        section_start[section] = Clock::now();
+    }
+
+    void EndSection(int section) {
+        if (section < 0 || section >= section_count) return;
+        Add(section, std::chrono::duration<float, std::milli>(Clock::now() - section_start[section]).count());
+    }
+
+    // Accumulates into the current frame; a section timed twice in one frame reports the sum.
+    void Add(int section, float ms) {
+        AddToFrame(section, ms, frame_index);
+    }
+
+    // For results that arrive late (GPU timer queries): credited to the frame that issued them.
+    void AddToFrame(int section, float ms, long long frame) {
+        if (section < 0 || section >= section_count || frame < 0) return;
+        if (frame > frame_index || frame_index - frame >= kHistory) return;
+        history[section][Slot(frame)] += ms;
+    }
+
+    long long FrameIndex() const { return frame_index; }
+    int SectionCount() const { return section_count; }
+    const char* SectionName(int section) const { return names[section]; }
+
+    // Completed frames in the history (the current one is still being accumulated).
+    int CompletedFrames() const { return int(std::min<long long>(frame_index - 1, kHistory - 1)); }
+
+    // Ring buffer for ImGui::PlotLines(kHistory values): pass PlotOffset() as values_offset for oldest-first order.
+    const float* History(int section) const { return history[section].data(); }
+    int PlotOffset() const { return Slot(frame_index + 1); }
+
+    Summary Summarize(int section) const {
+        Summary summary;
+        int completed = CompletedFrames();
+        if (section < 0 || section >= section_count || completed <= 0) return summary;
+
+        std::array<float, kHistory> scratch{};
+        double sum = 0.0;
+        for (int i = 0; i < completed; ++i) {
+            scratch[i] = history[section][Slot(frame_index - 1 - i)];
+            sum += scratch[i];
+        }
+        summary.last = scratch[0];
+        summary.avg = float(sum / completed);
+        summary.p50 = Percentile(scratch, completed, 0.50);
+        summary.p95 = Percentile(scratch, completed, 0.95);
+        summary.p99 = Percentile(scratch, completed, 0.99);
+        summary.max = *std::max_element(scratch.begin(), scratch.begin() + completed);
+        return summary;
+    }
+
+    bool DumpJson(const std::string& path) const {
+        nlohmann::json dump;
+        dump["frames"] = frame_index;
+        for (int i = 0; i < section_count; ++i) {
+            Summary summary = Summarize(i);
+            nlohmann::json section;
+            section["last_ms"] = summary.last;
+            section["avg_ms"] = summary.avg;
+            section["p50_ms"] = summary.p50;
+            section["p95_ms"] = summary.p95;
+            section["p99_ms"] = summary.p99;
+            section["max_ms"] = summary.max;
+            nlohmann::json samples = nlohmann::json::array();
+            for (int f = CompletedFrames(); f >= 1; --f) {
+                samples.push_back(history[i][Slot(frame_index - f)]);
+            }
+            section["history_ms"] = samples;
+            dump["sections"][names[i]] = section;
+        }
+
+        std::ofstream file(path);
+        if (!file.is_open()) return false;
+        file << dump.dump(2) << "\n";
+        return true;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static int Slot(long long frame) { return int(frame % kHistory); }
+
+    static float Percentile(std::array<float, kHistory>& values, int count, double p) {
+        int k = std::min(count - 1, int(p * (count - 1) + 0.5));
+        std::nth_element(values.begin(), values.begin() + k, values.begin() + count);
+        return values[k];
+    }
+
+    std::array<const char*, kMaxSections> names{};
+    std::array<std::array<float, kHistory>, kMaxSections> history{};
+    std::array<Clock::time_point, kMaxSections> section_start{};
+    int section_count = 0;
+    long long frame_index = 0;
+    Clock::time_point frame_start = Clock::now();
+};
+
+// Times the enclosing scope into a profiler section.
+class ScopedTimer {
+public:
+    ScopedTimer(FrameProfiler& profiler, int section)
+        : profiler(profiler), section(section), start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer() {
+        profiler.Add(section, std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    FrameProfiler& profiler;
+    int section;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif //FINALPROJECT_FRAME_PROFILER_H
@@ -0,0 +1,102 @@
+//
+// GL_TIME_ELAPSED queries feeding FrameProfiler sections. Results are read back a few frames later
+// without stalling the pipeline and credited to the frame that issued them.
+//
+
+#ifndef FINALPROJECT_GPU_TIMER_H
+#define FINALPROJECT_GPU_TIMER_H
+
+#pragma once
+
+#include <array>
+
+#include <glad/glad.h>
+#include <frame_profiler.h>
+
+class GpuTimer {
+public:
+    static constexpr int kQueries = 16;
+
+    // Starts timing a section. Time-elapsed queries cannot nest, so a nested Begin is ignored.
+    bool Begin(int section, long long frame) {
+        if (active != -1 || section < 0) return false;
+        for (int i = 0; i < kQueries; ++i) {
+            Query& query = queries[i];
+            if (query.pending) continue;
+            if (query.id == 0) {
+                glGenQueries(1, &query.id);
+                if (query.id == 0) return false;
+            }
+            query.section = section;
+            query.frame = frame;
+            glBeginQuery(GL_TIME_ELAPSED, query.id);
+            active = i;
+            return true;
+        }
+        return false; // every query still in flight; skip this sample
+    }
+
+    void End() {
+        if (active == -1) return;
+        glEndQuery(GL_TIME_ELAPSED);
+        queries[active].pending = true;
+        active = -1;
+    }
+
+    // Moves finished results into the profiler. Call once per frame.
+    void Collect(FrameProfiler& profiler) {
+        for (Query& query : queries) {
+            if (!query.pending) continue;
+            GLint available = 0;
+            glGetQueryObjectiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) continue;
+            GLuint64 elapsed_ns = 0;
+            glGetQueryObjectui64v(query.id, GL_QUERY_RESULT, &elapsed_ns);
+            profiler.AddToFrame(query.section, float(double(elapsed_ns) / 1.0e6), query.frame);
+            query.pending = false;
+        }
+    }
+
+    void Shutdown() {
+        for (Query& query : queries) {
+            if (query.id != 0) {
+                glDeleteQueries(1, &query.id);
+                query.id = 0;
+            }
+            query.pending = false;
+        }
+        active = -1;
+    }
+
+private:
+    struct Query {
+        GLuint id = 0;
+        int section = -1;
+        long long frame = 0;
+        bool pending = false;
+    };
+
+    std::array<Query, kQueries> queries{};
+    int active = -1;
+};
+
+// Times the enclosing GL work into a profiler section.
+class ScopedGpuTimer {
+public:
+    ScopedGpuTimer(GpuTimer& timer, int section, long long frame) : timer(timer) {
+        started = timer.Begin(section, frame);
+    }
+
+    ~ScopedGpuTimer() {
+        if (started) timer.End();
+    }
+
+    ScopedGpuTimer(const ScopedGpuTimer&) = delete;
+    ScopedGpuTimer& operator=(const ScopedGpuTimer&) = delete;
+
+private:
+    GpuTimer& timer;
+    bool started = false;
+};
+
+#endif //FINALPROJECT_GPU_TIMER_H
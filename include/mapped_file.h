@@ -0,0 +1,100 @@
+//
+// Read-only view of a whole file: memory-mapped where POSIX mmap is available, read into memory elsewhere.
+//
+
+#ifndef FINALPROJECT_MAPPED_FILE_H
+#define FINALPROJECT_MAPPED_FILE_H
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define FINALPROJECT_MAPPED_FILE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <iterator>
+#include <string>
+#endif
+
+class MappedFile {
+public:
+    MappedFile() = default;
+
+#ifdef FINALPROJECT_MAPPED_FILE_MMAP
+    explicit MappedFile(const std::filesystem::path& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat info {};
+        if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* mapped = ::mmap(nullptr, std::size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                data = static_cast<const char*>(mapped);
+                size = std::size_t(info.st_size);
+                ::madvise(mapped, size, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd); // the mapping keeps its own reference
+    }
+
+    MappedFile(MappedFile&& other) noexcept
+        : data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0)) {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            Unmap();
+            data = std::exchange(other.data, nullptr);
+            size = std::exchange(other.size, 0);
+        }
+        return *this;
+    }
+
+    ~MappedFile() { Unmap(); }
+
+    // Empty for missing and zero-length files alike.
+    std::string_view View() const { return { data, size }; }
+#else
+    explicit MappedFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    MappedFile(MappedFile&& other) noexcept : contents(std::exchange(other.contents, {})) {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) contents = std::exchange(other.contents, {});
+        return *this;
+    }
+
+    // Empty for missing and zero-length files alike.
+    std::string_view View() const { return contents; }
+#endif
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+private:
+#ifdef FINALPROJECT_MAPPED_FILE_MMAP
+    void Unmap() {
+        if (data != nullptr) {
+            ::munmap(const_cast<char*>(data), size);
+            data = nullptr;
+            size = 0;
+        }
+    }
+
+    const char* data = nullptr;
+    std::size_t size = 0;
+#else
+    std::string contents;
+#endif
+};
+
+#endif //FINALPROJECT_MAPPED_FILE_H
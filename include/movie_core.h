@@ -0,0 +1,726 @@
+//
+// The part of the application that needs no window: the Movie record, OMDb requests through the quota,
+// coalescing, hedging, circuit-breaker and cache layers, parsing of the replies and resolving watch-list
+// imports. Shared by the desktop app (main.cpp) and the headless CLI (cli.cpp); nothing here touches
+// GLFW, OpenGL or ImGui.
+// There are no globals: the shared services live in an Engine the program creates once, and every request
+// names the Engine it goes through. Define MOVIE_CORE_IMPLEMENTATION in exactly one source file of a
+// program for the function definitions.
+// Requests are asynchronous underneath: every stage - quota admission, coalescing, cache, hedging and
+// retries - hands its result to a callback that runs on the engine's I/O thread, so many requests can be
+// in flight without a thread each. The plain functions block the calling thread until the answer is in;
+// coroutines co_await the Async* forms instead.
+//
+
+#ifndef FINALPROJECT_MOVIE_CORE_H
+#define FINALPROJECT_MOVIE_CORE_H
+
+#pragma once
+
+#ifndef CPPHTTPLIB_OPENSSL_SUPPORT
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#endif
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <task.h>
+#include <movie_record.h>
+#include <movie_sort.h>
+#include <watch_list_import.h>
+#include <single_flight.h>
+#include <quota_manager.h>
+#include <request_resilience.h>
+#include <circuit_breaker.h>
+#include <response_cache.h>
+#include <omdb_json.h>
+#include <event_http_client.h>
+#include <traffic_log.h>
+#include <httplib.h>
+
+#define USER_DIRECTORY "./users/"
+
+// Numeric fields are parsed from the OMDb strings once and formatted again only when drawn
+// (see movie_record.h); actors and directors are handles into StringInterner::Global().
+struct Movie {
+    std::uint32_t id = 0; // imdbID without the "tt" prefix
+    std::string title;
+    StringInterner::Handle director = 0;
+    std::int16_t year_start = 0;
+    std::int16_t year_end = 0; // 0 for a single year, movie_record::kOpenEnded for a running series
+    std::uint16_t runtime_minutes = 0;
+    std::int16_t rating_x10 = -1;
+    std::uint32_t votes = 0;
+    std::uint32_t genres = 0; // bits over movie_record::kGenreNames
+    std::array<StringInterner::Handle, 4> cast{};
+    std::uint8_t cast_count = 0;
+    std::string poster_url;
+    std::uint64_t title_key = 0; // movie_sort::ComputeSortKeys, refreshed whenever title or year change
+    std::uint32_t year_key = 0;
+    bool has_details = false; // filled from a title lookup, not just a search result or a saved entry
+};
+
+struct HttpResponse {
+    int status = 0; // 0 when the connection failed
+    std::string body;
+};
+
+enum class LookupResult { Found, NotFound, Failed, QuotaExceeded };
+
+// How ResolveImportItems spends requests.
+struct ImportOptions {
+    int concurrency = 1;              // lookups in flight at once
+    double requests_per_second = 0.0; // over all lookups; 0 leaves them unpaced
+    double quota_share = 1.0;         // of what is left of today's quota
+    QuotaManager::Priority priority = QuotaManager::Priority::Interactive;
+    bool refresh = false;             // look up items that already carry id, title and year too
+};
+
+struct ImportResult {
+    LookupResult result = LookupResult::Failed; // QuotaExceeded too when the budget ran out before the lookup
+    Movie movie;                                // when Found
+};
+
+// Process-wide services every session and every request shares: one quota, one set of connections, one
+// cache. Create one per process (all members are thread-safe) and keep it alive until every request that
+// went through it has returned.
+struct Engine {
+    QuotaManager omdb_quota;                 // keys from api_key.txt, with today's usage persisted in quota.txt
+    SingleFlight<HttpResponse> http_requests; // in-flight GETs by canonical URL, shared by concurrent callers
+    RequestResilience http_resilience;       // latency per host, hedging and retries for every GET
+    CircuitBreaker circuit_breakers;         // per host; an open circuit answers from response_cache only
+    ResponseCache response_cache;            // bodies of successful GETs (search, details, posters) on disk
+    traffic_log::Recorder traffic_recorder;  // AGM_RECORD_TRAFFIC: every response that came back, for replay
+    std::string replay_origin;               // AGM_REPLAY: a movie_cli replay server answering every GET instead;
+                                             // set before the first request
+    event_http::Client http_client;          // one I/O thread for every socket and timer, with kept-alive connections
+                                             // per host. Last, so it is destroyed first: shutting down completes the
+                                             // requests still in flight, whose callbacks use the members above
+};
+
+using HttpCallback = std::function<void(HttpResponse)>;
+using LookupCallback = std::function<void(LookupResult, Movie)>;
+
+inline constexpr std::chrono::seconds kHttpTimeout{ 15 };
+inline constexpr std::uintmax_t kResponseCacheBytes = 256ull << 20;
+inline const std::string kOmdbHost = "https://www.omdbapi.com";
+inline constexpr int kQuotaRejectedStatus = 429; // HttpResponse status when omdb_quota turned a request away
+
+// General
+std::string GetExecutablePath();
+void logError(const std::string& message);
+void read_api_key(Engine& engine, double speculative_share);
+void ConfigureTraffic(Engine& engine);
+
+// Network. The *Async functions call done exactly once, on the engine's I/O thread or, when the answer is
+// immediate (cache, open circuit, quota), on the calling thread; done should only hand the result on.
+std::pair<std::string, std::string> SplitUrl(const std::string& url);
+HttpResponse HttpGet(Engine& engine, const std::string& host, const std::string& path,
+                     const httplib::Headers& headers = {}, const CancelToken& token = CancelToken());
+void HttpGetAsync(Engine& engine, const std::string& host, const std::string& path, const httplib::Headers& headers,
+                  const CancelToken& token, HttpCallback done);
+void HttpGetDirectAsync(Engine& engine, const std::string& host, const std::string& path,
+                        const httplib::Headers& headers, const CancelToken& token, HttpCallback done);
+void HttpGetOnceAsync(Engine& engine, const std::string& host, const std::string& path,
+                      const httplib::Headers& headers, AttemptControl& control, HttpCallback done);
+bool IsRetryableResponse(const HttpResponse& response);
+bool IsRetryableFor(Engine& engine, const std::string& host, const HttpResponse& response);
+void FetchThroughCacheAsync(Engine& engine, const std::string& host, const std::string& cache_key,
+                            const CancelToken& abandoned, std::function<void(HttpCallback)> fetch, HttpCallback done);
+HttpResponse OmdbGet(Engine& engine, const std::string& query, QuotaManager::Priority priority,
+                     const CancelToken& token = CancelToken());
+void OmdbGetAsync(Engine& engine, const std::string& query, QuotaManager::Priority priority,
+                  const CancelToken& token, HttpCallback done);
+httplib::Headers PosterHeaders();
+void RunConcurrently(std::size_t count, int concurrency, const CancelToken& token,
+                     const std::function<void(std::size_t, std::function<void()>)>& start);
+
+// Movie
+std::string SearchQuery(const std::string& title);
+HttpResponse FetchMovieList(Engine& engine, const std::string& title);
+omdb_json::Reply ParseMovieDetails(std::string_view body, Movie& movie);
+LookupResult InterpretDetails(const std::string& query, const HttpResponse& res, Movie& movie);
+LookupResult RequestMovieDetails(Engine& engine, const std::string& query, QuotaManager::Priority priority,
+                                 Movie& movie, const CancelToken& token = CancelToken());
+void RequestMovieDetailsAsync(Engine& engine, const std::string& query, QuotaManager::Priority priority,
+                              Movie movie, const CancelToken& token, LookupCallback done);
+
+// Watch list import
+LookupResult LookupImportItem(Engine& engine, const watch_list_import::Item& item, Movie& movie,
+                              const ImportOptions& options, const CancelToken& token = CancelToken());
+void LookupImportItemAsync(Engine& engine, const watch_list_import::Item& item, const ImportOptions& options,
+                           const CancelToken& token, LookupCallback done);
+std::vector<ImportResult> ResolveImportItems(Engine& engine, const std::vector<watch_list_import::Item>& items,
+                                             const CancelToken& token, watch_list_import::Progress& progress,
+                                             const ImportOptions& options);
+
+// co_await forms for coroutines. They resume on the engine's I/O thread (or at once on an immediate
+// answer); follow them with co_await executor.schedule() before touching anything but locals.
+inline auto AsyncHttpGet(Engine& engine, std::string host, std::string path, httplib::Headers headers = {},
+                         CancelToken token = CancelToken()) {
+    return AwaitCompletion<HttpResponse>([&engine, host = std::move(host), path = std::move(path),
+                                          headers = std::move(headers), token](HttpCallback done) {
+        HttpGetAsync(engine, host, path, headers, token, std::move(done));
+    });
+}
+
+inline auto AsyncOmdbGet(Engine& engine, std::string query, QuotaManager::Priority priority,
+                         CancelToken token = CancelToken()) {
+    return AwaitCompletion<HttpResponse>([&engine, query = std::move(query), priority, token](HttpCallback done) {
+        OmdbGetAsync(engine, query, priority, token, std::move(done));
+    });
+}
+
+// The result, and movie as RequestMovieDetails left it
+inline auto AsyncRequestMovieDetails(Engine& engine, std::string query, QuotaManager::Priority priority, Movie movie,
+                                     CancelToken token = CancelToken()) {
+    return AwaitCompletion<std::pair<LookupResult, Movie>>(
+        [&engine, query = std::move(query), priority, movie = std::move(movie), token](
+            std::function<void(std::pair<LookupResult, Movie>)> done) mutable {
+            RequestMovieDetailsAsync(engine, query, priority, std::move(movie), token,
+                                     [done = std::move(done)](LookupResult result, Movie found) {
+                                         done({ result, std::move(found) });
+                                     });
+        });
+}
+
+// Calls on_movie(Movie&&) for each entry of an OMDb search reply (?s=), in reply order, in one pass over
+// the body. Entries come with id, title, year and poster ("N/A" becomes empty, as in ParseMovieDetails).
+template <typename F>
+omdb_json::Reply ParseSearchResults(std::string_view body, F on_movie) {
+    struct Results {
+        F& on_movie;
+        Movie movie;
+
+        void Field(std::string_view, std::string_view) {}
+        void BeginItem() {
+            movie = Movie();
+            movie.title = "Unknown";
+        }
+        void ItemField(std::string_view key, std::string_view value) {
+            if (key == "imdbID") movie.id = movie_record::ParseImdbId(value);
+            else if (key == "Title") movie.title = value;
+            else if (key == "Year") movie_record::ParseYear(value, movie.year_start, movie.year_end);
+            else if (key == "Poster") movie.poster_url = value == "N/A" ? std::string_view() : value;
+        }
+        void EndItem() {
+            movie_sort::ComputeSortKeys(movie);
+            on_movie(std::move(movie));
+        }
+    } results{ on_movie, Movie() };
+    return omdb_json::Reader(body).Visit(results);
+}
+
+#ifdef MOVIE_CORE_IMPLEMENTATION
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <thread>
+
+#if defined(__APPLE__)
+#include <mach-o/dyld.h>
+#endif
+
+// AGM_ROOT, or two levels above the binary: from the build folder to the directory containing main.cpp,
+// where api_key.txt, users/ and the cache live.
+std::string GetExecutablePath() {
+    if (const char* root = std::getenv("AGM_ROOT")) {
+        return root;
+    }
+    std::filesystem::path execPath;
+#if defined(__APPLE__)
+    char path[1024];
+    uint32_t size = sizeof(path);
+    if (_NSGetExecutablePath(path, &size) == 0) {
+        execPath = path;
+    }
+#elif defined(__linux__)
+    std::error_code error;
+    execPath = std::filesystem::read_symlink("/proc/self/exe", error);
+#endif
+    if (execPath.empty()) {
+        return "";
+    }
+    return execPath.parent_path().parent_path().string();
+}
+
+void logError(const std::string& message) {
+    std::ofstream logFile("error_log.txt", std::ios_base::app);
+    if (logFile.is_open()) {
+        time_t now = time(nullptr);
+        char* dt = ctime(&now);
+        logFile << dt << ": " << message << std::endl;
+        logFile.close();
+    }
+}
+
+// api_key.txt holds one key per line, optionally followed by its daily limit; see QuotaManager::ParseKeyFile
+void read_api_key(Engine& engine, double speculative_share) {
+    std::string exePath = GetExecutablePath();
+    std::string apiKeyPath = exePath + "/api_key.txt";
+    std::ifstream file(apiKeyPath);
+    std::vector<QuotaManager::KeyConfig> keys;
+    if (file.is_open()) {
+        std::stringstream contents;
+        contents << file.rdbuf();
+        keys = QuotaManager::ParseKeyFile(contents.str());
+        file.close();
+    } else {
+        std::cerr << "Unable to open api_key.txt at path: " << apiKeyPath << std::endl;
+    }
+    if (keys.empty() && !engine.replay_origin.empty()) {
+        keys.push_back({ "replay", 1000000 }); // recordings answer whichever key asks, as often as it asks
+    }
+
+    QuotaManager::Policy policy;
+    policy.speculative_share = speculative_share;
+    engine.omdb_quota.Configure(std::move(keys), policy, std::filesystem::path(exePath) / "quota.txt");
+}
+
+// AGM_RECORD_TRAFFIC=FILE appends every response to FILE (see traffic_log.h); AGM_REPLAY=http://HOST:PORT
+// sends every request to `movie_cli replay` instead of the network. Call before read_api_key, which lets a
+// replaying engine run without keys.
+void ConfigureTraffic(Engine& engine) {
+    if (const char* file = std::getenv("AGM_RECORD_TRAFFIC")) {
+        if (!engine.traffic_recorder.Open(file)) {
+            std::cerr << "Unable to open traffic log " << file << std::endl;
+        }
+    }
+    if (const char* origin = std::getenv("AGM_REPLAY")) {
+        engine.replay_origin = origin;
+        while (!engine.replay_origin.empty() && engine.replay_origin.back() == '/') engine.replay_origin.pop_back();
+    }
+}
+
+std::pair<std::string, std::string> SplitUrl(const std::string& url) {
+    std::size_t scheme_end = url.find("://");
+    std::size_t host_start = scheme_end == std::string::npos ? 0 : scheme_end + 3;
+    std::size_t path_start = url.find('/', host_start);
+    if (path_start == std::string::npos) {
+        return { url, "/" };
+    }
+    return { url.substr(0, path_start), url.substr(path_start) };
+}
+
+// Concurrent GETs of the same URL share one request. The key leaves out the headers: every caller of a
+// given URL sends the same ones (PosterHeaders for posters, none for OMDb). A caller whose token is
+// cancelled while it waits gets a failed response at once; the request itself carries on for the others
+// and still fills the cache, and stops (no further retries) only once every caller has been cancelled.
+void HttpGetAsync(Engine& engine, const std::string& host, const std::string& path, const httplib::Headers& headers,
+                  const CancelToken& token, HttpCallback done) {
+    std::string key = CanonicalUrl(host, path);
+    engine.http_requests.DoAsync(key, token, [&engine, host, path, headers, key](const CancelToken& abandoned,
+                                                                                 HttpCallback finish) {
+        FetchThroughCacheAsync(engine, host, key, abandoned, [&engine, host, path, headers, abandoned](HttpCallback fetched) {
+            HttpGetDirectAsync(engine, host, path, headers, abandoned, std::move(fetched));
+        }, std::move(finish));
+    }, [done = std::move(done)](std::optional<HttpResponse> response) {
+        done(response ? std::move(*response) : HttpResponse());
+    });
+}
+
+HttpResponse HttpGet(Engine& engine, const std::string& host, const std::string& path,
+                     const httplib::Headers& headers, const CancelToken& token) {
+    return WaitForCompletion<HttpResponse>([&](HttpCallback done) {
+        HttpGetAsync(engine, host, path, headers, token, std::move(done));
+    });
+}
+
+// One attempt of an OMDb query: with each key the quota admits in turn until one is not rejected
+static void TryOmdbKeys(Engine& engine, const std::string& path, QuotaManager::Priority priority,
+                        AttemptControl& control, HttpCallback done) {
+    std::string key;
+    if (engine.omdb_quota.Acquire(priority, key) != QuotaManager::Admission::Admitted) {
+        done(HttpResponse{ kQuotaRejectedStatus, {} });
+        return;
+    }
+    HttpGetOnceAsync(engine, kOmdbHost, path + "&apikey=" + key, {}, control,
+                     [&engine, path, priority, &control, key, done = std::move(done)](HttpResponse res) {
+        // 401 is "Request limit reached!" or "Invalid API key!": retire the key and try the next one
+        if (res.status != 401) {
+            done(std::move(res));
+            return;
+        }
+        logError("OMDb rejected API key ..." + key.substr(key.size() > 4 ? key.size() - 4 : 0) + ": " + res.body);
+        engine.omdb_quota.ReportExhausted(key);
+        TryOmdbKeys(engine, path, priority, control, std::move(done));
+    });
+}
+
+// GET kOmdbHost/?<query>&apikey=<key> with a key admitted by the engine's quota. The coalescing key leaves the
+// API key out, so callers of one query share a request whichever key it went out with. Background and
+// speculative callers are admitted before joining: background ones wait for bucket tokens on the engine's
+// timers, speculative ones are turned away instead, so an interactive caller joining the request is never
+// held up.
+void OmdbGetAsync(Engine& engine, const std::string& query, QuotaManager::Priority priority,
+                  const CancelToken& token, HttpCallback done) {
+    if (priority != QuotaManager::Priority::Interactive) {
+        QuotaManager::Admission admission = engine.omdb_quota.Check(priority);
+        if (admission == QuotaManager::Admission::Rejected ||
+            (admission != QuotaManager::Admission::Admitted && priority == QuotaManager::Priority::Speculative)) {
+            done(HttpResponse{ kQuotaRejectedStatus, {} });
+            return;
+        }
+        if (admission != QuotaManager::Admission::Admitted) {
+            if (token.cancelled()) {
+                done(HttpResponse());
+                return;
+            }
+            engine.http_client.After(std::chrono::milliseconds(250), [&engine, query, priority, token, done = std::move(done)] {
+                OmdbGetAsync(engine, query, priority, token, std::move(done));
+            });
+            return;
+        }
+    }
+
+    std::string path = "/?" + query;
+    std::string cache_key = CanonicalUrl(kOmdbHost, path);
+    engine.http_requests.DoAsync(cache_key, token, [&engine, path, cache_key, priority](const CancelToken& abandoned,
+                                                                                       HttpCallback finish) {
+        FetchThroughCacheAsync(engine, kOmdbHost, cache_key, abandoned, [&engine, path, priority, abandoned](HttpCallback fetched) {
+            // Every attempt, hedges and retries included, is admitted and counted separately
+            engine.http_resilience.RunAsync<HttpResponse>(kOmdbHost, engine.http_client, abandoned,
+                [&engine, path, priority](AttemptControl& control, HttpCallback finished) {
+                    TryOmdbKeys(engine, path, priority, control, std::move(finished));
+                },
+                [&engine](const HttpResponse& res) { return IsRetryableFor(engine, kOmdbHost, res); },
+                std::move(fetched));
+        }, std::move(finish));
+    }, [done = std::move(done)](std::optional<HttpResponse> response) {
+        done(response ? std::move(*response) : HttpResponse());
+    });
+}
+
+HttpResponse OmdbGet(Engine& engine, const std::string& query, QuotaManager::Priority priority,
+                     const CancelToken& token) {
+    return WaitForCompletion<HttpResponse>([&](HttpCallback done) {
+        OmdbGetAsync(engine, query, priority, token, std::move(done));
+    });
+}
+
+// Uncoalesced GET, hedged past the host's p95 and retried with backoff on connection failures and 5xx until
+// token is cancelled
+void HttpGetDirectAsync(Engine& engine, const std::string& host, const std::string& path,
+                        const httplib::Headers& headers, const CancelToken& token, HttpCallback done) {
+    engine.http_resilience.RunAsync<HttpResponse>(host, engine.http_client, token,
+        [&engine, host, path, headers](AttemptControl& control, HttpCallback finished) {
+            HttpGetOnceAsync(engine, host, path, headers, control, std::move(finished));
+        },
+        [&engine, host](const HttpResponse& res) { return IsRetryableFor(engine, host, res); },
+        std::move(done));
+}
+
+// Retrying is pointless once other requests have opened the host's circuit
+bool IsRetryableFor(Engine& engine, const std::string& host, const HttpResponse& response) {
+    return IsRetryableResponse(response) && engine.circuit_breakers.GetState(host) == CircuitBreaker::State::Closed;
+}
+
+// Network first while the host's circuit lets requests through; while it is open only the cache answers
+// and a miss fails at once instead of waiting out the timeouts. Successful bodies are written through to
+// the cache, and a request that could not reach the host falls back to a cached copy. fetch(done) starts
+// the request; the cache is read and written on whichever thread answers it. A request that failed because
+// abandoned was cancelled (every caller left) says nothing about the host and is not counted against it.
+void FetchThroughCacheAsync(Engine& engine, const std::string& host, const std::string& cache_key,
+                            const CancelToken& abandoned, std::function<void(HttpCallback)> fetch,
+                            HttpCallback done) {
+    if (!engine.circuit_breakers.Allow(host)) {
+        if (std::optional<std::string> cached = engine.response_cache.Get(cache_key)) {
+            done({ 200, std::move(*cached) });
+            return;
+        }
+        done(HttpResponse());
+        return;
+    }
+
+    fetch([&engine, host, cache_key, abandoned, done = std::move(done)](HttpResponse response) {
+        if (response.status == kQuotaRejectedStatus) {
+            engine.circuit_breakers.Abandon(host); // never left the machine
+            done(std::move(response));
+            return;
+        }
+        bool reached = !IsRetryableResponse(response);
+        if (!reached && abandoned.cancelled()) {
+            engine.circuit_breakers.Abandon(host); // cut short by the callers, not failed by the host
+            done(std::move(response));
+            return;
+        }
+        engine.circuit_breakers.Record(host, reached);
+        if (response.status == 200) {
+            engine.response_cache.Put(cache_key, response.body);
+        }
+        else if (!reached) {
+            if (std::optional<std::string> cached = engine.response_cache.Get(cache_key)) {
+                done({ 200, std::move(*cached) });
+                return;
+            }
+        }
+        done(std::move(response));
+    });
+}
+
+// No response at all (timeout, reset, stalled TLS) or a server-side error; 4xx answers are final
+bool IsRetryableResponse(const HttpResponse& response) {
+    return response.status == 0 || response.status == 408 || response.status >= 500;
+}
+
+// One attempt, handed to the engine's I/O thread. Aborting it (a hedge won) cancels the request, which
+// fails it at once. A replaying engine asks the replay server for the recording of the URL instead, and
+// a recording engine logs every response that came back.
+void HttpGetOnceAsync(Engine& engine, const std::string& host, const std::string& path,
+                      const httplib::Headers& headers, AttemptControl& control, HttpCallback done) {
+    if (control.aborted()) {
+        done(HttpResponse());
+        return;
+    }
+    std::string url = host + path;
+    if (!engine.replay_origin.empty()) {
+        url = engine.replay_origin + "/replay?url=" + httplib::detail::encode_query_param(traffic_log::RecordedUrl(host, path));
+    }
+    event_http::Headers request_headers(headers.begin(), headers.end());
+    auto started = std::chrono::steady_clock::now();
+    std::uint64_t id = engine.http_client.Get(url, std::move(request_headers), kHttpTimeout,
+        [&engine, host, path, started, done = std::move(done)](event_http::Response res) {
+            if (!res.error.empty() && res.error != "cancelled") {
+                logError("HttpGet for " + host + path + " failed: " + res.error);
+            }
+            if (res.status != 0 && engine.traffic_recorder.IsOpen()) {
+                std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - started;
+                engine.traffic_recorder.Record(traffic_log::RecordedUrl(host, path), res.status, res.body, latency.count());
+            }
+            done({ res.status, std::move(res.body) });
+        });
+    control.set_abort([&engine, id] { engine.http_client.Cancel(id); });
+}
+
+// Blocks the calling thread, which starts start(i, done) for each index in turn while fewer than
+// concurrency are running; the work itself runs wherever start sends it and calls done() once when
+// finished. Stops handing out indexes once token is cancelled, and returns when everything started is done.
+void RunConcurrently(std::size_t count, int concurrency, const CancelToken& token,
+                     const std::function<void(std::size_t, std::function<void()>)>& start) {
+    std::mutex mutex;
+    std::condition_variable changed;
+    int running = 0;
+    CancelToken::Callback wake(token, [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        changed.notify_all();
+    });
+    std::unique_lock<std::mutex> lock(mutex);
+    for (std::size_t i = 0; i < count; ++i) {
+        changed.wait(lock, [&] { return running < std::max(concurrency, 1) || token.cancelled(); });
+        if (token.cancelled()) break;
+        ++running;
+        lock.unlock();
+        start(i, [&] {
+            std::lock_guard<std::mutex> done_lock(mutex);
+            --running;
+            changed.notify_all(); // under the lock: the caller may return and take changed with it right after
+        });
+        lock.lock();
+    }
+    changed.wait(lock, [&] { return running == 0; });
+}
+
+httplib::Headers PosterHeaders() {
+    return {
+            {"User-Agent", "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/91.0.4472.124 Safari/537.36"}
+    };
+}
+
+// OMDb search query for title; ParseSearchResults reads the reply
+std::string SearchQuery(const std::string& title) {
+    return "s=" + httplib::detail::encode_url(title) + "&type=movie";
+}
+
+HttpResponse FetchMovieList(Engine& engine, const std::string& title) {
+    return OmdbGet(engine, SearchQuery(title), QuotaManager::Priority::Interactive);
+}
+
+// Fills movie from an OMDb title response (?t= or ?i=) in one pass over the body; movie is only changed
+// when the reply is True
+omdb_json::Reply ParseMovieDetails(std::string_view body, Movie& movie) {
+    struct Details {
+        Movie movie;
+
+        void Field(std::string_view key, std::string_view value) {
+            if (key == "Title") movie.title = value;
+            else if (key == "Year") movie_record::ParseYear(value, movie.year_start, movie.year_end);
+            else if (key == "Director") {
+                movie.director = value == "N/A" ? 0 : StringInterner::Global().Intern(movie_record::Trim(value));
+            }
+            else if (key == "Runtime") movie.runtime_minutes = movie_record::ParseRuntime(value);
+            else if (key == "imdbRating") movie.rating_x10 = movie_record::ParseRating(value);
+            else if (key == "imdbVotes") movie.votes = movie_record::ParseVotes(value);
+            else if (key == "imdbID") movie.id = movie_record::ParseImdbId(value);
+            else if (key == "Genre") movie.genres = movie_record::ParseGenres(value);
+            else if (key == "Actors") {
+                // Cast: the first few names, interned
+                movie.cast_count = 0;
+                movie_record::InternList(value, [&](StringInterner::Handle actor) {
+                    if (movie.cast_count < movie.cast.size()) {
+                        movie.cast[movie.cast_count++] = actor;
+                    }
+                });
+            }
+            else if (key == "Poster") movie.poster_url = value == "N/A" ? std::string_view() : value;
+        }
+        void BeginItem() {}
+        void ItemField(std::string_view, std::string_view) {}
+        void EndItem() {}
+    } details{ movie };
+
+    // Fields the response leaves out are unknown, not whatever the movie had before
+    details.movie.director = 0;
+    details.movie.runtime_minutes = 0;
+    details.movie.rating_x10 = -1;
+    details.movie.votes = 0;
+    details.movie.id = 0;
+    details.movie.genres = 0;
+    details.movie.cast_count = 0;
+    details.movie.poster_url.clear();
+
+    omdb_json::Reply reply = omdb_json::Reader(body).Visit(details);
+    if (reply == omdb_json::Reply::True) {
+        movie_sort::ComputeSortKeys(details.movie);
+        details.movie.has_details = true;
+        movie = std::move(details.movie);
+    }
+    return reply;
+}
+
+// Title lookup by "i=<imdbID>" or "t=<title>[&y=<year>]"
+LookupResult RequestMovieDetails(Engine& engine, const std::string& query, QuotaManager::Priority priority,
+                                 Movie& movie, const CancelToken& token) {
+    return InterpretDetails(query, OmdbGet(engine, query, priority, token), movie);
+}
+
+void RequestMovieDetailsAsync(Engine& engine, const std::string& query, QuotaManager::Priority priority,
+                              Movie movie, const CancelToken& token, LookupCallback done) {
+    OmdbGetAsync(engine, query, priority, token,
+                 [query, movie = std::move(movie), done = std::move(done)](HttpResponse res) mutable {
+        LookupResult result = InterpretDetails(query, res, movie);
+        done(result, std::move(movie));
+    });
+}
+
+// What the reply to a title lookup says; movie is filled in when it was found
+LookupResult InterpretDetails(const std::string& query, const HttpResponse& res, Movie& movie) {
+    if (res.status == 0) {
+        return LookupResult::Failed;
+    }
+    if (res.status == kQuotaRejectedStatus) {
+        return LookupResult::QuotaExceeded;
+    }
+    switch (ParseMovieDetails(res.body, movie)) {
+        case omdb_json::Reply::True:
+            return movie.id != 0 ? LookupResult::Found : LookupResult::NotFound;
+        case omdb_json::Reply::False:
+            return res.status == 200 ? LookupResult::NotFound : LookupResult::Failed;
+        case omdb_json::Reply::Malformed:
+            break;
+    }
+    logError("Invalid response for " + query);
+    return LookupResult::Failed;
+}
+
+// Entries that already carry id, title and year are taken as they are unless options.refresh asks for their
+// details; the rest are looked up by id or by title.
+void LookupImportItemAsync(Engine& engine, const watch_list_import::Item& item, const ImportOptions& options,
+                           const CancelToken& token, LookupCallback done) {
+    Movie movie;
+    if (item.Complete() && !options.refresh) {
+        movie.id = movie_record::ParseImdbId(item.id);
+        movie.title = item.title;
+        movie_record::ParseYear(item.year, movie.year_start, movie.year_end);
+        movie_sort::ComputeSortKeys(movie);
+        LookupResult result = movie.id != 0 ? LookupResult::Found : LookupResult::NotFound;
+        done(result, std::move(movie));
+        return;
+    }
+
+    RequestMovieDetailsAsync(engine, item.id.empty()
+        ? "t=" + httplib::detail::encode_url(item.title) + (item.year.empty() ? "" : "&y=" + item.year)
+        : "i=" + item.id, options.priority, std::move(movie), token, std::move(done));
+}
+
+LookupResult LookupImportItem(Engine& engine, const watch_list_import::Item& item, Movie& movie,
+                              const ImportOptions& options, const CancelToken& token) {
+    auto [result, found] = WaitForCompletion<std::pair<LookupResult, Movie>>(
+        [&](std::function<void(std::pair<LookupResult, Movie>)> done) {
+            LookupImportItemAsync(engine, item, options, token, [done = std::move(done)](LookupResult result, Movie found) {
+                done({ result, std::move(found) });
+            });
+        });
+    movie = std::move(found);
+    return result;
+}
+
+// Blocks the calling thread while up to options.concurrency lookups run on the engine's I/O thread. Lookups
+// are spaced to options.requests_per_second overall and may spend options.quota_share of what is left of
+// today's quota. Results keep the item order; progress is updated as items finish.
+std::vector<ImportResult> ResolveImportItems(Engine& engine, const std::vector<watch_list_import::Item>& items,
+                                             const CancelToken& token, watch_list_import::Progress& progress,
+                                             const ImportOptions& options) {
+    std::vector<ImportResult> results(items.size());
+    QuotaManager::Totals quota = engine.omdb_quota.GetTotals();
+    int budget = int(std::max(0, quota.limit - quota.used) * options.quota_share);
+    std::atomic<bool> quota_reached{ false };
+
+    auto next_request = std::chrono::steady_clock::now();
+    auto interval = options.requests_per_second > 0.0
+        ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              std::chrono::duration<double>(1.0 / options.requests_per_second))
+        : std::chrono::steady_clock::duration::zero();
+
+    RunConcurrently(items.size(), options.concurrency, token, [&](std::size_t i, std::function<void()> finished) {
+        const watch_list_import::Item& item = items[i];
+        if (options.refresh || !item.Complete()) {
+            if (quota_reached.load() || budget-- <= 0) {
+                results[i].result = LookupResult::QuotaExceeded;
+                ++progress.deferred;
+                ++progress.processed;
+                finished();
+                return;
+            }
+            // Only this thread hands out items, so pacing is a wait here
+            auto slot = std::max(next_request, std::chrono::steady_clock::now());
+            next_request = slot + interval;
+            std::this_thread::sleep_until(slot);
+        }
+
+        LookupImportItemAsync(engine, item, options, token,
+                              [&, i, finished = std::move(finished)](LookupResult result, Movie movie) {
+            results[i] = { result, std::move(movie) };
+            switch (result) {
+                case LookupResult::Found: break;
+                case LookupResult::NotFound: ++progress.not_found; break;
+                case LookupResult::Failed: ++progress.failed; break;
+                case LookupResult::QuotaExceeded:
+                    quota_reached = true;
+                    ++progress.deferred;
+                    break;
+            }
+            ++progress.processed;
+            finished();
+        });
+    });
+    return results;
+}
+
+#endif // MOVIE_CORE_IMPLEMENTATION
+
+#endif //FINALPROJECT_MOVIE_CORE_H
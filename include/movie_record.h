@@ -0,0 +1,221 @@
+//
+// Compact encodings for the Movie fields that OMDb returns as strings.
+// Values are parsed once when a response arrives and formatted into caller-provided buffers at
+// render time, so copying or comparing a movie never touches the heap.
+//
+
+#ifndef FINALPROJECT_MOVIE_RECORD_H
+#define FINALPROJECT_MOVIE_RECORD_H
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Shared table of strings that repeat across movies (actors, directors). Handles stay valid for the
+// lifetime of the program; handle 0 is the empty string.
+class StringInterner {
+public:
+    using Handle = std::uint32_t;
+
+    static StringInterner& Global() {
+        static StringInterner interner;
+        return interner;
+    }
+
+    StringInterner() {
+        strings.emplace_back();
+        lookup.emplace(std::string_view(strings.back()), 0);
+    }
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    Handle Intern(std::string_view text) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = lookup.find(text);
+        if (it != lookup.end()) return it->second;
+        Handle handle = Handle(strings.size());
+        strings.emplace_back(text);
+        lookup.emplace(std::string_view(strings.back()), handle); // deque elements never move
+        return handle;
+    }
+
+    const std::string& Get(Handle handle) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return handle < strings.size() ? strings[handle] : strings[0];
+    }
+
+    std::size_t Size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return strings.size();
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::deque<std::string> strings;
+    std::unordered_map<std::string_view, Handle> lookup;
+};
+
+namespace movie_record {
+
+    constexpr std::int16_t kOpenEnded = -1; // "2011–": a series that is still running
+
+    // Genres OMDb reports, one bit each.
+    constexpr std::array<const char*, 28> kGenreNames = {
+        "Action", "Adult", "Adventure", "Animation", "Biography", "Comedy", "Crime",
+        "Documentary", "Drama", "Family", "Fantasy", "Film-Noir", "Game-Show", "History",
+        "Horror", "Music", "Musical", "Mystery", "News", "Reality-TV", "Romance",
+        "Sci-Fi", "Short", "Sport", "Talk-Show", "Thriller", "War", "Western"
+    };
+
+    inline std::string_view Trim(std::string_view text) {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) text.remove_suffix(1);
+        return text;
+    }
+
+    // Reads leading decimal digits, skipping any ',' thousands separators. Returns false if there are none.
+    inline bool ParseDigits(std::string_view& text, std::uint64_t& value) {
+        value = 0;
+        bool any = false;
+        while (!text.empty() && ((text.front() >= '0' && text.front() <= '9') || (any && text.front() == ','))) {
+            if (text.front() != ',') {
+                value = value * 10 + std::uint64_t(text.front() - '0');
+                any = true;
+            }
+            text.remove_prefix(1);
+        }
+        return any;
+    }
+
+    // "tt0417741" -> 417741; 0 when the id is missing or malformed.
+    inline std::uint32_t ParseImdbId(std::string_view text) {
+        text = Trim(text);
+        if (text.size() < 3 || text[0] != 't' || text[1] != 't') return 0;
+        text.remove_prefix(2);
+        std::uint64_t value = 0;
+        if (!ParseDigits(text, value) || !text.empty() || value > 0xFFFFFFFFu) return 0;
+        return std::uint32_t(value);
+    }
+
+    // IMDb pads ids to at least seven digits.
+    inline int FormatImdbId(std::uint32_t id, char* buffer, std::size_t size) {
+        return std::snprintf(buffer, size, "tt%07u", unsigned(id));
+    }
+
+    inline std::string ImdbIdString(std::uint32_t id) {
+        char buffer[16];
+        FormatImdbId(id, buffer, sizeof(buffer));
+        return buffer;
+    }
+
+    // "2011", "2011–2013" (en dash or hyphen) or "2011–". Unknown years leave start at 0.
+    inline void ParseYear(std::string_view text, std::int16_t& start, std::int16_t& end) {
+        start = 0;
+        end = 0;
+        text = Trim(text);
+        std::uint64_t value = 0;
+        if (!ParseDigits(text, value)) return;
+        start = std::int16_t(value);
+        if (text.empty()) return;
+        if (text.substr(0, 3) == "\xE2\x80\x93") text.remove_prefix(3);
+        else if (text.front() == '-') text.remove_prefix(1);
+        else return;
+        end = ParseDigits(text, value) ? std::int16_t(value) : kOpenEnded;
+    }
+
+    inline int FormatYear(std::int16_t start, std::int16_t end, char* buffer, std::size_t size) {
+        if (start == 0) return std::snprintf(buffer, size, "Unknown");
+        if (end == kOpenEnded) return std::snprintf(buffer, size, "%d\xE2\x80\x93", int(start));
+        if (end != 0) return std::snprintf(buffer, size, "%d\xE2\x80\x93%d", int(start), int(end));
+        return std::snprintf(buffer, size, "%d", int(start));
+    }
+
+    // "136 min" -> 136; 0 when unknown.
+    inline std::uint16_t ParseRuntime(std::string_view text) {
+        text = Trim(text);
+        std::uint64_t value = 0;
+        return ParseDigits(text, value) && value <= 0xFFFF ? std::uint16_t(value) : 0;
+    }
+
+    inline int FormatRuntime(std::uint16_t minutes, char* buffer, std::size_t size) {
+        if (minutes == 0) return std::snprintf(buffer, size, "Unknown");
+        return std::snprintf(buffer, size, "%u min", unsigned(minutes));
+    }
+
+    // "7.8" -> 78; -1 when the rating is "N/A".
+    inline std::int16_t ParseRating(std::string_view text) {
+        text = Trim(text);
+        std::uint64_t whole = 0;
+        if (!ParseDigits(text, whole)) return -1;
+        std::uint64_t tenths = 0;
+        if (!text.empty() && text.front() == '.') {
+            text.remove_prefix(1);
+            if (!text.empty() && text.front() >= '0' && text.front() <= '9') tenths = std::uint64_t(text.front() - '0');
+        }
+        return std::int16_t(whole * 10 + tenths);
+    }
+
+    inline int FormatRating(std::int16_t rating_x10, char* buffer, std::size_t size) {
+        if (rating_x10 < 0) return std::snprintf(buffer, size, "N/A");
+        return std::snprintf(buffer, size, "%d.%d", rating_x10 / 10, rating_x10 % 10);
+    }
+
+    // "1,234,567" -> 1234567; 0 when unknown.
+    inline std::uint32_t ParseVotes(std::string_view text) {
+        text = Trim(text);
+        std::uint64_t value = 0;
+        return ParseDigits(text, value) && value <= 0xFFFFFFFFu ? std::uint32_t(value) : 0;
+    }
+
+    inline int FormatVotes(std::uint32_t votes, char* buffer, std::size_t size) {
+        if (votes == 0) return std::snprintf(buffer, size, "N/A");
+        if (votes >= 1000000) {
+            return std::snprintf(buffer, size, "%u,%03u,%03u", unsigned(votes / 1000000), unsigned(votes / 1000 % 1000), unsigned(votes % 1000));
+        }
+        if (votes >= 1000) return std::snprintf(buffer, size, "%u,%03u", unsigned(votes / 1000), unsigned(votes % 1000));
+        return std::snprintf(buffer, size, "%u", unsigned(votes));
+    }
+
+    // "Action, Crime, Drama" -> bitmask over kGenreNames; unknown names are dropped.
+    inline std::uint32_t ParseGenres(std::string_view text) {
+        std::uint32_t mask = 0;
+        while (!text.empty()) {
+            std::size_t comma = text.find(',');
+            std::string_view name = Trim(text.substr(0, comma));
+            for (std::size_t i = 0; i < kGenreNames.size(); ++i) {
+                if (name == kGenreNames[i]) {
+                    mask |= 1u << i;
+                    break;
+                }
+            }
+            if (comma == std::string_view::npos) break;
+            text.remove_prefix(comma + 1);
+        }
+        return mask;
+    }
+
+    // Calls fn(handle) for each comma-separated name, interning it.
+    template <typename F>
+    void InternList(std::string_view text, F fn) {
+        while (!text.empty()) {
+            std::size_t comma = text.find(',');
+            std::string_view name = Trim(text.substr(0, comma));
+            if (!name.empty() && name != "N/A") {
+                fn(StringInterner::Global().Intern(name));
+            }
+            if (comma == std::string_view::npos) break;
+            text.remove_prefix(comma + 1);
+        }
+    }
+
+} // namespace movie_record
+
+#endif //FINALPROJECT_MOVIE_RECORD_H
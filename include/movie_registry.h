@@ -0,0 +1,103 @@
+//
+// One canonical, immutable record per id, shared by every view that shows it.
+// Views hold a Ref: copying one only bumps a reference count, and every copy sees the record the
+// registry currently publishes for that id. Updates are copy-on-write - Publish swaps in a new record -
+// so a snapshot taken earlier (e.g. for a background lookup) never changes under its reader.
+// A record whose keys change moves in sorted views, so publish through whatever keeps those views in
+// order. Not thread-safe: use from the UI thread and hand background work a Snapshot.
+//
+// Record needs an id member; id 0 (not identified) gets a record of its own that is never shared.
+//
+
+#ifndef FINALPROJECT_MOVIE_REGISTRY_H
+#define FINALPROJECT_MOVIE_REGISTRY_H
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+template <typename Record>
+class RecordRegistry {
+    struct Cell {
+        std::shared_ptr<const Record> current;
+    };
+
+public:
+    using Key = decltype(Record::id);
+
+    class Ref {
+    public:
+        Ref() = default;
+
+        // An empty Ref reads as a default-constructed record.
+        const Record& operator*() const { return cell ? *cell->current : Empty(); }
+        const Record* operator->() const { return &**this; }
+        explicit operator bool() const { return cell != nullptr; }
+
+        // The record as published right now; stays unchanged whatever is published later.
+        std::shared_ptr<const Record> Snapshot() const {
+            return cell ? cell->current : std::shared_ptr<const Record>();
+        }
+
+        // Same record, not just equal contents.
+        bool operator==(const Ref& other) const { return cell == other.cell; }
+
+    private:
+        friend class RecordRegistry;
+
+        explicit Ref(std::shared_ptr<Cell> cell) : cell(std::move(cell)) {}
+
+        static const Record& Empty() {
+            static const Record empty;
+            return empty;
+        }
+
+        std::shared_ptr<Cell> cell;
+    };
+
+    // The Ref for id if any view still holds the record, else an empty Ref.
+    Ref Find(const Key& id) const {
+        auto it = cells.find(id);
+        return it == cells.end() ? Ref() : Ref(it->second.lock());
+    }
+
+    // Makes record the one published for its id and returns its Ref; existing Refs see it at once.
+    Ref Publish(Record record) {
+        auto current = std::make_shared<const Record>(std::move(record));
+        Key id = current->id;
+        if (id == Key()) {
+            return Ref(std::make_shared<Cell>(Cell{ std::move(current) }));
+        }
+        std::weak_ptr<Cell>& entry = cells[id];
+        std::shared_ptr<Cell> cell = entry.lock();
+        if (cell) {
+            cell->current = std::move(current);
+            return Ref(std::move(cell));
+        }
+        cell = std::make_shared<Cell>(Cell{ std::move(current) });
+        entry = cell;
+        if (cells.size() >= prune_at) Prune();
+        return Ref(std::move(cell));
+    }
+
+    // Records some view still holds (after the last prune).
+    std::size_t Size() const { return cells.size(); }
+
+private:
+    // Forgets ids no view holds any more, once the table has doubled since the last time.
+    void Prune() {
+        for (auto it = cells.begin(); it != cells.end();) {
+            it = it->second.expired() ? cells.erase(it) : std::next(it);
+        }
+        prune_at = std::max<std::size_t>(64, cells.size() * 2);
+    }
+
+    std::unordered_map<Key, std::weak_ptr<Cell>> cells;
+    std::size_t prune_at = 64;
+};
+
+#endif //FINALPROJECT_MOVIE_REGISTRY_H
@@ -0,0 +1,246 @@
+//
+// Sorting for the movie tables.
+// Each record carries normalized keys computed once when its fields are parsed (ComputeSortKeys);
+// comparators are instantiated per column and direction so the inner loop has no runtime branching,
+// whole lists are sorted by ranks copied out of the records (in parallel chunks when large), and an
+// entry whose keys change is moved into place by binary search instead of re-sorting the list.
+//
+// Records need: id, title, title_key, year_key (and year_start / year_end for ComputeSortKeys). The
+// comparators also take pointer-like handles to such records, e.g. shared ones from a registry.
+//
+
+#ifndef FINALPROJECT_MOVIE_SORT_H
+#define FINALPROJECT_MOVIE_SORT_H
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <movie_record.h>
+
+namespace movie_sort {
+
+    enum class Column { Title, Year };
+
+    // Below this many records a plain std::sort beats the cost of starting threads.
+    constexpr std::size_t kParallelThreshold = 32768;
+
+    inline unsigned char Fold(unsigned char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c - 'A' + 'a') : c;
+    }
+
+    // First eight case-folded bytes, big-endian, so most title comparisons are one integer compare.
+    inline std::uint64_t TitlePrefix(std::string_view title) {
+        std::uint64_t key = 0;
+        for (std::size_t i = 0; i < 8; ++i) {
+            key <<= 8;
+            if (i < title.size()) key |= Fold(static_cast<unsigned char>(title[i]));
+        }
+        return key;
+    }
+
+    // Wider key for bulk sorts, where it is computed once per record right before sorting.
+    inline std::pair<std::uint64_t, std::uint64_t> TitleRank(std::string_view title) {
+        return { TitlePrefix(title), TitlePrefix(title.size() > 8 ? title.substr(8) : std::string_view()) };
+    }
+
+    inline int CompareFolded(std::string_view a, std::string_view b) {
+        std::size_t n = std::min(a.size(), b.size());
+        for (std::size_t i = 0; i < n; ++i) {
+            unsigned char x = Fold(static_cast<unsigned char>(a[i]));
+            unsigned char y = Fold(static_cast<unsigned char>(b[i]));
+            if (x != y) return x < y ? -1 : 1;
+        }
+        return a.size() == b.size() ? 0 : (a.size() < b.size() ? -1 : 1);
+    }
+
+    // Start year first; for the same start a single year sorts before an open-ended series, then ranges by end year
+    // (the order of the "2011", "2011–" and "2011–2015" strings). The low half is 0 for a single year, 1 for an
+    // open-ended series and the end year otherwise, which is always larger.
+    inline std::uint32_t YearKey(std::int16_t start, std::int16_t end) {
+        std::uint16_t end_rank = end == movie_record::kOpenEnded ? 1 : std::uint16_t(end);
+        return (std::uint32_t(std::uint16_t(start)) << 16) | end_rank;
+    }
+
+    template <typename Record>
+    void ComputeSortKeys(Record& record) {
+        record.title_key = TitlePrefix(record.title);
+        record.year_key = YearKey(record.year_start, record.year_end);
+    }
+
+    // The record itself, or the one a handle points to.
+    template <typename Record>
+    const auto& Fields(const Record& record) {
+        if constexpr (requires { record.title_key; }) return record;
+        else return *record;
+    }
+
+    // Strict total orders: ties fall through to the raw title and finally the id, so reversing an
+    // ascending list yields exactly the descending one.
+    template <Column C>
+    struct Less;
+
+    template <>
+    struct Less<Column::Title> {
+        template <typename Record>
+        bool operator()(const Record& first, const Record& second) const {
+            const auto& a = Fields(first);
+            const auto& b = Fields(second);
+            if (a.title_key != b.title_key) return a.title_key < b.title_key;
+            if (int c = CompareFolded(a.title, b.title)) return c < 0;
+            if (a.title != b.title) return a.title < b.title;
+            return a.id < b.id;
+        }
+    };
+
+    template <>
+    struct Less<Column::Year> {
+        template <typename Record>
+        bool operator()(const Record& a, const Record& b) const {
+            if (Fields(a).year_key != Fields(b).year_key) return Fields(a).year_key < Fields(b).year_key;
+            return Less<Column::Title>{}(a, b);
+        }
+    };
+
+    template <Column C, bool Ascending>
+    struct Comparator {
+        template <typename Record>
+        bool operator()(const Record& a, const Record& b) const {
+            return Ascending ? Less<C>{}(a, b) : Less<C>{}(b, a);
+        }
+    };
+
+    // Sorts equal-sized chunks on worker threads, then merges neighbouring runs level by level.
+    template <typename It, typename Cmp>
+    void ParallelSort(It first, It last, Cmp cmp) {
+        std::size_t count = std::size_t(last - first);
+        std::size_t workers = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                                    count / (kParallelThreshold / 4) + 1);
+        if (count < kParallelThreshold || workers < 2) {
+            std::sort(first, last, cmp);
+            return;
+        }
+
+        std::vector<It> bounds;
+        bounds.reserve(workers + 1);
+        for (std::size_t i = 0; i <= workers; ++i) {
+            bounds.push_back(first + std::ptrdiff_t(count * i / workers));
+        }
+
+        std::vector<std::thread> threads;
+        threads.reserve(workers);
+        for (std::size_t i = 1; i < workers; ++i) {
+            threads.emplace_back([&, i] { std::sort(bounds[i], bounds[i + 1], cmp); });
+        }
+        std::sort(bounds[0], bounds[1], cmp);
+        for (auto& thread : threads) thread.join();
+
+        for (std::size_t width = 1; width < workers; width *= 2) {
+            threads.clear();
+            for (std::size_t i = 0; i + width < workers; i += 2 * width) {
+                It begin = bounds[i];
+                It middle = bounds[i + width];
+                It end = bounds[std::min(i + 2 * width, workers)];
+                threads.emplace_back([=] { std::inplace_merge(begin, middle, end, cmp); });
+            }
+            for (auto& thread : threads) thread.join();
+        }
+    }
+
+    // Runs fn with the comparator instance matching the column and direction.
+    template <typename F>
+    auto Dispatch(Column column, bool ascending, F fn) {
+        if (column == Column::Title) {
+            return ascending ? fn(Comparator<Column::Title, true>{}) : fn(Comparator<Column::Title, false>{});
+        }
+        return ascending ? fn(Comparator<Column::Year, true>{}) : fn(Comparator<Column::Year, false>{});
+    }
+
+    // Key for a bulk sort: never orders two records against Less<C>, and tells most pairs apart on its own.
+    template <Column C, typename Record>
+    auto Rank(const Record& record) {
+        const auto& fields = Fields(record);
+        if constexpr (C == Column::Title) return TitleRank(fields.title);
+        else return std::make_pair(fields.year_key, TitleRank(fields.title));
+    }
+
+    // Sorts ascending by ranks computed once per record, so the comparisons run over a flat array instead of
+    // following every record's pointers, then orders the runs of equal rank with Less<C>. The scratch arrays
+    // come from the records' allocator, so a list kept in an arena does not sort on the heap.
+    template <Column C, typename Record, typename Allocator>
+    void RankedSort(std::vector<Record, Allocator>& records) {
+        using Ranked = std::pair<decltype(Rank<C>(records[0])), std::uint32_t>;
+        std::vector<Ranked, typename std::allocator_traits<Allocator>::template rebind_alloc<Ranked>> ranked(
+            records.get_allocator());
+        ranked.reserve(records.size());
+        for (std::size_t i = 0; i < records.size(); ++i) {
+            ranked.emplace_back(Rank<C>(records[i]), std::uint32_t(i));
+        }
+        ParallelSort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        std::vector<Record, Allocator> sorted(records.get_allocator());
+        sorted.reserve(records.size());
+        for (const auto& entry : ranked) {
+            sorted.push_back(std::move(records[entry.second]));
+        }
+        for (std::size_t begin = 0; begin < ranked.size();) {
+            std::size_t end = begin + 1;
+            while (end < ranked.size() && !(ranked[begin].first < ranked[end].first)) ++end;
+            if (end - begin > 1) {
+                std::sort(sorted.begin() + std::ptrdiff_t(begin), sorted.begin() + std::ptrdiff_t(end), Less<C>{});
+            }
+            begin = end;
+        }
+        records.swap(sorted);
+    }
+
+    struct SortState {
+        Column column = Column::Title;
+        bool ascending = true;
+        bool sorted = false; // false after the contents were replaced
+    };
+
+    // Brings records into the requested order. A direction flip on the same column is a reverse,
+    // and a list that is already in that order is left alone. Descending is ascending reversed, which the
+    // total orders make exact.
+    template <typename Record, typename Allocator>
+    void Sort(std::vector<Record, Allocator>& records, SortState& state, Column column, bool ascending) {
+        if (state.sorted && state.column == column) {
+            if (state.ascending != ascending) {
+                std::reverse(records.begin(), records.end());
+                state.ascending = ascending;
+            }
+            return;
+        }
+        if (column == Column::Title) RankedSort<Column::Title>(records);
+        else RankedSort<Column::Year>(records);
+        if (!ascending) std::reverse(records.begin(), records.end());
+        state = { column, ascending, true };
+    }
+
+    // Moves records[index] to its ordered position after its keys changed; returns the new index.
+    template <typename Record, typename Allocator>
+    std::size_t Reposition(std::vector<Record, Allocator>& records, const SortState& state, std::size_t index) {
+        if (!state.sorted) return index;
+        return Dispatch(state.column, state.ascending, [&](auto cmp) {
+            auto it = records.begin() + std::ptrdiff_t(index);
+            auto target = std::upper_bound(records.begin(), it, *it, cmp);
+            if (target != it) {
+                std::rotate(target, it, it + 1);
+                return std::size_t(target - records.begin());
+            }
+            target = std::lower_bound(it + 1, records.end(), *it, cmp);
+            std::rotate(it, it + 1, target);
+            return std::size_t(target - records.begin()) - 1;
+        });
+    }
+
+} // namespace movie_sort
+
+#endif //FINALPROJECT_MOVIE_SORT_H
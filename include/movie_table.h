@@ -0,0 +1,80 @@
+//
+// The movie tables (search results, watch list): a sortable Title and Year column with a frozen header,
+// drawn through an ImGuiListClipper so only the rows in view are submitted, however long the list.
+// Between Begin and ImGui::EndTable; the caller decides what a click or a hover on a row does.
+//
+
+#ifndef FINALPROJECT_MOVIE_TABLE_H
+#define FINALPROJECT_MOVIE_TABLE_H
+
+#pragma once
+
+#include <imgui.h>
+
+#include <movie_record.h>
+
+namespace movie_table {
+
+    constexpr ImGuiTableFlags kFlags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Sortable |
+                                       ImGuiTableFlags_Resizable | ImGuiTableFlags_SizingStretchProp |
+                                       ImGuiTableFlags_ScrollY;
+
+    // BeginTable plus the columns and the header row; call ImGui::EndTable only when this returned true.
+    inline bool Begin(const char* id) {
+        if (!ImGui::BeginTable(id, 2, kFlags)) return false;
+        ImGui::TableSetupScrollFreeze(0, 1); // Keep the header visible
+        ImGui::TableSetupColumn("Title", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_WidthStretch, 0.7f);
+        ImGui::TableSetupColumn("Year", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_WidthStretch, 0.3f);
+        ImGui::TableHeadersRow();
+        return true;
+    }
+
+    // True once after a header click (and on the first frame), with the order that was asked for.
+    inline bool SortRequested(bool& by_year, bool& ascending) {
+        ImGuiTableSortSpecs* specs = ImGui::TableGetSortSpecs();
+        if (!specs->SpecsDirty) return false;
+        by_year = specs->Specs->ColumnIndex != 0;
+        ascending = specs->Specs->SortDirection == ImGuiSortDirection_Ascending;
+        specs->SpecsDirty = false;
+        return true;
+    }
+
+    struct VisibleRows {
+        int first = 0;
+        int last = 0; // one past
+    };
+
+    // Submits the rows of [0, count) that are in view. row(i) is the record shown in row i (title, year_start,
+    // year_end); id(i) the ImGui ID pushed around its Selectable, so the title is the label as-is, without a
+    // "title##id" string per row. on_row(i, clicked) runs right after the Selectable, while ImGui can still be
+    // asked about the item. selected is the highlighted row, or -1.
+    template <typename Row, typename Id, typename OnRow>
+    VisibleRows DrawRows(int count, int selected, Row row, Id id, OnRow on_row) {
+        VisibleRows visible;
+        ImGuiListClipper clipper;
+        clipper.Begin(count);
+        while (clipper.Step()) {
+            // The widest step is the visible range; the first one only measures row 0
+            if (clipper.DisplayEnd - clipper.DisplayStart > visible.last - visible.first) {
+                visible = { clipper.DisplayStart, clipper.DisplayEnd };
+            }
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::PushID(id(i));
+                bool clicked = ImGui::Selectable(row(i).title.c_str(), selected == i, ImGuiSelectableFlags_SpanAllColumns);
+                ImGui::PopID();
+                on_row(i, clicked);
+                ImGui::TableSetColumnIndex(1);
+                const auto& record = row(i); // looked up again: on_row may have published a new record for the row
+                char year_text[16];
+                movie_record::FormatYear(record.year_start, record.year_end, year_text, sizeof(year_text));
+                ImGui::TextUnformatted(year_text);
+            }
+        }
+        return visible;
+    }
+
+} // namespace movie_table
+
+#endif //FINALPROJECT_MOVIE_TABLE_H
@@ -0,0 +1,256 @@
+//
+// Single-pass reader for OMDb responses, without building a DOM.
+// OMDb replies are a flat object of string fields, plus arrays: "Search" (one object per result) and
+// "Ratings". The reader walks the text once and hands each top-level scalar and each field of a "Search"
+// entry to a visitor as string_views; everything else is skipped without being decoded. Views point into
+// the response body unless the value had escapes, in which case they point into a scratch buffer that
+// is reused - copy what must outlive the call.
+//
+
+#ifndef FINALPROJECT_OMDB_JSON_H
+#define FINALPROJECT_OMDB_JSON_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace omdb_json {
+
+    // "Response" is "True" for a hit and "False" (with an "Error" field) otherwise.
+    enum class Reply { True, False, Malformed };
+
+    class Reader {
+    public:
+        explicit Reader(std::string_view text) : text(text) {}
+
+        // Visitor needs Field(key, value) for top-level scalars, and BeginItem(), ItemField(key, value) and
+        // EndItem() for the entries of a "Search" array. On Malformed the visitor may have seen part of the
+        // response (even an item without its EndItem).
+        template <typename Visitor>
+        Reply Visit(Visitor& visitor) {
+            bool response = false;
+            bool ok = ReadObject([&](std::string_view key) {
+                if (key == "Search" && Peek() == '[') return ReadItems(visitor);
+                std::string_view value;
+                bool scalar = false;
+                if (!ReadValue(value, scalar)) return false;
+                if (!scalar) return true;
+                if (key == "Response") response = value == "True";
+                visitor.Field(key, value);
+                return true;
+            });
+            SkipSpace();
+            if (!ok || pos != text.size()) return Reply::Malformed;
+            return response ? Reply::True : Reply::False;
+        }
+
+    private:
+        char Peek() {
+            SkipSpace();
+            return pos < text.size() ? text[pos] : '\0';
+        }
+
+        void SkipSpace() {
+            while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\n' || text[pos] == '\r' || text[pos] == '\t')) {
+                ++pos;
+            }
+        }
+
+        bool Consume(char c) {
+            if (Peek() != c) return false;
+            ++pos;
+            return true;
+        }
+
+        // on_member(key) reads the member's value itself.
+        template <typename F>
+        bool ReadObject(F on_member) {
+            if (!Consume('{')) return false;
+            if (Consume('}')) return true;
+            while (true) {
+                std::string_view key;
+                if (Peek() != '"' || !ReadString(key, key_scratch) || !Consume(':')) return false;
+                if (!on_member(key)) return false;
+                if (Consume(',')) continue;
+                return Consume('}');
+            }
+        }
+
+        template <typename Visitor>
+        bool ReadItems(Visitor& visitor) {
+            if (!Consume('[')) return false;
+            if (Consume(']')) return true;
+            while (true) {
+                if (Peek() == '{') {
+                    visitor.BeginItem();
+                    bool ok = ReadObject([&](std::string_view key) {
+                        std::string_view value;
+                        bool scalar = false;
+                        if (!ReadValue(value, scalar)) return false;
+                        if (scalar) visitor.ItemField(key, value);
+                        return true;
+                    });
+                    if (!ok) return false;
+                    visitor.EndItem();
+                }
+                else if (!SkipValue()) {
+                    return false;
+                }
+                if (Consume(',')) continue;
+                return Consume(']');
+            }
+        }
+
+        // Strings and literals come back in value with scalar set; objects, arrays and null are skipped.
+        bool ReadValue(std::string_view& value, bool& scalar) {
+            char c = Peek();
+            if (c == '"') {
+                scalar = true;
+                return ReadString(value, value_scratch);
+            }
+            if (c == '{' || c == '[') {
+                scalar = false;
+                return SkipValue();
+            }
+            std::size_t start = pos;
+            while (pos < text.size() && text[pos] != ',' && text[pos] != '}' && text[pos] != ']' &&
+                   text[pos] != ' ' && text[pos] != '\n' && text[pos] != '\r' && text[pos] != '\t') {
+                ++pos;
+            }
+            value = text.substr(start, pos - start);
+            scalar = value != "null";
+            return !value.empty();
+        }
+
+        bool SkipValue() {
+            int depth = 0;
+            do {
+                SkipSpace();
+                if (pos >= text.size()) return false;
+                char c = text[pos];
+                if (c == '"') {
+                    std::string_view ignored;
+                    if (!ReadString(ignored, value_scratch)) return false;
+                }
+                else if (c == '{' || c == '[') {
+                    ++depth;
+                    ++pos;
+                }
+                else if (c == '}' || c == ']') {
+                    if (depth == 0) return false;
+                    --depth;
+                    ++pos;
+                }
+                else {
+                    ++pos; // separators and literal characters
+                }
+            } while (depth > 0);
+            return true;
+        }
+
+        // Expects pos at the opening quote. Without escapes the view points into text.
+        bool ReadString(std::string_view& out, std::string& scratch) {
+            std::size_t start = ++pos;
+            while (pos < text.size() && text[pos] != '"' && text[pos] != '\\') {
+                if (static_cast<unsigned char>(text[pos]) < 0x20) return false;
+                ++pos;
+            }
+            if (pos >= text.size()) return false;
+            if (text[pos] == '"') {
+                out = text.substr(start, pos - start);
+                ++pos;
+                return true;
+            }
+
+            scratch.assign(text.data() + start, pos - start);
+            while (pos < text.size()) {
+                char c = text[pos++];
+                if (c == '"') {
+                    out = scratch;
+                    return true;
+                }
+                if (static_cast<unsigned char>(c) < 0x20) return false;
+                if (c != '\\') {
+                    scratch += c;
+                    continue;
+                }
+                if (pos >= text.size()) return false;
+                switch (text[pos++]) {
+                    case '"': scratch += '"'; break;
+                    case '\\': scratch += '\\'; break;
+                    case '/': scratch += '/'; break;
+                    case 'b': scratch += '\b'; break;
+                    case 'f': scratch += '\f'; break;
+                    case 'n': scratch += '\n'; break;
+                    case 'r': scratch += '\r'; break;
+                    case 't': scratch += '\t'; break;
+                    case 'u': {
+                        std::uint32_t code = 0;
+                        if (!ReadHex4(code)) return false;
+                        if (code >= 0xD800 && code < 0xDC00) {
+                            // High surrogate; the low half must follow
+                            std::uint32_t low = 0;
+                            if (text.substr(pos, 2) != "\\u") return false;
+                            pos += 2;
+                            if (!ReadHex4(low) || low < 0xDC00 || low >= 0xE000) return false;
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        }
+                        else if (code >= 0xDC00 && code < 0xE000) {
+                            return false;
+                        }
+                        AppendUtf8(scratch, code);
+                        break;
+                    }
+                    default:
+                        return false;
+                }
+            }
+            return false;
+        }
+
+        bool ReadHex4(std::uint32_t& code) {
+            if (text.size() - pos < 4) return false;
+            for (int i = 0; i < 4; ++i) {
+                char c = text[pos++];
+                code <<= 4;
+                if (c >= '0' && c <= '9') code |= std::uint32_t(c - '0');
+                else if (c >= 'a' && c <= 'f') code |= std::uint32_t(c - 'a' + 10);
+                else if (c >= 'A' && c <= 'F') code |= std::uint32_t(c - 'A' + 10);
+                else return false;
+            }
+            return true;
+        }
+
+        static void AppendUtf8(std::string& out, std::uint32_t code) {
+            if (code < 0x80) {
+                out += char(code);
+            }
+            else if (code < 0x800) {
+                out += char(0xC0 | (code >> 6));
+                out += char(0x80 | (code & 0x3F));
+            }
+            else if (code < 0x10000) {
+                out += char(0xE0 | (code >> 12));
+                out += char(0x80 | ((code >> 6) & 0x3F));
+                out += char(0x80 | (code & 0x3F));
+            }
+            else {
+                out += char(0xF0 | (code >> 18));
+                out += char(0x80 | ((code >> 12) & 0x3F));
+                out += char(0x80 | ((code >> 6) & 0x3F));
+                out += char(0x80 | (code & 0x3F));
+            }
+        }
+
+        std::string_view text;
+        std::size_t pos = 0;
+        std::string key_scratch;
+        std::string value_scratch;
+    };
+
+} // namespace omdb_json
+
+#endif //FINALPROJECT_OMDB_JSON_H
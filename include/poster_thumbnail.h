@@ -0,0 +1,145 @@
+//
+// Scaled-down copies of poster images, for clients that only show a thumbnail.
+// The poster is decoded with stb_image (the program defines STB_IMAGE_IMPLEMENTATION once), shrunk by
+// area averaging - every output pixel is the mean of the source pixels it covers - and written as a PNG
+// deflated by zlib. Images are never enlarged.
+//
+
+#ifndef FINALPROJECT_POSTER_THUMBNAIL_H
+#define FINALPROJECT_POSTER_THUMBNAIL_H
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <zlib.h>
+
+#include <stb_image.h>
+
+namespace poster_thumbnail {
+
+    constexpr int kMinWidth = 16;
+    constexpr int kMaxWidth = 1000;
+
+    namespace detail {
+
+        inline void AppendBigEndian(std::string& out, std::uint32_t value) {
+            out += char(value >> 24);
+            out += char(value >> 16);
+            out += char(value >> 8);
+            out += char(value);
+        }
+
+        inline void AppendChunk(std::string& png, const char* type, const std::string& data) {
+            AppendBigEndian(png, std::uint32_t(data.size()));
+            std::size_t start = png.size();
+            png.append(type, 4);
+            png += data;
+            uLong crc = crc32(0L, reinterpret_cast<const Bytef*>(png.data() + start), uInt(png.size() - start));
+            AppendBigEndian(png, std::uint32_t(crc));
+        }
+
+        inline std::uint8_t Paeth(int left, int up, int up_left) {
+            int p = left + up - up_left;
+            int pa = std::abs(p - left);
+            int pb = std::abs(p - up);
+            int pc = std::abs(p - up_left);
+            if (pa <= pb && pa <= pc) return std::uint8_t(left);
+            return std::uint8_t(pb <= pc ? up : up_left);
+        }
+
+        // 8-bit RGB (channels 3) or RGBA (channels 4), every row Paeth-filtered. Empty when zlib fails.
+        inline std::string EncodePng(const std::vector<std::uint8_t>& pixels, int width, int height, int channels) {
+            std::size_t stride = std::size_t(width) * channels;
+            std::vector<std::uint8_t> filtered;
+            filtered.reserve((stride + 1) * height);
+            for (int y = 0; y < height; ++y) {
+                const std::uint8_t* row = pixels.data() + y * stride;
+                const std::uint8_t* above = y > 0 ? row - stride : nullptr;
+                filtered.push_back(4); // Paeth
+                for (std::size_t i = 0; i < stride; ++i) {
+                    int left = i >= std::size_t(channels) ? row[i - channels] : 0;
+                    int up = above ? above[i] : 0;
+                    int up_left = above && i >= std::size_t(channels) ? above[i - channels] : 0;
+                    filtered.push_back(std::uint8_t(row[i] - Paeth(left, up, up_left)));
+                }
+            }
+
+            uLongf deflated_size = compressBound(uLong(filtered.size()));
+            std::string deflated(deflated_size, '\0');
+            if (compress2(reinterpret_cast<Bytef*>(deflated.data()), &deflated_size, filtered.data(),
+                          uLong(filtered.size()), Z_BEST_COMPRESSION) != Z_OK) {
+                return {};
+            }
+            deflated.resize(deflated_size);
+
+            std::string header;
+            AppendBigEndian(header, std::uint32_t(width));
+            AppendBigEndian(header, std::uint32_t(height));
+            header += char(8);                      // bit depth
+            header += char(channels == 4 ? 6 : 2);  // RGBA or RGB
+            header += std::string(3, '\0');         // deflate, adaptive filtering, no interlace
+
+            std::string png("\x89PNG\r\n\x1a\n", 8);
+            AppendChunk(png, "IHDR", header);
+            AppendChunk(png, "IDAT", deflated);
+            AppendChunk(png, "IEND", {});
+            return png;
+        }
+
+    } // namespace detail
+
+    // PNG bytes of image (any format stb_image reads) scaled to width, or an empty string when image
+    // cannot be decoded. width is clamped to [kMinWidth, kMaxWidth] and to the image's own width.
+    inline std::string Make(std::string_view image, int width) {
+        const auto* bytes = reinterpret_cast<const stbi_uc*>(image.data());
+        int source_width = 0;
+        int source_height = 0;
+        int source_channels = 0;
+        if (!stbi_info_from_memory(bytes, int(image.size()), &source_width, &source_height, &source_channels)) {
+            return {};
+        }
+        int channels = source_channels == 2 || source_channels == 4 ? 4 : 3;
+        stbi_uc* source = stbi_load_from_memory(bytes, int(image.size()), &source_width, &source_height,
+                                                &source_channels, channels);
+        if (source == nullptr) {
+            return {};
+        }
+
+        width = std::clamp(width, kMinWidth, kMaxWidth);
+        width = std::min(width, source_width);
+        int height = std::max(1, int(std::int64_t(source_height) * width / source_width));
+
+        std::vector<std::uint8_t> pixels(std::size_t(width) * height * channels);
+        std::vector<std::uint32_t> sums(channels);
+        for (int y = 0; y < height; ++y) {
+            int y0 = int(std::int64_t(y) * source_height / height);
+            int y1 = std::max(y0 + 1, int(std::int64_t(y + 1) * source_height / height));
+            for (int x = 0; x < width; ++x) {
+                int x0 = int(std::int64_t(x) * source_width / width);
+                int x1 = std::max(x0 + 1, int(std::int64_t(x + 1) * source_width / width));
+                std::fill(sums.begin(), sums.end(), 0);
+                for (int sy = y0; sy < y1; ++sy) {
+                    const stbi_uc* pixel = source + (std::size_t(sy) * source_width + x0) * channels;
+                    for (int sx = x0; sx < x1; ++sx) {
+                        for (int c = 0; c < channels; ++c) sums[c] += *pixel++;
+                    }
+                }
+                std::uint32_t count = std::uint32_t(y1 - y0) * std::uint32_t(x1 - x0);
+                std::uint8_t* out = pixels.data() + (std::size_t(y) * width + x) * channels;
+                for (int c = 0; c < channels; ++c) out[c] = std::uint8_t((sums[c] + count / 2) / count);
+            }
+        }
+        stbi_image_free(source);
+
+        return detail::EncodePng(pixels, width, height, channels);
+    }
+
+} // namespace poster_thumbnail
+
+#endif //FINALPROJECT_POSTER_THUMBNAIL_H
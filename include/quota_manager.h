@@ -0,0 +1,318 @@
+//
+// Daily request quota for one or more OMDb API keys.
+// Each key has a daily limit and a token bucket that refills at that limit spread over the day, so
+// background work keeps a steady pace instead of spending the quota by noon. Requests are admitted by
+// priority: interactive ones always go through while a key has quota left (they may overdraw the bucket),
+// background ones wait for tokens and stop at a ceiling that keeps the rest of the day for interactive
+// use, and speculative ones are shed first. Counts per key are persisted per UTC day.
+//
+
+#ifndef FINALPROJECT_QUOTA_MANAGER_H
+#define FINALPROJECT_QUOTA_MANAGER_H
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+class QuotaManager {
+public:
+    enum class Priority { Interactive, Background, Speculative };
+    enum class Admission { Admitted, Wait, Rejected };
+
+    static constexpr int kDefaultDailyLimit = 1000; // OMDb's free keys
+
+    struct KeyConfig {
+        std::string key;
+        int daily_limit = kDefaultDailyLimit;
+    };
+
+    struct Policy {
+        double background_ceiling = 0.8; // background requests stop once this share of the day's quota is used
+        double speculative_share = 0.1;  // speculative requests may use at most this share of it
+        double burst_share = 0.05;       // bucket capacity, as a share of a key's daily limit
+    };
+
+    struct Totals {
+        int keys = 0;
+        int exhausted_keys = 0;
+        int used = 0;
+        int limit = 0;
+        int speculative_used = 0;
+    };
+
+    // api_key.txt: one key per line, optionally followed by its daily limit ("abcd1234 100000" for a
+    // paid key). Blank lines and lines starting with '#' are skipped.
+    static std::vector<KeyConfig> ParseKeyFile(std::string_view text) {
+        std::vector<KeyConfig> keys;
+        std::istringstream lines{ std::string(text) };
+        std::string line;
+        while (std::getline(lines, line)) {
+            std::istringstream fields(line);
+            KeyConfig config;
+            if (!(fields >> config.key) || config.key.front() == '#') continue;
+            int limit = 0;
+            if (fields >> limit && limit > 0) config.daily_limit = limit;
+            keys.push_back(std::move(config));
+        }
+        return keys;
+    }
+
+    // Replaces the keys and reloads today's counts from state_file (if it has any for these keys).
+    void Configure(std::vector<KeyConfig> configs, Policy new_policy, std::filesystem::path new_state_file) {
+        std::lock_guard<std::mutex> lock(mutex);
+        policy = new_policy;
+        state_file = std::move(new_state_file);
+        day = CurrentDay();
+        keys.clear();
+        speculative_used = 0;
+        auto now = std::chrono::steady_clock::now();
+        for (KeyConfig& config : configs) {
+            Key key;
+            key.config = std::move(config);
+            key.fingerprint = Fingerprint(key.config.key);
+            key.capacity = std::max(1.0, policy.burst_share * key.config.daily_limit);
+            key.tokens = key.capacity;
+            key.refill_per_second = double(key.config.daily_limit) / 86400.0;
+            key.refilled_at = now;
+            keys.push_back(std::move(key));
+        }
+        LoadState();
+    }
+
+    bool Empty() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return keys.empty();
+    }
+
+    // Admits one request and returns the key to use in key_out. Wait means a key has quota left but its
+    // bucket is empty - try again shortly; Rejected means this priority gets nothing more today.
+    Admission Acquire(Priority priority, std::string& key_out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Key* chosen = nullptr;
+        Admission admission = Admit(priority, chosen);
+        if (admission != Admission::Admitted) return admission;
+
+        chosen->tokens = std::max(chosen->tokens - 1.0, -chosen->capacity); // interactive requests overdraw
+        ++chosen->used;
+        if (priority == Priority::Speculative) ++speculative_used;
+        key_out = chosen->config.key;
+        SaveThrottled();
+        return Admission::Admitted;
+    }
+
+    // What Acquire would answer, without spending anything.
+    Admission Check(Priority priority) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Key* chosen = nullptr;
+        return Admit(priority, chosen);
+    }
+
+    // The service reported the key's limit as reached (or rejected the key); skip it for the rest of the day.
+    void ReportExhausted(const std::string& key_value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (Key& key : keys) {
+            if (key.config.key == key_value) {
+                key.exhausted = true;
+                key.used = std::max(key.used, key.config.daily_limit);
+            }
+        }
+        dirty = true;
+        SaveThrottled();
+    }
+
+    Totals GetTotals() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        Totals totals;
+        totals.keys = int(keys.size());
+        totals.speculative_used = speculative_used;
+        for (const Key& key : keys) {
+            totals.used += key.used;
+            totals.limit += key.config.daily_limit;
+            if (key.exhausted || key.used >= key.config.daily_limit) ++totals.exhausted_keys;
+        }
+        return totals;
+    }
+
+    // fn(label, used, limit, tokens, exhausted) per key; label is the key's last four characters.
+    template <typename F>
+    void ForEachKey(F fn) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const Key& key : keys) {
+            const std::string& value = key.config.key;
+            const char* label = value.c_str() + (value.size() > 4 ? value.size() - 4 : 0);
+            fn(label, key.used, key.config.daily_limit, key.tokens,
+               key.exhausted || key.used >= key.config.daily_limit);
+        }
+    }
+
+    void Save() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (dirty) SaveState();
+    }
+
+private:
+    struct Key {
+        KeyConfig config;
+        std::string fingerprint; // what the state file stores instead of the key itself
+        int used = 0;
+        bool exhausted = false;
+        double tokens = 0.0;
+        double capacity = 1.0;
+        double refill_per_second = 0.0;
+        std::chrono::steady_clock::time_point refilled_at;
+    };
+
+    Admission Admit(Priority priority, Key*& chosen) {
+        RollOverDay();
+        Refill();
+
+        int used = 0;
+        int limit = 0;
+        for (const Key& key : keys) {
+            used += key.used;
+            limit += key.config.daily_limit;
+        }
+        if (priority != Priority::Interactive && used >= policy.background_ceiling * limit) {
+            return Admission::Rejected;
+        }
+        if (priority == Priority::Speculative && speculative_used >= policy.speculative_share * limit) {
+            return Admission::Rejected;
+        }
+
+        // Least used first (by share of its own limit), so keys with different limits run out together
+        bool any_left = false;
+        for (Key& key : keys) {
+            if (key.exhausted || key.used >= key.config.daily_limit) continue;
+            any_left = true;
+            if (priority != Priority::Interactive && key.tokens < 1.0) continue;
+            if (chosen == nullptr ||
+                double(key.used) / key.config.daily_limit < double(chosen->used) / chosen->config.daily_limit) {
+                chosen = &key;
+            }
+        }
+        if (chosen == nullptr) {
+            return any_left ? Admission::Wait : Admission::Rejected;
+        }
+        return Admission::Admitted;
+    }
+
+    static std::string CurrentDay() {
+        std::time_t now = std::time(nullptr);
+        std::tm utc{};
+        gmtime_r(&now, &utc);
+        char text[16];
+        std::strftime(text, sizeof(text), "%Y-%m-%d", &utc);
+        return text;
+    }
+
+    // FNV-1a, hex
+    static std::string Fingerprint(std::string_view key) {
+        std::uint64_t hash = 1469598103934665603ull;
+        for (unsigned char c : key) {
+            hash = (hash ^ c) * 1099511628211ull;
+        }
+        char text[17];
+        std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(hash));
+        return text;
+    }
+
+    void RollOverDay() {
+        std::string today = CurrentDay();
+        if (today == day) return;
+        day = std::move(today);
+        speculative_used = 0;
+        for (Key& key : keys) {
+            key.used = 0;
+            key.exhausted = false;
+        }
+        dirty = true;
+    }
+
+    void Refill() {
+        auto now = std::chrono::steady_clock::now();
+        for (Key& key : keys) {
+            double elapsed = std::chrono::duration<double>(now - key.refilled_at).count();
+            key.tokens = std::min(key.capacity, key.tokens + elapsed * key.refill_per_second);
+            key.refilled_at = now;
+        }
+    }
+
+    // State file lines: "day|fingerprint|used|exhausted", plus "day|*|speculative|count".
+    void LoadState() {
+        std::ifstream file(state_file);
+        std::string line;
+        while (std::getline(file, line)) {
+            std::vector<std::string_view> fields;
+            std::string_view rest(line);
+            for (std::size_t bar = rest.find('|'); bar != std::string_view::npos; bar = rest.find('|')) {
+                fields.push_back(rest.substr(0, bar));
+                rest.remove_prefix(bar + 1);
+            }
+            fields.push_back(rest);
+            if (fields.size() != 4 || fields[0] != day) continue;
+
+            int value = std::atoi(std::string(fields[2]).c_str());
+            if (fields[1] == "*") {
+                speculative_used = std::atoi(std::string(fields[3]).c_str());
+                continue;
+            }
+            for (Key& key : keys) {
+                if (key.fingerprint == fields[1]) {
+                    key.used = value;
+                    key.exhausted = fields[3] == "1";
+                }
+            }
+        }
+    }
+
+    void SaveThrottled() {
+        dirty = true;
+        auto now = std::chrono::steady_clock::now();
+        if (now - saved_at >= std::chrono::seconds(2)) {
+            SaveState();
+            saved_at = now;
+        }
+    }
+
+    // Written to a temporary file and renamed over the old one, so a crash never leaves half a file.
+    void SaveState() {
+        if (state_file.empty()) return;
+        std::filesystem::path temp = state_file;
+        temp += ".tmp";
+        {
+            std::ofstream file(temp, std::ios::trunc);
+            if (!file) return;
+            for (const Key& key : keys) {
+                file << day << '|' << key.fingerprint << '|' << key.used << '|' << (key.exhausted ? 1 : 0) << '\n';
+            }
+            file << day << "|*|speculative|" << speculative_used << '\n';
+            if (!file) return;
+        }
+        std::error_code error;
+        std::filesystem::rename(temp, state_file, error);
+        if (!error) dirty = false;
+    }
+
+    mutable std::mutex mutex;
+    std::vector<Key> keys;
+    Policy policy;
+    std::filesystem::path state_file;
+    std::string day;
+    int speculative_used = 0;
+    bool dirty = false;
+    std::chrono::steady_clock::time_point saved_at;
+};
+
+#endif //FINALPROJECT_QUOTA_MANAGER_H
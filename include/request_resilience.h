@@ -0,0 +1,391 @@
+//
+// Tail-latency and failure handling for idempotent requests.
+// Latency is tracked per endpoint; when an attempt outlives the endpoint's observed p95 a duplicate
+// (hedge) is started and whichever finishes first wins, the other is aborted. Failed attempts are retried
+// with jittered exponential backoff. Hedges and retries both draw from a budget that only grows with
+// ordinary traffic, so an outage cannot turn into a retry storm.
+// Transport-agnostic and thread-free: attempts are callables that start a request, register how to abort
+// it with the AttemptControl they are given and report the response through a callback. Hedge delays and
+// backoff wait on the caller's timers (event_http::Client::After), not on threads of their own. Cancelling
+// the request's token ends a backoff at once and aborts the attempts in flight.
+//
+
+#ifndef FINALPROJECT_REQUEST_RESILIENCE_H
+#define FINALPROJECT_REQUEST_RESILIENCE_H
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+
+#include <task.h>
+
+// Passed to each attempt. An attempt installs an abort callback (e.g. cancelling its request) once it has
+// started; the caller fires it when a hedge wins or the request is given up.
+class AttemptControl {
+public:
+    // Runs abort_fn at once when the attempt was already aborted, so an attempt that lost the race before
+    // it got going stops right away.
+    void set_abort(std::function<void()> abort_fn) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!is_aborted) {
+                this->abort_fn = std::move(abort_fn);
+                return;
+            }
+        }
+        abort_fn();
+    }
+
+    void abort() {
+        std::function<void()> fn;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (is_aborted) return;
+            is_aborted = true;
+            fn = std::move(abort_fn);
+        }
+        if (fn) fn();
+    }
+
+    bool aborted() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return is_aborted;
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::function<void()> abort_fn;
+    bool is_aborted = false;
+};
+
+// Recent latencies of one endpoint in a fixed ring.
+class LatencyWindow {
+public:
+    static constexpr int kSamples = 128;
+
+    void Record(std::chrono::milliseconds latency) {
+        samples[next] = latency;
+        next = (next + 1) % kSamples;
+        count = std::min(count + 1, kSamples);
+    }
+
+    int Count() const { return count; }
+
+    std::chrono::milliseconds Percentile(double p) const {
+        if (count == 0) return std::chrono::milliseconds(0);
+        std::array<std::chrono::milliseconds, kSamples> sorted;
+        std::copy_n(samples.begin(), count, sorted.begin());
+        int index = std::min(count - 1, int(p * count));
+        std::nth_element(sorted.begin(), sorted.begin() + index, sorted.begin() + count);
+        return sorted[index];
+    }
+
+private:
+    std::array<std::chrono::milliseconds, kSamples> samples{};
+    int next = 0;
+    int count = 0;
+};
+
+class RequestResilience {
+public:
+    struct Options {
+        int max_attempts = 3;                              // first try included
+        std::chrono::milliseconds base_backoff{ 200 };
+        std::chrono::milliseconds max_backoff{ 4000 };
+        std::chrono::milliseconds min_hedge_delay{ 150 };
+        std::chrono::milliseconds max_hedge_delay{ 4000 }; // also used until an endpoint has kMinSamples
+        double budget_per_request = 0.1;                   // each request earns this many extra attempts
+        double budget_cap = 10.0;
+    };
+
+    static constexpr int kMinSamples = 16;
+
+    struct Stats {
+        int samples = 0;
+        std::chrono::milliseconds p50{ 0 };
+        std::chrono::milliseconds p95{ 0 };
+        std::chrono::milliseconds p99{ 0 };
+        unsigned long long requests = 0;
+        unsigned long long hedges = 0;
+        unsigned long long hedge_wins = 0;
+        unsigned long long retries = 0;
+        unsigned long long budget_denied = 0;
+    };
+
+    RequestResilience() = default;
+    explicit RequestResilience(Options options) : options(options) {}
+
+    // Runs attempt(AttemptControl&, finished), hedging and retrying while retryable(response) holds, and
+    // calls done(response) once with the response that settled it. An attempt starts its request and
+    // calls finished(Response) exactly once, from any thread; up to two attempts run at once. timers
+    // provides After(delay, fn) -> id and Cancel(id) and must outlive the request, as must this object.
+    // Nothing blocks: the call returns once the first attempt has started. Once token is cancelled no
+    // further attempt starts: a pending backoff is cancelled and done gets the last failed response (or a
+    // default Response) right away, and running attempts are aborted and settle the request as they finish.
+    template <typename Response, typename Timers, typename Attempt, typename Retryable>
+    void RunAsync(const std::string& endpoint, Timers& timers, const CancelToken& token, Attempt attempt,
+                  Retryable retryable, std::function<void(Response)> done) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            budget = std::min(options.budget_cap, budget + options.budget_per_request);
+            ++endpoints[endpoint].stats.requests;
+        }
+        auto flight = std::make_shared<Flight<Response>>();
+        flight->endpoint = endpoint;
+        flight->attempt = std::move(attempt);
+        flight->retryable = std::move(retryable);
+        flight->done = std::move(done);
+        // Weak, so the token's callback does not keep the flight alive after done
+        flight->on_cancel.emplace(token, [this, &timers, weak = std::weak_ptr<Flight<Response>>(flight)] {
+            if (std::shared_ptr<Flight<Response>> cancelled = weak.lock()) Cancel(timers, cancelled);
+        });
+        StartRound(timers, flight);
+    }
+
+    Stats GetStats(const std::string& endpoint) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = endpoints.find(endpoint);
+        return it == endpoints.end() ? Stats() : StatsOf(it->second);
+    }
+
+    // fn(endpoint, stats) for every endpoint seen so far, under the lock; keep fn short.
+    template <typename F>
+    void ForEachEndpoint(F fn) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& [name, entry] : endpoints) {
+            fn(name, StatsOf(entry));
+        }
+    }
+
+private:
+    struct Endpoint {
+        LatencyWindow latency;
+        Stats stats;
+    };
+
+    static Stats StatsOf(const Endpoint& entry) {
+        Stats stats = entry.stats;
+        stats.samples = entry.latency.Count();
+        stats.p50 = entry.latency.Percentile(0.50);
+        stats.p95 = entry.latency.Percentile(0.95);
+        stats.p99 = entry.latency.Percentile(0.99);
+        return stats;
+    }
+
+    // Full jitter: uniform in [0, min(max_backoff, base * 2^(attempt - 1))].
+    std::chrono::milliseconds Backoff(int attempt_number) {
+        long long ceiling = options.base_backoff.count() << std::min(attempt_number - 1, 16);
+        ceiling = std::min<long long>(ceiling, options.max_backoff.count());
+        std::lock_guard<std::mutex> lock(mutex);
+        return std::chrono::milliseconds(std::uniform_int_distribution<long long>(0, ceiling)(random));
+    }
+
+    bool Withdraw(const std::string& endpoint, bool hedge) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Stats& stats = endpoints[endpoint].stats;
+        if (budget < 1.0) {
+            ++stats.budget_denied;
+            return false;
+        }
+        budget -= 1.0;
+        ++(hedge ? stats.hedges : stats.retries);
+        return true;
+    }
+
+    std::chrono::milliseconds HedgeDelay(const std::string& endpoint) {
+        std::lock_guard<std::mutex> lock(mutex);
+        const LatencyWindow& latency = endpoints[endpoint].latency;
+        if (latency.Count() < kMinSamples) return options.max_hedge_delay;
+        return std::clamp(latency.Percentile(0.95), options.min_hedge_delay, options.max_hedge_delay);
+    }
+
+    // State of one RunAsync call. A round is one logical attempt: the primary, plus a hedge if the primary
+    // is still running after the p95. Callbacks of an earlier round are recognised by its number and ignored.
+    template <typename Response>
+    struct Flight {
+        std::string endpoint;
+        std::function<void(AttemptControl&, std::function<void(Response)>)> attempt;
+        std::function<bool(const Response&)> retryable;
+        std::function<void(Response)> done;
+
+        std::mutex mutex; // taken before RequestResilience::mutex, never after
+        int round = 0;
+        bool settled = false; // the round has its answer; later responses of it are dropped
+        int running = 0;
+        std::array<std::shared_ptr<AttemptControl>, 2> controls;
+        std::optional<Response> last; // most recent retryable response
+        std::uint64_t hedge_timer = 0;
+        bool cancelled = false;
+        bool backing_off = false; // between rounds; whoever clears it - the timer or Cancel - carries on
+        std::uint64_t backoff_timer = 0;
+        std::optional<CancelToken::Callback> on_cancel; // last member: unregistered before the rest goes
+    };
+
+    template <typename Response, typename Timers>
+    void StartRound(Timers& timers, const std::shared_ptr<Flight<Response>>& flight) {
+        int round;
+        {
+            std::unique_lock<std::mutex> lock(flight->mutex);
+            if (flight->cancelled) {
+                lock.unlock();
+                flight->done(flight->last ? std::move(*flight->last) : Response());
+                return;
+            }
+            round = ++flight->round;
+            flight->settled = false;
+            flight->running = 1;
+            flight->controls = { std::make_shared<AttemptControl>(), nullptr };
+        }
+        std::uint64_t hedge_timer = timers.After(HedgeDelay(flight->endpoint), [this, &timers, flight, round] {
+            StartHedge(timers, flight, round);
+        });
+        {
+            std::lock_guard<std::mutex> lock(flight->mutex);
+            flight->hedge_timer = hedge_timer;
+        }
+        Launch(timers, flight, round, 0);
+    }
+
+    template <typename Response, typename Timers>
+    void StartHedge(Timers& timers, const std::shared_ptr<Flight<Response>>& flight, int round) {
+        {
+            std::lock_guard<std::mutex> lock(flight->mutex);
+            if (flight->round != round || flight->settled || flight->cancelled || !Withdraw(flight->endpoint, true)) {
+                return;
+            }
+            flight->controls[1] = std::make_shared<AttemptControl>();
+            ++flight->running;
+        }
+        Launch(timers, flight, round, 1);
+    }
+
+    template <typename Response, typename Timers>
+    void Launch(Timers& timers, const std::shared_ptr<Flight<Response>>& flight, int round, int index) {
+        std::shared_ptr<AttemptControl> control;
+        {
+            std::lock_guard<std::mutex> lock(flight->mutex);
+            control = flight->controls[index];
+        }
+        auto started = std::chrono::steady_clock::now();
+        flight->attempt(*control, [this, &timers, flight, round, index, started](Response response) {
+            Settle(timers, flight, round, index, started, std::move(response));
+        });
+    }
+
+    // The first non-retryable response of a round wins and aborts the other attempt; otherwise the round
+    // ends with the last attempt to finish, and is retried after a backoff while attempts and budget last.
+    template <typename Response, typename Timers>
+    void Settle(Timers& timers, const std::shared_ptr<Flight<Response>>& flight, int round, int index,
+                std::chrono::steady_clock::time_point started, Response response) {
+        bool good = !flight->retryable(response);
+        if (good) {
+            // Per attempt, so a winning hedge does not make the endpoint look faster than it is
+            auto latency = std::chrono::steady_clock::now() - started;
+            std::lock_guard<std::mutex> lock(mutex);
+            endpoints[flight->endpoint].latency.Record(std::chrono::duration_cast<std::chrono::milliseconds>(latency));
+        }
+
+        std::shared_ptr<AttemptControl> loser;
+        std::uint64_t hedge_timer;
+        bool cancelled;
+        {
+            std::lock_guard<std::mutex> lock(flight->mutex);
+            if (flight->round != round || flight->settled) return;
+            --flight->running;
+            if (good) {
+                loser = flight->controls[1 - index];
+                if (index == 1) {
+                    std::lock_guard<std::mutex> stats_lock(mutex);
+                    ++endpoints[flight->endpoint].stats.hedge_wins;
+                }
+            }
+            else {
+                flight->last = std::move(response);
+                if (flight->running > 0) return;
+            }
+            flight->settled = true;
+            hedge_timer = std::exchange(flight->hedge_timer, 0);
+            cancelled = flight->cancelled;
+            flight->backing_off = !good && !cancelled;
+        }
+        if (hedge_timer != 0) timers.Cancel(hedge_timer);
+        if (loser) loser->abort(); // the loser, if any, stops early
+
+        if (good) {
+            flight->done(std::move(response));
+            return;
+        }
+        if (cancelled) {
+            flight->done(std::move(*flight->last));
+            return;
+        }
+        if (round >= options.max_attempts || !Withdraw(flight->endpoint, false)) {
+            {
+                std::lock_guard<std::mutex> lock(flight->mutex);
+                if (!flight->backing_off) return; // cancelled in the meantime, and Cancel has answered
+                flight->backing_off = false;
+            }
+            flight->done(std::move(*flight->last));
+            return;
+        }
+        std::uint64_t backoff_timer = timers.After(Backoff(round), [this, &timers, flight] {
+            {
+                std::lock_guard<std::mutex> lock(flight->mutex);
+                if (!flight->backing_off) return; // cancelled, and Cancel has answered
+                flight->backing_off = false;
+                flight->backoff_timer = 0;
+            }
+            StartRound(timers, flight);
+        });
+        std::lock_guard<std::mutex> lock(flight->mutex);
+        if (flight->backing_off) flight->backoff_timer = backoff_timer;
+    }
+
+    // The token was cancelled. During a backoff the request ends here and now; otherwise the attempts in
+    // flight are aborted and the last of them to finish settles it, with no retry.
+    template <typename Response, typename Timers>
+    void Cancel(Timers& timers, const std::shared_ptr<Flight<Response>>& flight) {
+        std::array<std::shared_ptr<AttemptControl>, 2> controls;
+        std::uint64_t hedge_timer;
+        std::uint64_t backoff_timer = 0;
+        bool answer = false;
+        {
+            std::lock_guard<std::mutex> lock(flight->mutex);
+            flight->cancelled = true;
+            hedge_timer = std::exchange(flight->hedge_timer, 0);
+            if (flight->backing_off) {
+                flight->backing_off = false;
+                backoff_timer = std::exchange(flight->backoff_timer, 0);
+                answer = true;
+            }
+            else if (!flight->settled) {
+                controls = flight->controls;
+            }
+        }
+        if (hedge_timer != 0) timers.Cancel(hedge_timer);
+        if (backoff_timer != 0) timers.Cancel(backoff_timer);
+        for (const auto& control : controls) {
+            if (control) control->abort();
+        }
+        if (answer) flight->done(std::move(*flight->last));
+    }
+
+    Options options;
+    mutable std::mutex mutex;
+    std::map<std::string, Endpoint> endpoints;
+    double budget = 5.0;
+    std::mt19937_64 random{ std::random_device{}() };
+};
+
+#endif //FINALPROJECT_REQUEST_RESILIENCE_H
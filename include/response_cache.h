@@ -0,0 +1,158 @@
+//
+// On-disk cache of GET response bodies, keyed by canonical URL.
+// One file per entry, named by a hash of the key; the first line holds the key itself so a hash collision
+// reads as a miss. Total size is kept under a cap by evicting the least recently used files.
+//
+
+#ifndef FINALPROJECT_RESPONSE_CACHE_H
+#define FINALPROJECT_RESPONSE_CACHE_H
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+class ResponseCache {
+public:
+    // Indexes what dir already holds; the cache is disabled (every Get misses) until this is called.
+    void Open(const std::filesystem::path& new_dir, std::uintmax_t new_max_bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        dir = new_dir;
+        max_bytes = new_max_bytes;
+        entries.clear();
+        total_bytes = 0;
+        clock = 0;
+
+        std::error_code error;
+        std::filesystem::create_directories(dir, error);
+        std::vector<std::pair<std::filesystem::file_time_type, std::string>> found;
+        for (const auto& file : std::filesystem::directory_iterator(dir, error)) {
+            if (!file.is_regular_file(error)) continue;
+            std::string name = file.path().filename().string();
+            if (name.size() != 16) continue; // temporary files and strays
+            found.emplace_back(file.last_write_time(error), name);
+            std::uintmax_t size = file.file_size(error);
+            entries[name].size = size;
+            total_bytes += size;
+        }
+        // Older files start out less recently used
+        std::sort(found.begin(), found.end());
+        for (const auto& [time, name] : found) {
+            entries[name].last_used = ++clock;
+        }
+        Evict();
+    }
+
+    std::optional<std::string> Get(std::string_view key) {
+        std::string name = FileName(key);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = entries.find(name);
+            if (it == entries.end()) return std::nullopt;
+            it->second.last_used = ++clock;
+        }
+
+        std::ifstream file(dir / name, std::ios::binary);
+        std::string stored_key;
+        if (!std::getline(file, stored_key) || stored_key != key) return std::nullopt;
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    // Written to a temporary file and renamed into place, so readers never see a partial entry. Every write
+    // has a temporary file of its own, so concurrent Puts of one key - from other threads, or the app and
+    // movie_cli sharing the directory - each rename a whole file and the last one wins.
+    void Put(std::string_view key, std::string_view body) {
+        if (dir.empty() || key.find('\n') != std::string_view::npos) return;
+        std::string name = FileName(key);
+        std::filesystem::path temp = dir / (name + "." + std::to_string(instance) + "." +
+                                            std::to_string(++temp_counter) + ".tmp");
+        std::error_code error;
+        {
+            std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+            file << key << '\n';
+            file.write(body.data(), std::streamsize(body.size()));
+            if (!file) {
+                file.close();
+                std::filesystem::remove(temp, error);
+                return;
+            }
+        }
+        std::filesystem::rename(temp, dir / name, error);
+        if (error) {
+            std::filesystem::remove(temp, error);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        Entry& entry = entries[name];
+        total_bytes -= entry.size;
+        entry.size = key.size() + 1 + body.size();
+        entry.last_used = ++clock;
+        total_bytes += entry.size;
+        Evict();
+    }
+
+    std::uintmax_t SizeBytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return total_bytes;
+    }
+
+private:
+    struct Entry {
+        std::uintmax_t size = 0;
+        std::uint64_t last_used = 0;
+    };
+
+    // FNV-1a, hex
+    static std::string FileName(std::string_view key) {
+        std::uint64_t hash = 1469598103934665603ull;
+        for (unsigned char c : key) {
+            hash = (hash ^ c) * 1099511628211ull;
+        }
+        char text[17];
+        std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(hash));
+        return text;
+    }
+
+    void Evict() {
+        if (total_bytes <= max_bytes) return;
+        std::vector<std::pair<std::uint64_t, std::string>> by_age;
+        by_age.reserve(entries.size());
+        for (const auto& [name, entry] : entries) {
+            by_age.emplace_back(entry.last_used, name);
+        }
+        std::sort(by_age.begin(), by_age.end());
+        // Down to 90% of the cap, so a full cache does not evict on every Put
+        for (const auto& [last_used, name] : by_age) {
+            if (total_bytes <= max_bytes / 10 * 9) break;
+            std::error_code error;
+            std::filesystem::remove(dir / name, error);
+            total_bytes -= entries[name].size;
+            entries.erase(name);
+        }
+    }
+
+    mutable std::mutex mutex;
+    const std::uint64_t instance = std::random_device()(); // tells this process's temporary files from others'
+    std::atomic<std::uint64_t> temp_counter{ 0 };
+    std::filesystem::path dir;
+    std::uintmax_t max_bytes = 0;
+    std::uintmax_t total_bytes = 0;
+    std::uint64_t clock = 0;
+    std::unordered_map<std::string, Entry> entries;
+};
+
+#endif //FINALPROJECT_RESPONSE_CACHE_H
@@ -0,0 +1,72 @@
+//
+// Monotonic arena for what one search owns: the result list and the small per-search queues.
+// Nothing is freed individually; Reset drops the whole generation at once when the next search
+// supersedes it. The first block is kept across generations, so a typical search never touches the
+// general-purpose heap. Not thread-safe: use it from one thread (the UI thread).
+//
+
+#ifndef FINALPROJECT_SEARCH_ARENA_H
+#define FINALPROJECT_SEARCH_ARENA_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+
+class SearchArena final : public std::pmr::memory_resource {
+public:
+    static constexpr std::size_t kInitialBytes = 64 << 10;
+
+    SearchArena()
+        : initial(std::make_unique<std::byte[]>(kInitialBytes)),
+          arena(initial.get(), kInitialBytes, &upstream) {}
+
+    SearchArena(const SearchArena&) = delete;
+    SearchArena& operator=(const SearchArena&) = delete;
+
+    // Releases everything handed out since the last Reset. Containers using the arena must have given
+    // their memory back first (e.g. by being assigned a fresh, empty container).
+    void Reset() {
+        arena.release();
+        ++generation;
+        bytes_used = 0;
+    }
+
+    std::uint64_t Generation() const { return generation; }
+    std::size_t BytesUsed() const { return bytes_used; }            // this generation
+    std::uint64_t HeapBlocks() const { return upstream.blocks; }    // fetched beyond the initial block, ever
+
+private:
+    // Counts the blocks the arena has to take from the heap once the initial one is full.
+    struct Upstream final : std::pmr::memory_resource {
+        std::uint64_t blocks = 0;
+
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            ++blocks;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        bytes_used += bytes;
+        return arena.allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override {} // freed with the generation
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    std::unique_ptr<std::byte[]> initial;
+    Upstream upstream;
+    std::pmr::monotonic_buffer_resource arena;
+    std::uint64_t generation = 0;
+    std::size_t bytes_used = 0;
+};
+
+#endif //FINALPROJECT_SEARCH_ARENA_H
@@ -0,0 +1,225 @@
+//
+// Coalescing of duplicate in-flight requests.
+// The first caller for a key runs the request; callers arriving while it is in flight wait for that
+// result instead of issuing their own. A waiter whose token is cancelled stops waiting on its own
+// without affecting the other waiters; once every caller of an async request has been cancelled, the
+// request is told so through the token its start function is given. Do blocks the calling thread;
+// DoAsync hands the result to a callback instead, so any number of callers can wait without a thread each.
+//
+
+#ifndef FINALPROJECT_SINGLE_FLIGHT_H
+#define FINALPROJECT_SINGLE_FLIGHT_H
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <task.h>
+
+template <typename Value>
+class SingleFlight {
+public:
+    // Runs fn() for key, or joins the call already running for it. Returns nullopt only when token was
+    // cancelled while waiting on another caller's request; exceptions from fn reach every caller.
+    template <typename F>
+    std::optional<Value> Do(const std::string& key, const CancelToken& token, F fn) {
+        auto [call, leader] = Join(key);
+
+        if (leader) {
+            try {
+                call->value = fn();
+            }
+            catch (...) {
+                call->error = std::current_exception();
+            }
+            Finish(key, call);
+        }
+        else {
+            ++shared;
+            // Cancelling wakes this waiter at once; the callback takes the mutex so the wakeup cannot fall
+            // between checking the token and starting to wait
+            CancelToken::Callback wake(token, [&call] {
+                std::lock_guard<std::mutex> lock(call->mutex);
+                call->finished.notify_all();
+            });
+            std::unique_lock<std::mutex> lock(call->mutex);
+            call->finished.wait(lock, [&] { return call->done || token.cancelled(); });
+            if (!call->done) {
+                lock.unlock();
+                Leave(key, call);
+                return std::nullopt;
+            }
+        }
+
+        if (call->error) std::rethrow_exception(call->error);
+        return call->value;
+    }
+
+    // Async form of Do: when no call for key is in flight, start(abandoned, finish) starts the request,
+    // which calls finish(Value) once from any thread. done(optional<Value>) runs once, for the first caller
+    // too: with the value on the thread that finished the request, or with nullopt on the thread that
+    // cancelled token (right here when it already was). A cancelled caller leaves the request running for
+    // the others; when the last one leaves, abandoned is cancelled so the request can stop retrying, and
+    // callers arriving after that start a request of their own. Callers of Do that threw get nullopt too.
+    template <typename Start>
+    void DoAsync(const std::string& key, const CancelToken& token, Start start,
+                 std::function<void(std::optional<Value>)> done) {
+        auto [call, leader] = Join(key);
+        if (!leader) ++shared;
+
+        auto waiter = std::make_shared<Waiter>();
+        waiter->done = std::move(done);
+        {
+            std::unique_lock<std::mutex> lock(call->mutex);
+            if (call->done) {
+                lock.unlock();
+                waiter->done(call->error ? std::nullopt : call->value);
+                return;
+            }
+            call->waiters.push_back(waiter);
+        }
+        // Weak, so a token that is never cancelled does not keep the waiter or the call alive after it finished
+        waiter->on_cancel.emplace(token, [this, key, weak = std::weak_ptr<Waiter>(waiter),
+                                          weak_call = std::weak_ptr<Call>(call)] {
+            std::shared_ptr<Waiter> cancelled = weak.lock();
+            if (!cancelled || cancelled->claimed.exchange(true)) return;
+            if (std::shared_ptr<Call> left = weak_call.lock()) Leave(key, left);
+            cancelled->done(std::nullopt);
+        });
+        if (leader) {
+            start(call->abandoned, [this, key, call = call](Value value) {
+                call->value = std::move(value);
+                Finish(key, call);
+            });
+        }
+    }
+
+    std::size_t InFlight() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return calls.size();
+    }
+
+    // Callers that were served by someone else's request.
+    std::uint64_t Shared() const { return shared.load(); }
+
+private:
+    // A DoAsync caller. Whoever flips claimed first - the finishing request or the token - calls done.
+    struct Waiter {
+        std::atomic<bool> claimed{ false };
+        std::function<void(std::optional<Value>)> done;
+        std::optional<CancelToken::Callback> on_cancel;
+    };
+
+    struct Call {
+        std::mutex mutex;
+        std::condition_variable finished;
+        bool done = false;
+        std::optional<Value> value; // set once, before done
+        std::exception_ptr error;
+        std::vector<std::shared_ptr<Waiter>> waiters;
+        int callers = 0;        // joined and not cancelled; guarded by SingleFlight::mutex
+        CancelToken abandoned;  // cancelled when callers drops to zero before the call finished
+    };
+
+    // The call in flight for key, and whether this caller started it and has to run it
+    std::pair<std::shared_ptr<Call>, bool> Join(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto [it, inserted] = calls.try_emplace(key);
+        if (inserted) {
+            it->second = std::make_shared<Call>();
+        }
+        ++it->second->callers;
+        return { it->second, inserted };
+    }
+
+    // A caller was cancelled. The last one out takes the call off the map, so nobody joins a request that
+    // is being given up, and tells the request.
+    void Leave(const std::string& key, const std::shared_ptr<Call>& call) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--call->callers > 0) return;
+            Forget(key, call);
+        }
+        call->abandoned.cancel();
+    }
+
+    // Under mutex. Erases key only while it still maps to call: a newer call may have taken its place.
+    void Forget(const std::string& key, const std::shared_ptr<Call>& call) {
+        auto it = calls.find(key);
+        if (it != calls.end() && it->second == call) calls.erase(it);
+    }
+
+    void Finish(const std::string& key, const std::shared_ptr<Call>& call) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            Forget(key, call);
+        }
+        std::vector<std::shared_ptr<Waiter>> waiters;
+        {
+            std::lock_guard<std::mutex> lock(call->mutex);
+            call->done = true;
+            waiters.swap(call->waiters);
+        }
+        call->finished.notify_all();
+        for (const auto& waiter : waiters) {
+            if (!waiter->claimed.exchange(true)) waiter->done(call->error ? std::nullopt : call->value);
+        }
+    }
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<Call>> calls;
+    std::atomic<std::uint64_t> shared{ 0 };
+};
+
+// Key for a GET: scheme and host lowercased, default ports dropped and query parameters sorted,
+// so "HTTPS://Host:443/?b=2&a=1" and "https://host/?a=1&b=2" coalesce.
+inline std::string CanonicalUrl(std::string_view host, std::string_view path) {
+    std::string key;
+    key.reserve(host.size() + path.size());
+    for (char c : host) {
+        key += char(std::tolower(static_cast<unsigned char>(c)));
+    }
+    auto strip_suffix = [&key](std::string_view scheme, std::string_view port) {
+        if (key.compare(0, scheme.size(), scheme) == 0 && key.size() > port.size() &&
+            key.compare(key.size() - port.size(), port.size(), port) == 0) {
+            key.resize(key.size() - port.size());
+        }
+    };
+    strip_suffix("https://", ":443");
+    strip_suffix("http://", ":80");
+
+    std::size_t query_start = path.find('?');
+    key += path.substr(0, query_start);
+    if (query_start == std::string_view::npos) return key;
+
+    std::vector<std::string_view> params;
+    std::string_view query = path.substr(query_start + 1);
+    while (!query.empty()) {
+        std::size_t amp = query.find('&');
+        if (amp != 0) params.push_back(query.substr(0, amp));
+        query.remove_prefix(amp == std::string_view::npos ? query.size() : amp + 1);
+    }
+    std::sort(params.begin(), params.end());
+    char separator = '?';
+    for (std::string_view param : params) {
+        key += separator;
+        key += param;
+        separator = '&';
+    }
+    return key;
+}
+
+#endif //FINALPROJECT_SINGLE_FLIGHT_H
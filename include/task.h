@@ -0,0 +1,399 @@
+//
+// Coroutine task type and the executors used by the search -> details -> poster flows.
+//
+
+#ifndef FINALPROJECT_TASK_H
+#define FINALPROJECT_TASK_H
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Thrown from CancelToken::throw_if_cancelled() so a flow unwinds at its next checkpoint.
+struct TaskCancelled : std::exception {
+    const char* what() const noexcept override { return "task cancelled"; }
+};
+
+// Shared cancellation flag. Copies observe the same flag. Code that blocks registers a Callback to be woken
+// by cancel() instead of polling the flag.
+class CancelToken {
+private:
+    struct State {
+        std::atomic<bool> cancelled{ false };
+        std::mutex mutex;
+        std::condition_variable callback_done;
+        std::map<std::uint64_t, std::function<void()>> callbacks;
+        std::uint64_t next_id = 1;
+        std::uint64_t running_id = 0; // callback cancel() is running right now, outside the mutex
+        std::thread::id running_thread;
+    };
+    std::shared_ptr<State> state = std::make_shared<State>();
+
+public:
+    // Runs fn once when the token is cancelled: on the thread calling cancel(), or right away in the
+    // constructor when it already was. The destructor unregisters fn, waiting for it to return if another
+    // thread is running it, so fn may use whatever outlives the Callback.
+    class Callback {
+    public:
+        Callback(const CancelToken& token, std::function<void()> fn) : state(token.state) {
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->cancelled) {
+                    id = state->next_id++;
+                    state->callbacks.emplace(id, std::move(fn));
+                    return;
+                }
+            }
+            fn();
+        }
+
+        ~Callback() {
+            if (id == 0) return;
+            std::unique_lock<std::mutex> lock(state->mutex);
+            if (state->callbacks.erase(id) > 0) return;
+            state->callback_done.wait(lock, [this] {
+                return state->running_id != id || state->running_thread == std::this_thread::get_id();
+            });
+        }
+
+        Callback(const Callback&) = delete;
+        Callback& operator=(const Callback&) = delete;
+
+    private:
+        std::shared_ptr<State> state;
+        std::uint64_t id = 0;
+    };
+
+    void cancel() const {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        if (state->cancelled.exchange(true)) return;
+        while (!state->callbacks.empty()) {
+            auto first = state->callbacks.begin();
+            std::function<void()> fn = std::move(first->second);
+            state->running_id = first->first;
+            state->running_thread = std::this_thread::get_id();
+            state->callbacks.erase(first);
+            lock.unlock();
+            fn();
+            lock.lock();
+            state->running_id = 0;
+            state->callback_done.notify_all();
+        }
+    }
+
+    bool cancelled() const { return state->cancelled.load(); }
+    void throw_if_cancelled() const {
+        if (cancelled()) {
+            throw TaskCancelled();
+        }
+    }
+};
+
+template <typename T>
+class task;
+
+namespace task_detail {
+
+    struct promise_base {
+        std::coroutine_handle<> continuation;
+        std::exception_ptr exception;
+        bool detached = false;
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct final_awaiter {
+            bool await_ready() noexcept { return false; }
+
+            template <typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+                promise_base& promise = h.promise();
+                if (promise.continuation) {
+                    return promise.continuation;
+                }
+                if (promise.detached) {
+                    h.destroy();
+                }
+                return std::noop_coroutine();
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        final_awaiter final_suspend() noexcept { return {}; }
+        void unhandled_exception() { exception = std::current_exception(); }
+    };
+
+    template <typename T>
+    struct promise : promise_base {
+        std::optional<T> value;
+
+        task<T> get_return_object();
+        void return_value(T v) { value.emplace(std::move(v)); }
+
+        T take() {
+            if (exception) std::rethrow_exception(exception);
+            return std::move(*value);
+        }
+    };
+
+    template <>
+    struct promise<void> : promise_base {
+        task<void> get_return_object();
+        void return_void() {}
+
+        void take() {
+            if (exception) std::rethrow_exception(exception);
+        }
+    };
+
+} // namespace task_detail
+
+// Lazily started coroutine. Awaiting it starts it and resumes the awaiter when it completes
+// (symmetric transfer, so long chains do not grow the stack).
+template <typename T = void>
+class task {
+public:
+    using promise_type = task_detail::promise<T>;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    task() = default;
+    explicit task(handle_type h) : handle(h) {}
+    task(task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    task& operator=(task&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    task(const task&) = delete;
+    task& operator=(const task&) = delete;
+    ~task() {
+        if (handle) handle.destroy();
+    }
+
+    bool await_ready() const noexcept { return !handle || handle.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+
+    T await_resume() { return handle.promise().take(); }
+
+    // Starts the task without an awaiter; the frame frees itself when it finishes.
+    // Detached tasks are expected to handle their own exceptions.
+    void start_detached() {
+        handle_type h = std::exchange(handle, {});
+        h.promise().detached = true;
+        h.resume();
+    }
+
+private:
+    handle_type handle;
+};
+
+template <typename T>
+task<T> task_detail::promise<T>::get_return_object() {
+    return task<T>(std::coroutine_handle<promise<T>>::from_promise(*this));
+}
+
+inline task<void> task_detail::promise<void>::get_return_object() {
+    return task<void>(std::coroutine_handle<promise<void>>::from_promise(*this));
+}
+
+inline void spawn(task<void> t) {
+    t.start_detached();
+}
+
+// Counts work running on background threads so shutdown can wait for it before tearing down globals.
+class BackgroundJobs {
+public:
+    static void begin() {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        ++state().running;
+    }
+
+    static void end() {
+        std::lock_guard<std::mutex> lock(state().mutex);
+        if (--state().running == 0) {
+            state().idle.notify_all();
+        }
+    }
+
+    static bool wait_idle(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(state().mutex);
+        return state().idle.wait_for(lock, timeout, [] { return state().running == 0; });
+    }
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::condition_variable idle;
+        int running = 0;
+    };
+
+    static State& state() {
+        static State s;
+        return s;
+    }
+};
+
+// co_await RunInBackground(fn) runs fn on a worker thread and resumes the coroutine on that thread.
+// Follow it with co_await executor.schedule() to get back to the UI thread.
+template <typename F>
+class BackgroundAwaitable {
+public:
+    using result_type = std::invoke_result_t<F&>;
+    static_assert(!std::is_void_v<result_type>, "background work must return a value");
+
+    explicit BackgroundAwaitable(F f) : fn(std::move(f)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> h) {
+        BackgroundJobs::begin();
+        std::thread([this, h] {
+            try {
+                result.emplace(fn());
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+            h.resume();
+            BackgroundJobs::end();
+        }).detach();
+    }
+
+    result_type await_resume() {
+        if (error) std::rethrow_exception(error);
+        return std::move(*result);
+    }
+
+private:
+    F fn;
+    std::optional<result_type> result;
+    std::exception_ptr error;
+};
+
+template <typename F>
+BackgroundAwaitable<F> RunInBackground(F fn) {
+    return BackgroundAwaitable<F>(std::move(fn));
+}
+
+// co_await AwaitCompletion<T>(start) calls start(done) and suspends until done(T) is called, exactly once,
+// from any thread - typically the I/O thread finishing a request, or start itself when the answer is
+// immediate. The coroutine resumes on that thread, so as with RunInBackground, follow it with
+// co_await executor.schedule() before touching UI state. No thread waits in the meantime.
+template <typename T, typename Start>
+class CompletionAwaitable {
+public:
+    explicit CompletionAwaitable(Start s) : start(std::move(s)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> h) {
+        BackgroundJobs::begin();
+        start([this, h](T value) {
+            result.emplace(std::move(value));
+            // Whoever comes second resumes: done, or await_suspend when done ran inside start
+            if (arrived.exchange(true)) h.resume();
+            BackgroundJobs::end();
+        });
+        return !arrived.exchange(true);
+    }
+
+    T await_resume() { return std::move(*result); }
+
+private:
+    Start start;
+    std::optional<T> result;
+    std::atomic<bool> arrived{ false };
+};
+
+template <typename T, typename Start>
+CompletionAwaitable<T, Start> AwaitCompletion(Start start) {
+    return CompletionAwaitable<T, Start>(std::move(start));
+}
+
+// Blocking counterpart for plain threads (the CLI, import workers): calls start(done) and waits here
+// until done(T) has been called on any thread.
+template <typename T, typename Start>
+T WaitForCompletion(Start start) {
+    auto promise = std::make_shared<std::promise<T>>(); // shared: done may still be returning when the caller wakes
+    std::future<T> result = promise->get_future();
+    start([promise](T value) { promise->set_value(std::move(value)); });
+    return result.get();
+}
+
+// Resumes coroutines on whichever thread calls drain() - the main loop, so GL and ImGui state stay single-threaded.
+class UiExecutor {
+public:
+    void set_wake(std::function<void()> wake_fn) {
+        std::lock_guard<std::mutex> lock(mutex);
+        wake = std::move(wake_fn);
+    }
+
+    void post(std::coroutine_handle<> h) {
+        std::function<void()> wake_fn;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.push_back(h);
+            wake_fn = wake;
+        }
+        if (wake_fn) wake_fn();
+    }
+
+    // Resumes everything queued so far; coroutines posted while draining run on the next call.
+    // Both buffers keep their capacity, so an empty drain does not allocate.
+    std::size_t drain() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            batch.swap(ready);
+        }
+        for (auto h : batch) {
+            h.resume();
+        }
+        std::size_t resumed = batch.size();
+        batch.clear();
+        return resumed;
+    }
+
+    bool has_pending() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !ready.empty();
+    }
+
+    auto schedule() {
+        struct awaiter {
+            UiExecutor& executor;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { executor.post(h); }
+            void await_resume() const noexcept {}
+        };
+        return awaiter{ *this };
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::vector<std::coroutine_handle<>> ready;
+    std::vector<std::coroutine_handle<>> batch; // only touched by the draining thread
+    std::function<void()> wake;
+};
+
+#endif //FINALPROJECT_TASK_H
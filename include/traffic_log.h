@@ -0,0 +1,219 @@
+//
+// Recordings of the app's HTTP traffic, for reproducing a browsing session without a network.
+// A log is JSON lines, one per response that came back: the canonical URL it answers (API key left out),
+// its status, how long it took and when it arrived. Text bodies are stored in the line; anything else
+// (posters) goes to a file named by its hash in "<log stem>.bodies" next to the log, so a poster shown
+// many times is stored once. Replay reads a log back and hands out the recordings of each URL in order.
+//
+
+#ifndef FINALPROJECT_TRAFFIC_LOG_H
+#define FINALPROJECT_TRAFFIC_LOG_H
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include <json.hpp>
+
+#include <single_flight.h>
+
+namespace traffic_log {
+
+    struct Exchange {
+        int status = 0;
+        std::string body;
+        double latency_ms = 0.0;
+    };
+
+    // Key of a request in a log: its canonical URL without the apikey parameter, so a recording replays
+    // whichever key it went out with and the log never holds a key.
+    inline std::string RecordedUrl(std::string_view host, std::string_view path) {
+        std::size_t query_start = path.find('?');
+        if (query_start == std::string_view::npos) return CanonicalUrl(host, path);
+
+        std::string stripped(path.substr(0, query_start + 1));
+        std::string_view query = path.substr(query_start + 1);
+        while (!query.empty()) {
+            std::size_t amp = query.find('&');
+            std::string_view param = query.substr(0, amp);
+            query.remove_prefix(amp == std::string_view::npos ? query.size() : amp + 1);
+            if (param.empty() || param.substr(0, 7) == "apikey=") continue;
+            if (stripped.back() != '?') stripped += '&';
+            stripped += param;
+        }
+        return CanonicalUrl(host, stripped);
+    }
+
+    class Recorder {
+    public:
+        // Appends to file, creating it when missing. Returns false, leaving the recorder off, when the
+        // file cannot be opened.
+        bool Open(const std::filesystem::path& file) {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::error_code error;
+            if (file.has_parent_path()) {
+                std::filesystem::create_directories(file.parent_path(), error);
+            }
+            out.open(file, std::ios::binary | std::ios::app);
+            if (!out) return false;
+            bodies_name = file.stem().string() + ".bodies";
+            bodies_dir = file.parent_path() / bodies_name;
+            open = true;
+            return true;
+        }
+
+        bool IsOpen() const { return open; }
+
+        // Called from any thread once a response is complete. Each line is flushed on its own, so a
+        // session cut short still leaves a log that replays up to that point.
+        void Record(const std::string& url, int status, const std::string& body, double latency_ms) {
+            if (!open) return;
+            nlohmann::json line = {
+                { "url", url },
+                { "status", status },
+                { "ms", latency_ms },
+                { "at", std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::system_clock::now().time_since_epoch()).count() },
+                { "body", body }
+            };
+            std::string text;
+            try {
+                text = line.dump();
+            }
+            catch (const nlohmann::json::type_error&) {
+                // Not UTF-8 text: keep the bytes in a side file instead
+                line.erase("body");
+                line["body_file"] = bodies_name + "/" + BodyFileName(body);
+                text = line.dump();
+                std::lock_guard<std::mutex> lock(mutex);
+                WriteBodyFile(body);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            out << text << '\n';
+            out.flush();
+        }
+
+    private:
+        static std::string BodyFileName(std::string_view body) {
+            std::uint64_t hash = 14695981039346656037ull;
+            for (char c : body) {
+                hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+            }
+            char name[32];
+            std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(hash));
+            return name;
+        }
+
+        // Called with mutex held
+        void WriteBodyFile(const std::string& body) {
+            std::filesystem::path file = bodies_dir / BodyFileName(body);
+            std::error_code error;
+            if (std::filesystem::exists(file, error)) return;
+            std::filesystem::create_directories(bodies_dir, error);
+            std::filesystem::path temp = file;
+            temp += ".tmp";
+            {
+                std::ofstream stream(temp, std::ios::binary | std::ios::trunc);
+                stream.write(body.data(), std::streamsize(body.size()));
+                if (!stream) return;
+            }
+            std::filesystem::rename(temp, file, error);
+        }
+
+        std::mutex mutex;
+        std::ofstream out;
+        std::filesystem::path bodies_dir;
+        std::string bodies_name;
+        std::atomic<bool> open{ false };
+    };
+
+    class Replay {
+    public:
+        // Reads every recording of file into memory, side files included. Lines that cannot be parsed
+        // are skipped and counted in Skipped; false with error set when the file itself cannot be read.
+        bool Load(const std::filesystem::path& file, std::string& error) {
+            std::ifstream in(file, std::ios::binary);
+            if (!in) {
+                error = "cannot open " + file.string();
+                return false;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            std::string text;
+            while (std::getline(in, text)) {
+                if (text.empty()) continue;
+                nlohmann::json line = nlohmann::json::parse(text, nullptr, false);
+                if (line.is_discarded() || !line.is_object() || !line.contains("url") || !line.contains("status")) {
+                    ++skipped;
+                    continue;
+                }
+                Exchange exchange;
+                exchange.status = line.value("status", 0);
+                exchange.latency_ms = line.value("ms", 0.0);
+                if (line.contains("body_file")) {
+                    std::ifstream body(file.parent_path() / line.value("body_file", std::string()), std::ios::binary);
+                    if (!body) {
+                        ++skipped;
+                        continue;
+                    }
+                    exchange.body.assign(std::istreambuf_iterator<char>(body), std::istreambuf_iterator<char>());
+                }
+                else {
+                    exchange.body = line.value("body", std::string());
+                }
+                recordings[line.value("url", std::string())].exchanges.push_back(std::move(exchange));
+                ++size;
+            }
+            return true;
+        }
+
+        // The next recording of url: each is handed out once in the order it was recorded, then the last
+        // one answers every further request. Empty when url was never recorded.
+        std::optional<Exchange> Next(const std::string& url) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = recordings.find(url);
+            if (it == recordings.end()) return std::nullopt;
+            Recordings& found = it->second;
+            const Exchange& exchange = found.exchanges[found.next];
+            if (found.next + 1 < found.exchanges.size()) ++found.next;
+            return exchange;
+        }
+
+        std::size_t Size() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return size;
+        }
+
+        std::size_t Skipped() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return skipped;
+        }
+
+    private:
+        struct Recordings {
+            std::vector<Exchange> exchanges;
+            std::size_t next = 0;
+        };
+
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Recordings> recordings;
+        std::size_t size = 0;
+        std::size_t skipped = 0;
+    };
+
+} // namespace traffic_log
+
+#endif //FINALPROJECT_TRAFFIC_LOG_H
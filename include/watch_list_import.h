@@ -0,0 +1,187 @@
+//
+// Reading watch-list imports: an IMDb list/ratings CSV export (columns "Const", "Title", "Year")
+// or a plain text file with one title or IMDb id/URL per line ("Heat (1995)" and "tt0113277" both work).
+// Resolving what the file leaves unknown happens in the import flow in main.cpp.
+//
+
+#ifndef FINALPROJECT_WATCH_LIST_IMPORT_H
+#define FINALPROJECT_WATCH_LIST_IMPORT_H
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <mapped_file.h>
+#include <movie_record.h>
+
+namespace watch_list_import {
+
+    // One line of the import. id is "tt..." when the file names it; title and year may be empty.
+    struct Item {
+        std::string id;
+        std::string title;
+        std::string year;
+
+        // Items that carry all three need no lookup.
+        bool Complete() const { return !id.empty() && !title.empty() && !year.empty(); }
+    };
+
+    // Counters shared between the UI and the resolver threads.
+    struct Progress {
+        std::atomic<bool> running{ false };
+        std::atomic<int> total{ 0 };       // items left after dropping ones already in the list
+        std::atomic<int> processed{ 0 };
+        std::atomic<int> added{ 0 };
+        std::atomic<int> duplicates{ 0 };
+        std::atomic<int> not_found{ 0 };
+        std::atomic<int> failed{ 0 };
+        std::atomic<int> deferred{ 0 };    // not looked up because the request budget ran out
+
+        void Reset() {
+            total = processed = added = duplicates = not_found = failed = deferred = 0;
+        }
+    };
+
+    // RFC 4180 fields: quoted fields may contain commas, doubled quotes and newlines.
+    inline std::vector<std::vector<std::string>> ParseCsv(std::string_view text) {
+        std::vector<std::vector<std::string>> rows;
+        std::vector<std::string> row;
+        std::string field;
+        bool quoted = false;
+        bool field_started = false;
+
+        auto end_field = [&] {
+            row.push_back(std::move(field));
+            field.clear();
+            field_started = false;
+        };
+        auto end_row = [&] {
+            if (field_started || !row.empty()) {
+                end_field();
+                rows.push_back(std::move(row));
+                row.clear();
+            }
+        };
+
+        for (std::size_t i = 0; i < text.size(); ++i) {
+            char c = text[i];
+            if (quoted) {
+                if (c == '"') {
+                    if (i + 1 < text.size() && text[i + 1] == '"') {
+                        field += '"';
+                        ++i;
+                    }
+                    else {
+                        quoted = false;
+                    }
+                }
+                else {
+                    field += c;
+                }
+                continue;
+            }
+            switch (c) {
+                case '"': quoted = true; field_started = true; break;
+                case ',': end_field(); field_started = true; break;
+                case '\r': break;
+                case '\n': end_row(); break;
+                default: field += c; field_started = true; break;
+            }
+        }
+        end_row();
+        return rows;
+    }
+
+    // "https://www.imdb.com/title/tt0113277/" -> "tt0113277"; empty if the text holds no id.
+    inline std::string FindImdbId(std::string_view text) {
+        for (std::size_t pos = text.find("tt"); pos != std::string_view::npos; pos = text.find("tt", pos + 1)) {
+            std::size_t end = pos + 2;
+            while (end < text.size() && text[end] >= '0' && text[end] <= '9') ++end;
+            bool bounded = pos == 0 || !std::isalnum(static_cast<unsigned char>(text[pos - 1]));
+            if (end - pos >= 9 && bounded && (end == text.size() || !std::isalnum(static_cast<unsigned char>(text[end])))) {
+                return std::string(text.substr(pos, end - pos));
+            }
+        }
+        return {};
+    }
+
+    inline std::vector<Item> ParseCsvExport(std::string_view text) {
+        std::vector<Item> items;
+        std::vector<std::vector<std::string>> rows = ParseCsv(text);
+        if (rows.empty()) return items;
+
+        int id_column = -1;
+        int title_column = -1;
+        int year_column = -1;
+        for (int i = 0; i < int(rows[0].size()); ++i) {
+            std::string_view name = movie_record::Trim(rows[0][i]);
+            if (name.substr(0, 3) == "\xEF\xBB\xBF") name.remove_prefix(3); // BOM
+            if (name == "Const") id_column = i;
+            else if (name == "Title") title_column = i;
+            else if (name == "Year") year_column = i;
+        }
+
+        auto cell = [](const std::vector<std::string>& row, int column) {
+            return column >= 0 && column < int(row.size()) ? std::string(movie_record::Trim(row[column])) : std::string();
+        };
+        for (std::size_t r = 1; r < rows.size(); ++r) {
+            Item item;
+            item.id = FindImdbId(cell(rows[r], id_column));
+            item.title = cell(rows[r], title_column);
+            item.year = cell(rows[r], year_column);
+            if (!item.id.empty() || !item.title.empty()) {
+                items.push_back(std::move(item));
+            }
+        }
+        return items;
+    }
+
+    inline std::vector<Item> ParsePlainList(std::string_view text) {
+        std::vector<Item> items;
+        while (!text.empty()) {
+            std::size_t newline = text.find('\n');
+            std::string_view line = movie_record::Trim(text.substr(0, newline));
+            if (!line.empty() && line.back() == '\r') line = movie_record::Trim(line.substr(0, line.size() - 1));
+            text.remove_prefix(newline == std::string_view::npos ? text.size() : newline + 1);
+            if (line.empty() || line.front() == '#') continue;
+
+            Item item;
+            item.id = FindImdbId(line);
+            if (item.id.empty()) {
+                // "Title (1999)" carries the year used to disambiguate the lookup
+                std::size_t open = line.rfind('(');
+                if (open != std::string_view::npos && line.size() - open == 6 && line.back() == ')' &&
+                    std::all_of(line.begin() + open + 1, line.end() - 1, [](char c) { return c >= '0' && c <= '9'; })) {
+                    item.year = std::string(line.substr(open + 1, 4));
+                    line = movie_record::Trim(line.substr(0, open));
+                }
+                item.title = std::string(line);
+            }
+            items.push_back(std::move(item));
+        }
+        return items;
+    }
+
+    // An IMDb export is recognized by its "Const" header column; anything else is a plain list.
+    inline std::vector<Item> ParseText(std::string_view text) {
+        std::string_view first_line = text.substr(0, text.find('\n'));
+        if (first_line.find("Const") != std::string_view::npos && first_line.find(',') != std::string_view::npos) {
+            return ParseCsvExport(text);
+        }
+        return ParsePlainList(text);
+    }
+
+    inline std::vector<Item> ParseFile(const std::filesystem::path& path) {
+        MappedFile file(path);
+        return ParseText(file.View());
+    }
+
+} // namespace watch_list_import
+
+#endif //FINALPROJECT_WATCH_LIST_IMPORT_H
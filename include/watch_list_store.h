@@ -0,0 +1,405 @@
+//
+// Log-structured watch-list storage.
+// users/<name>.txt stays the pipe-delimited "id|title|year" snapshot (and import/export format);
+// edits are appended to users/<name>.journal as small records and made durable by a background
+// writer in batches (group commit). The journal is folded back into the snapshot with an atomic
+// rename once it grows, and on close.
+// The snapshot is memory-mapped and split on SIMD-located delimiters, in parallel for large files. Its
+// records stay views into the mapping for as long as the store is open; only journaled additions are copied.
+//
+
+#ifndef FINALPROJECT_WATCH_LIST_STORE_H
+#define FINALPROJECT_WATCH_LIST_STORE_H
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <io.h>
+#endif
+
+#include <delimiter_scan.h>
+#include <mapped_file.h>
+
+class WatchListStore {
+public:
+    struct Entry {
+        std::string id;
+        std::string title;
+        std::string year;
+    };
+
+    // A live entry as the store holds it: views into the mapped snapshot or the store's copy of a journaled
+    // addition. Valid until the next Open; copy what has to outlive that.
+    struct Record {
+        std::string_view id;
+        std::string_view title;
+        std::string_view year;
+    };
+
+    static constexpr std::size_t kCompactAfterRecords = 512;
+    static constexpr std::size_t kParallelParseBytes = 1 << 20; // smaller snapshots are parsed on the calling thread
+
+    WatchListStore() = default;
+    WatchListStore(const WatchListStore&) = delete;
+    WatchListStore& operator=(const WatchListStore&) = delete;
+    ~WatchListStore() { Close(); }
+
+    // Loads <dir>/<name>.txt, replays <dir>/<name>.journal on top of it and starts the writer.
+    // visit(const Record&) is called for each live entry in insertion order before the writer starts.
+    // A snapshot that was written by hand may repeat an id; visitors keep the first occurrence.
+    template <typename F>
+    void Open(const std::filesystem::path& dir, const std::string& name, F visit) {
+        Close();
+
+        snapshot_path = dir / (name + ".txt");
+        journal_path = dir / (name + ".journal");
+        entries.clear();
+        index.clear();
+        index_built = false;
+        added.clear();
+
+        ReadSnapshot(snapshot_path);
+        journal_records = ReplayJournal(journal_path);
+
+        journal = std::fopen(journal_path.string().c_str(), "ab");
+        if (journal == nullptr) {
+            std::cerr << "Unable to open watch list journal: " << journal_path << std::endl;
+        }
+
+        for (const Record& entry : entries) {
+            if (!entry.id.empty()) visit(entry);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = false;
+            pending.clear();
+        }
+        writer = std::thread(&WatchListStore::WriterLoop, this);
+    }
+
+    // Flushes outstanding records, folds the journal into the snapshot and stops the writer.
+    void Close() {
+        if (!writer.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        writer.join();
+
+        if (journal_records > 0) {
+            Compact();
+        }
+        if (journal != nullptr) {
+            std::fclose(journal);
+            journal = nullptr;
+        }
+    }
+
+    bool IsOpen() const { return writer.joinable(); }
+
+    void AppendAdd(const Entry& entry) {
+        Append("+|" + entry.id + "|" + entry.title + "|" + entry.year + "\n");
+    }
+
+    void AppendRemove(const std::string& id) {
+        Append("-|" + id + "\n");
+    }
+
+    // Queues several additions as one unit: they are written and synced together.
+    void AppendAdds(const std::vector<Entry>& batch) {
+        std::string records;
+        for (const Entry& entry : batch) {
+            records += "+|" + entry.id + "|" + entry.title + "|" + entry.year + "\n";
+        }
+        Append(std::move(records));
+    }
+
+    // Blocks until every record appended so far is on disk.
+    void Flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        std::uint64_t target = appended;
+        wake.notify_all();
+        synced_cv.wait(lock, [&] { return synced >= target || !writer.joinable(); });
+    }
+
+    // Writes the live entries in the pipe-delimited format to an arbitrary file.
+    bool Export(const std::filesystem::path& path) {
+        Flush();
+        std::lock_guard<std::mutex> lock(state_mutex);
+        return WriteSnapshot(path);
+    }
+
+private:
+    void Append(std::string records) {
+        if (records.empty()) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending += records;
+            ++appended;
+        }
+        wake.notify_one();
+    }
+
+    void WriterLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty() && stopping) break;
+
+            // Everything queued while the previous batch was syncing goes out in one write + fsync
+            std::string batch;
+            batch.swap(pending);
+            std::uint64_t batch_end = appended;
+            lock.unlock();
+
+            WriteBatch(batch);
+
+            lock.lock();
+            synced = batch_end;
+            synced_cv.notify_all();
+        }
+        synced_cv.notify_all();
+    }
+
+    void WriteBatch(const std::string& batch) {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        if (journal != nullptr) {
+            std::fwrite(batch.data(), 1, batch.size(), journal);
+            SyncToDisk(journal);
+        }
+        journal_records += ApplyRecords(batch);
+        if (journal_records >= kCompactAfterRecords) {
+            Compact();
+        }
+    }
+
+    // Writes the snapshot to a temporary file and renames it over the old one, then starts a fresh journal.
+    // A crash between the rename and the truncation only replays records the snapshot already contains.
+    // The old snapshot stays mapped: its records still point into it.
+    void Compact() {
+        std::filesystem::path tmp_path = snapshot_path;
+        tmp_path += ".tmp";
+        if (!WriteSnapshot(tmp_path)) {
+            std::cerr << "Failed to write watch list snapshot: " << tmp_path << std::endl;
+            return;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp_path, snapshot_path, ec);
+        if (ec) {
+            std::cerr << "Failed to replace watch list snapshot: " << ec.message() << std::endl;
+            return;
+        }
+
+        if (journal != nullptr) {
+            std::fclose(journal);
+        }
+        journal = std::fopen(journal_path.string().c_str(), "wb");
+        journal_records = 0;
+    }
+
+    bool WriteSnapshot(const std::filesystem::path& path) const {
+        std::FILE* file = std::fopen(path.string().c_str(), "wb");
+        if (file == nullptr) return false;
+        std::string line;
+        for (const Record& entry : entries) {
+            if (entry.id.empty()) continue; // removed
+            line.assign(entry.id).append("|").append(entry.title).append("|").append(entry.year).append("\n");
+            std::fwrite(line.data(), 1, line.size(), file);
+        }
+        bool ok = SyncToDisk(file);
+        std::fclose(file);
+        return ok;
+    }
+
+    // Flushes file and waits for the data to reach the disk where the platform offers a way to
+    static bool SyncToDisk(std::FILE* file) {
+        if (std::fflush(file) != 0) return false;
+#if defined(__unix__) || defined(__APPLE__)
+        return ::fsync(fileno(file)) == 0;
+#elif defined(_WIN32)
+        return ::_commit(::_fileno(file)) == 0;
+#else
+        return true;
+#endif
+    }
+
+    // A snapshot line is "id|title|year"; the year runs to the end of the line and must not be empty.
+    // Records are views into text.
+    template <typename Container>
+    static void ParseSnapshot(std::string_view text, Container& out) {
+        delimiter_scan::ForEachRecord<3>(text, [&](const std::string_view* fields, int count) {
+            if (count == 3 && !fields[2].empty()) {
+                out.push_back({ fields[0], fields[1], fields[2] });
+            }
+        });
+    }
+
+    void ReadSnapshot(const std::filesystem::path& path) {
+        snapshot = MappedFile(path);
+        std::string_view text = snapshot.View();
+
+        // Chunks end on line boundaries so each one parses independently
+        std::size_t workers = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                                    text.size() / (kParallelParseBytes / 2) + 1);
+        if (text.size() < kParallelParseBytes || workers < 2) {
+            ParseSnapshot(text, entries);
+            return;
+        }
+
+        std::vector<std::string_view> chunks;
+        std::size_t start = 0;
+        for (std::size_t i = 1; i <= workers && start < text.size(); ++i) {
+            std::size_t end = i == workers ? text.size() : text.find('\n', text.size() * i / workers);
+            end = end == std::string_view::npos ? text.size() : std::max(end + 1, start);
+            chunks.push_back(text.substr(start, end - start));
+            start = end;
+        }
+
+        std::vector<std::vector<Record>> parsed(chunks.size());
+        std::vector<std::thread> threads;
+        for (std::size_t i = 1; i < chunks.size(); ++i) {
+            threads.emplace_back([&, i] { ParseSnapshot(chunks[i], parsed[i]); });
+        }
+        ParseSnapshot(chunks[0], parsed[0]);
+        for (auto& thread : threads) thread.join();
+
+        for (auto& chunk : parsed) {
+            std::move(chunk.begin(), chunk.end(), std::back_inserter(entries));
+        }
+    }
+
+    std::size_t ReplayJournal(const std::filesystem::path& path) {
+        std::size_t applied = 0;
+        std::size_t keep = 0;
+        std::size_t size = 0;
+        {
+            MappedFile file(path);
+            std::string_view data = file.View();
+            size = data.size();
+
+            // A record without its newline was torn by a crash mid-append; drop it from the file too,
+            // otherwise the next append would be glued onto it
+            std::size_t complete = data.rfind('\n');
+            keep = complete == std::string_view::npos ? 0 : complete + 1;
+            applied = ApplyRecords(data.substr(0, keep));
+        }
+        if (keep < size) {
+            std::error_code ec;
+            std::filesystem::resize_file(path, keep, ec);
+        }
+        return applied;
+    }
+
+    // Journal records: "+|id|title|year" and "-|id", one per line.
+    std::size_t ApplyRecords(std::string_view records) {
+        std::size_t applied = 0;
+        delimiter_scan::ForEachRecord<4>(records, [&](const std::string_view* fields, int count) {
+            if (fields[0] == "+" && count == 4 && !fields[3].empty()) {
+                ApplyAdd(fields[1], fields[2], fields[3]);
+                ++applied;
+            }
+            else if (fields[0] == "-" && count == 2) {
+                ApplyRemove(fields[1]);
+                ++applied;
+            }
+        });
+        return applied;
+    }
+
+    // The fields point into a journal batch that is about to go away, so they are copied into one string
+    // of added; the record views that.
+    void ApplyAdd(std::string_view id, std::string_view title, std::string_view year) {
+        EnsureIndex();
+        if (index.count(id)) return;
+        std::string& text = added.emplace_back();
+        text.reserve(id.size() + title.size() + year.size());
+        text.append(id).append(title).append(year);
+        std::string_view copy = text;
+        entries.push_back({ copy.substr(0, id.size()), copy.substr(id.size(), title.size()),
+                            copy.substr(id.size() + title.size()) });
+        index.emplace(entries.back().id, entries.size() - 1);
+    }
+
+    void ApplyRemove(std::string_view id) {
+        EnsureIndex();
+        auto it = index.find(id);
+        if (it == index.end()) return;
+        std::size_t position = it->second;
+        index.erase(it);
+        entries[position].id = {}; // tombstone, dropped at the next compaction
+        if (entries.size() > 64 && index.size() < entries.size() / 2) {
+            Reindex();
+        }
+    }
+
+    // The id index is only needed once the list is edited, so loading a large snapshot does not pay for it.
+    // Building it also drops repeated ids, keeping the first.
+    void EnsureIndex() {
+        if (index_built) return;
+        index_built = true;
+        index.reserve(entries.size());
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].id.empty()) continue;
+            if (!index.emplace(entries[i].id, i).second) {
+                entries[i].id = {};
+            }
+        }
+    }
+
+    void Reindex() {
+        std::vector<Record> live;
+        live.reserve(index.size());
+        for (const Record& entry : entries) {
+            if (!entry.id.empty()) live.push_back(entry);
+        }
+        entries.swap(live);
+        index.clear();
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            index.emplace(entries[i].id, i);
+        }
+    }
+
+    std::filesystem::path snapshot_path;
+    std::filesystem::path journal_path;
+
+    // Materialized state, owned by the writer thread once Open() returns
+    std::mutex state_mutex;
+    MappedFile snapshot;       // what the snapshot records point into, as read at Open
+    std::deque<std::string> added; // what journaled additions point into; a deque, so the strings never move
+    std::vector<Record> entries;
+    std::unordered_map<std::string_view, std::size_t> index;
+    bool index_built = false;
+    std::size_t journal_records = 0;
+    std::FILE* journal = nullptr;
+
+    // Hand-off between the UI thread and the writer
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable synced_cv;
+    std::string pending;
+    std::uint64_t appended = 0;
+    std::uint64_t synced = 0;
+    bool stopping = false;
+    std::thread writer;
+};
+
+#endif //FINALPROJECT_WATCH_LIST_STORE_H
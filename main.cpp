@@ -1,29 +1,46 @@
 #define STB_IMAGE_IMPLEMENTATION
 #define CPPHTTPLIB_OPENSSL_SUPPORT
 #define IMGUI_IMPL_OPENGL_LOADER_CUSTOM
+#define ALLOC_TRACKER_IMPLEMENTATION
+#define MOVIE_CORE_IMPLEMENTATION
 
 #include <iostream>
 #include <string>
-#include <mach-o/dyld.h>
 
 #include <thread>
-#include <condition_variable>
 #include <atomic>
-#include <thread_safe_queue.h>
-
-#include <queue>
+#include <task.h>
+#include <frame_pacer.h>
+#include <alloc_tracker.h>
+#include <watch_list_store.h>
+#include <indexed_list.h>
+#include <movie_core.h>
+#include <search_arena.h>
+#include <movie_registry.h>
+
+#include <deque>
 #include <map>
 #include <set>
+#include <unordered_set>
+#include <optional>
+#include <functional>
+#include <future>
+#include <mutex>
 
 #include <fstream>
+#include <sstream>
 #include <filesystem>
+#include <memory_resource>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
+#include <movie_table.h>
 #include <stb_image.h>
+#include <frame_profiler.h>
+#include <gpu_timer.h>
 
 #include <json.hpp>
 #include <httplib.h>
@@ -32,23 +49,21 @@
 namespace fs = std::filesystem;
 using json = nlohmann::json;
 
-#define USER_DIRECTORY "./users/"
 #define FONT_SIZE 24.0f
 
-struct Movie {
-    std::string id;
-    std::string title;
-    std::string producer;
-    std::string release_year;
-    std::string runtime;
-    std::vector<std::string> genres;
-    std::vector<std::string> cast;
-    std::string poster_url;
-    GLuint texture_id = 0;
-    std::string rating;
-    std::string votes;
-    bool in_watch_list = false;
+// Search results, the watch list and the selection hold the same immutable record for a movie; details
+// are published once (UpdateMovie) and every view shows them. UI thread only.
+using MovieRef = RecordRegistry<Movie>::Ref;
+
+// Watch list entries are keyed by imdbID and kept sorted by title and by year
+struct WatchListTraits {
+    static std::uint32_t key(const MovieRef& movie) { return movie->id; }
+    static bool title_less(const MovieRef& a, const MovieRef& b) { return movie_sort::Less<movie_sort::Column::Title>{}(a, b); }
+    static bool year_less(const MovieRef& a, const MovieRef& b) { return movie_sort::Less<movie_sort::Column::Year>{}(a, b); }
+    static auto title_rank(const MovieRef& movie) { return movie_sort::TitleRank(movie->title); }
+    static auto year_rank(const MovieRef& movie) { return std::make_pair(movie->year_key, movie_sort::TitleRank(movie->title)); }
 };
+using WatchList = IndexedList<MovieRef, std::uint32_t, WatchListTraits>;
 
 enum class ImageState {
     NotLoaded,
@@ -66,62 +81,177 @@ struct ImageData {
     ImageState state = ImageState::NotLoaded;
 };
 
-// Global variables of the project:
+enum class SelectedList { None, SearchResults, WatchList };
+
+// A speculative flow parked by WaitForIdleNetwork until the interactive ones are done with the network
+struct IdleWaiter {
+    std::coroutine_handle<> handle;
+    std::chrono::steady_clock::time_point not_before;
+    CancelToken token;
+    std::uint64_t timer = 0; // wakes the main loop at not_before; 0 when it was already past
+};
+
+// One user's state: what they searched for, selected and keep in their watch list, the posters shown to
+// them and the flows working for them. Sessions share nothing but the Engine, so any number of them can
+// live in one process. A session is driven from one thread - the one that drains its ui_executor - and
+// must outlive the flows it spawned (cancel them and drain once more before destroying it).
+struct Session {
+    explicit Session(Engine& engine) : engine(engine) {}
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    Engine& engine;
+
+    // threads
+    std::mutex mtx;
+    std::atomic<bool> search_in_progress{ false };
+    std::atomic<bool> fetch_in_progress{ false };
+
+    // movie
+    std::map<std::string, ImageData, std::less<>> textureMap; // transparent, so a poster_url finds its entry without a copy
+    std::string image_url;
+
+    RecordRegistry<Movie> movie_registry;
+    WatchList watch_list;
+    WatchListStore watch_list_store; // journal + snapshot for the logged-in user's watch list
+    bool movie_not_found = false;
+    MovieRef selected_movie;
+    int selected_movie_index = -1;
+    SearchArena search_arena; // movie_list and the prefetch queue of the current search; see ResetSearchResults
+    std::pmr::vector<MovieRef> movie_list{ &search_arena };
+    SelectedList current_selected_list = SelectedList::None;
+    bool sort_watch_list_by_year = false;
+    bool sort_watch_list_ascending = true;
+    bool sort_movie_list_by_year = false;
+    bool sort_movie_list_ascending = true;
+    movie_sort::SortState movie_list_sort; // order movie_list is currently in
+
+    // watch list import
+    watch_list_import::Progress import_progress;
+    CancelToken import_token;
+    std::string import_status; // summary of the last finished import
+
+    // watch list hydration: details and posters fetched in the background after login
+    CancelToken hydration_token;
+    bool hydration_running = false;
+    std::deque<std::uint32_t> hydration_pending;        // ids still to look at, in load order
+    std::unordered_set<std::uint32_t> hydration_skipped; // lookups that failed; not retried this session
+    std::unordered_set<std::uint32_t> hydration_posters; // posters already tried, whatever came of it
+    int watch_list_visible_first = 0;                   // rows the watch list table showed last frame
+    int watch_list_visible_last = 0;
+
+    // speculative prefetch of search results: the top rows and the row under the mouse
+    bool prefetch_running = false;
+    std::pmr::vector<std::uint32_t> prefetch_queue{ &search_arena };     // a few ids, so a vector serves as the queue
+    std::pmr::vector<std::uint32_t> prefetch_requested{ &search_arena }; // ids queued since the last search
+
+    // user
+    std::string current_user;
+    std::string greeting; // "Hello <user>", rebuilt on login/logout rather than every frame
+    bool first_run = true;
+    char title_input[256] = "";
+    char year_input[5] = "";
+    bool connection_error = false;
+
+    // coroutine flows
+    UiExecutor ui_executor;
+    CancelToken search_token;     // current search flow
+    CancelToken selection_token;  // current details/poster flow
+    std::vector<IdleWaiter> idle_waiters; // see ResumeIdleWaiters
+};
+
+// co_await WaitForIdleNetwork(...); see its definition
+struct IdleNetworkAwaiter {
+    Session& session;
+    std::chrono::steady_clock::time_point not_before;
+    CancelToken token;
+
+    bool await_ready() const;
+    void await_suspend(std::coroutine_handle<> h);
+    void await_resume() const noexcept {}
+};
 
-// threads
-std::mutex mtx;
-std::condition_variable cv;
-ThreadSafeQueue<Movie> movie_queue;
-std::atomic<bool> image_thread_running(true);
-std::atomic<bool> search_in_progress(false);
-std::atomic<bool> fetch_in_progress(false);
+// Global variables of the project: what one process has once, whichever session it shows
 
-// movie
-std::queue<std::string> image_queue;
-std::map<std::string, ImageData> textureMap;
-std::string image_url;
+// images
 GLuint welcome_texture = 0;
 GLuint g_defaultTexture = 0;
 bool g_openGLInitialized = false;
 
-std::vector<Movie> watch_list;
-std::set<std::string> watch_list_titles;
-bool movie_not_found = false;
-Movie selected_movie;
-int selected_movie_index = -1;
-std::vector<Movie> movie_list;
-enum class SelectedList { None, SearchResults, WatchList };
-SelectedList current_selected_list = SelectedList::None;
-bool sort_watch_list_by_year = false;
-bool sort_watch_list_ascending = true;
-bool sort_movie_list_by_year = false;
-bool sort_movie_list_ascending = true;
+// watch list import
+constexpr int kImportConcurrency = 4;
+constexpr double kImportRequestsPerSecond = 8.0;
+
+// watch list hydration
+constexpr int kHydrationRequestBudget = 300; // per login, leaving most of the daily quota to searches
+constexpr double kHydrationRequestsPerSecond = 2.0;
 
-// user and window
+// search result prefetch
+constexpr int kPrefetchTopResults = 3;
+constexpr double kPrefetchRequestsPerSecond = 4.0;
+
+// window
 GLFWwindow* window;
-std::string current_user;
-bool first_run = true;
-char title_input[256] = "";
-char year_input[5] = "";
-bool connection_error = false;
-std::string api_key;
+FramePacer frame_pacer;
+bool show_frame_stats = false;
+const char* loading_dots[] = { ".", "..", "..." };
+
+// profiling
+FrameProfiler frame_profiler;
+GpuTimer gpu_timer;
+bool show_profiler = false;
+const int SECTION_QUEUE_DRAIN = frame_profiler.SectionId("queue drain");
+const int SECTION_IMGUI_BUILD = frame_profiler.SectionId("imgui build");
+const int SECTION_POSTER = frame_profiler.SectionId("poster");
+const int SECTION_TEXTURE_UPLOAD = frame_profiler.SectionId("texture upload");
+const int SECTION_SORT = frame_profiler.SectionId("sort");
+const int SECTION_RENDER = frame_profiler.SectionId("render");
+const int SECTION_GPU_RENDER = frame_profiler.SectionId("gpu render");
+const int SECTION_GPU_TEXTURE_UPLOAD = frame_profiler.SectionId("gpu texture upload");
+
+// allocation tracking (counts stay zero unless built with AGM_TRACK_ALLOCATIONS)
+AllocTracker alloc_tracker;
+bool fail_on_idle_allocation = false; // AGM_FAIL_ON_IDLE_ALLOC: exit with failure when an idle frame allocates
+const int ALLOC_SCOPE_QUEUE_DRAIN = alloc_tracker.ScopeId("queue drain");
+const int ALLOC_SCOPE_POSTER = alloc_tracker.ScopeId("poster");
+const int ALLOC_SCOPE_SEARCH_TABLE = alloc_tracker.ScopeId("search table");
+const int ALLOC_SCOPE_WATCH_TABLE = alloc_tracker.ScopeId("watch list table");
+const int ALLOC_SCOPE_SORT = alloc_tracker.ScopeId("sort");
 
 // Functions:
 
 // General
-std::string GetExecutablePath();
 void CheckGLError(const char* operation);
-void logError(const std::string& message);
 int FilterNumericInput(ImGuiInputTextCallbackData* data);
 void LoadFonts(ImGuiIO& io);
-void ResetApplication();
+void ResetApplication(Session& session);
 void DrawTexturedQuad(GLuint texture_id);
+void InstallActivityCallbacks(GLFWwindow* window);
+void DrawFrameStats(Session& session);
+void DrawProfilerOverlay();
 
 // Movie
-bool IsInWatchList(const std::string& id);
-void FetchMovieList(const std::string& title, const std::string& year);
-bool FetchMovieInfo(Movie& movie);
-void FetchMovieInfoThread(const Movie& movie, int index);
+bool IsInWatchList(Session& session, std::uint32_t id);
+void LoadSearchResults(Session& session, const HttpResponse& res, const std::string& title, const std::string& year);
+void ResetSearchResults(Session& session);
+MovieRef InternMovie(Session& session, Movie movie);
+MovieRef UpdateMovie(Session& session, std::uint32_t id, Movie detailed);
+
+// What FetchMovieInfo found out. It runs off the UI thread, so the flow applies this to the session itself.
+struct FetchOutcome {
+    bool fetched = false;
+    bool connection_error = false;
+    std::string image_url;
+};
+task<FetchOutcome> FetchMovieInfo(Engine& engine, Movie& movie, CancelToken token);
+
+// Async flows: search -> details -> poster as coroutines that hop between the engine's I/O thread, worker
+// threads (image decoding) and the UI thread
+task<ImageData> AsyncDecodeImage(std::string body);
+task<void> SearchFlow(Session& session, std::string title, std::string year, CancelToken token);
+task<void> ShowMovieFlow(Session& session, MovieRef shown, CancelToken token);
+task<void> LoadPosterFlow(Session& session, std::string url, CancelToken token);
+void StartShowMovie(Session& session, const MovieRef& movie);
 
 // Image
 void error_callback(int error, const char* description);
@@ -129,36 +259,61 @@ void ResetGLState();
 void InitializeOpenGL();
 bool IsValidImageData(const ImageData& imageData, const std::string& url);
 void CleanupOnError(ImageData& imageData);
-bool CreateTexture(const std::string& url);
-void EnsureImageLoaded(const std::string& url);
-void DisplayMoviePoster(const std::string& poster_url, float image_width, float image_height);
+bool CreateTexture(Session& session, const std::string& url);
+void DisplayMoviePoster(Session& session, std::string_view poster_url, float image_width, float image_height);
 GLuint LoadWelcomeImage(const char* filename);
-void LoadImageFromUrl(const std::string& url);
-void ImageLoadingThread();
 
 // Handle Watch list
-void SaveWatchList();
-void AddToWatchList(const Movie& movie);
-std::pair<bool, int> RemoveFromWatchList(const std::string& id);
-void LoadWatchList(const std::string& username);
+void AddToWatchList(Session& session, const MovieRef& movie);
+std::pair<bool, int> RemoveFromWatchList(Session& session, std::uint32_t id);
+void LoadWatchList(Session& session, const std::string& username);
+
+// Watch list import
+task<void> ImportFlow(Session& session, std::string path, CancelToken token);
+void StartImport(Session& session, const std::string& path);
+void DrawImportProgress(Session& session);
+
+// Watch list hydration
+bool NextHydrationCandidate(Session& session, Movie& movie, bool& needs_details);
+task<void> HydrationFlow(Session& session, CancelToken token);
+void QueueHydration(Session& session, const std::vector<std::uint32_t>& ids);
+void StartHydration(Session& session);
+void StopHydration(Session& session);
+bool NetworkBusy(const Session& session);
+IdleNetworkAwaiter WaitForIdleNetwork(Session& session, std::chrono::steady_clock::time_point not_before, CancelToken token);
+void ResumeIdleWaiters(Session& session);
+
+// Search result prefetch
+task<void> PrefetchFlow(Session& session, CancelToken token);
+void QueuePrefetch(Session& session, std::uint32_t id, bool urgent);
+void StartPrefetch(Session& session);
 
 // User interface
-bool UserLogin(const std::string& username);
-void Logout();
+bool UserLogin(Session& session, const std::string& username);
+void Logout(Session& session);
 
 // Sort Functions
-bool compareMoviesByTitle(const Movie& a, const Movie& b, bool ascending);
-bool compareMoviesByYear(const Movie& a, const Movie& b, bool ascending);
-void sortWatchList();
-void sortMovieList();
+void sortWatchList(Session& session);
+void sortMovieList(Session& session);
 
-// handle api_key
-void read_api_key();
+// Network status
+void DrawNetworkStatus(Session& session);
 
 // Main
 int main() {
     std::cout << "hello\n";
-    read_api_key();
+    fail_on_idle_allocation = std::getenv("AGM_FAIL_ON_IDLE_ALLOC") != nullptr;
+    double prefetch_quota_share = 0.1; // AGM_PREFETCH_QUOTA_SHARE: share of the daily quota prefetching may use
+    if (const char* share = std::getenv("AGM_PREFETCH_QUOTA_SHARE")) {
+        prefetch_quota_share = std::clamp(std::atof(share), 0.0, 1.0);
+    }
+
+    // One window shows one session; the engine underneath could serve more
+    Engine engine;
+    Session session(engine);
+    ConfigureTraffic(engine);
+    read_api_key(engine, prefetch_quota_share);
+    engine.response_cache.Open(fs::path(GetExecutablePath()) / "cache", kResponseCacheBytes);
 
     // Initialize GLFW
     if (!glfwInit()) {
@@ -190,6 +345,7 @@ int main() {
     }
 
     glfwMakeContextCurrent(window);
+    glfwSwapInterval(1);
 
     // Initialize OpenGL and create default texture
     InitializeOpenGL();
@@ -220,7 +376,8 @@ int main() {
     // Set GLSL version
     const char* glsl_version = "#version 410";
 
-    // Initialize ImGui for GLFW and OpenGL3
+    // Initialize ImGui for GLFW and OpenGL3 (installed after our callbacks so ImGui chains them)
+    InstallActivityCallbacks(window);
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     if (!ImGui_ImplOpenGL3_Init(glsl_version)) {
         std::cerr << "Failed to initialize ImGui OpenGL3 binding" << std::endl;
@@ -259,19 +416,52 @@ int main() {
         std::this_thread::sleep_for(std::chrono::seconds(2));  // Wait for 2 seconds to see the textured quad
     }
 
-    // Start the image loading thread
-    std::thread image_thread(ImageLoadingThread);
+    // Flows resumed from worker threads wake the main loop
+    session.ui_executor.set_wake([] { glfwPostEmptyEvent(); });
 
-    // Variables for ImGui input
-    std::thread fetch_thread;// for single movie details
-    std::thread fetcher_thread;// for movie list
     std::string message;
 
 
     // Main loop
     while (!glfwWindowShouldClose(window)) {
-        glfwPollEvents();
+        // Sleep until input, a worker finishing (glfwPostEmptyEvent) or the pacer's timeout
+        FramePacer::Activity activity;
+        ResumeIdleWaiters(session); // the last drain and frame may have freed the network
+        activity.work_pending = NetworkBusy(session) || session.ui_executor.has_pending();
+        activity.text_input = io.WantTextInput;
+        activity.focused = glfwGetWindowAttrib(window, GLFW_FOCUSED) != 0;
+        activity.minimized = glfwGetWindowAttrib(window, GLFW_ICONIFIED) != 0;
+        double timeout = frame_pacer.WaitTimeout(activity);
+        if (timeout > 0.0) {
+            glfwWaitEventsTimeout(timeout);
+        }
+        else {
+            glfwPollEvents();
+        }
+        frame_pacer.Woke();
+        frame_profiler.BeginFrame();
+        alloc_tracker.BeginFrame();
+        gpu_timer.Collect(frame_profiler);
+
+        // Resume flows whose background stage finished
+        bool idle_frame = frame_pacer.IdleWake();
+        {
+            ScopedTimer timer(frame_profiler, SECTION_QUEUE_DRAIN);
+            AllocScope alloc_scope(alloc_tracker, ALLOC_SCOPE_QUEUE_DRAIN);
+            if (session.ui_executor.drain() > 0) {
+                idle_frame = false;
+            }
+        }
 
+        // Nothing visible to draw while minimized
+        if (activity.minimized) {
+            frame_profiler.EndFrame();
+            alloc_tracker.EndFrame(false);
+            continue;
+        }
+        frame_pacer.BeginFrame();
+
+        frame_profiler.BeginSection(SECTION_IMGUI_BUILD);
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
@@ -292,26 +482,25 @@ int main() {
         // AGM button in the top left corner
         ImGui::SetCursorPos(ImVec2(10.0f, 10.0f));
         if (ImGui::Button("AGM Home Screen")) {
-            ResetApplication();
+            ResetApplication(session);
         }
 
         // Greeting message in the center
-        if (!current_user.empty()) {
+        if (!session.current_user.empty()) {
             ImFont* greetingFont = ImGui::GetIO().Fonts->Fonts[2];
             ImGui::PushFont(greetingFont);
             ImGui::SetWindowFontScale(0.75f);
 
-            std::string greeting = "Hello " + current_user;
-            float textWidth = ImGui::CalcTextSize(greeting.c_str()).x;
+            float textWidth = ImGui::CalcTextSize(session.greeting.c_str()).x;
             ImGui::SetCursorPos(ImVec2((ImGui::GetWindowWidth() - textWidth) * 0.5f, 10.0f));
 
             // Shadow effect
             ImVec2 originalPos = ImGui::GetCursorPos();
             ImGui::SetCursorPos(ImVec2(originalPos.x + 1, originalPos.y + 1)); // Reduced shadow offset for smaller font
-            ImGui::TextColored(ImVec4(0.0f, 0.0f, 0.0f, 0.5f), "%s", greeting.c_str());
+            ImGui::TextColored(ImVec4(0.0f, 0.0f, 0.0f, 0.5f), "%s", session.greeting.c_str());
             ImGui::SetCursorPos(originalPos);
 
-            ImGui::TextColored(ImVec4(0.0f, 0.5f, 1.0f, 1.0f), "%s", greeting.c_str());
+            ImGui::TextColored(ImVec4(0.0f, 0.5f, 1.0f, 1.0f), "%s", session.greeting.c_str());
 
             ImGui::SetWindowFontScale(1.0f); // Reset the font scale
             ImGui::PopFont();
@@ -319,21 +508,21 @@ int main() {
 
         // User Profile button on the right
         float window_width = ImGui::GetWindowWidth();
-        float button_width = ImGui::CalcTextSize(current_user.empty() ? "Login" : "User Profile").x + ImGui::GetStyle().FramePadding.x * 2.0f;
+        float button_width = ImGui::CalcTextSize(session.current_user.empty() ? "Login" : "User Profile").x + ImGui::GetStyle().FramePadding.x * 2.0f;
         ImGui::SetCursorPos(ImVec2(window_width - button_width - 25.0f, 10.0f));
-        if (ImGui::Button(current_user.empty() ? "Login" : "User Profile")) {
+        if (ImGui::Button(session.current_user.empty() ? "Login" : "User Profile")) {
             ImGui::OpenPopup("UserProfilePopup");
         }
 
         // User Profile popup
         if (ImGui::BeginPopup("UserProfilePopup")) {
             static char username[256] = "";
-            if (current_user.empty()) {
+            if (session.current_user.empty()) {
                 ImGui::InputText("Username", username, IM_ARRAYSIZE(username));
                 ImGui::BeginDisabled(strlen(username) == 0);
 
                 if (ImGui::Button("Login") || (ImGui::IsKeyPressed(ImGuiKey_Enter) && strlen(username) > 0)) {
-                    if (UserLogin(username)) {
+                    if (UserLogin(session, username)) {
                         ImGui::CloseCurrentPopup();
                     }
                     else {
@@ -349,12 +538,25 @@ int main() {
                 }
             }
             else {
-                ImGui::Text("Logged in as: %s", current_user.c_str());
+                ImGui::Text("Logged in as: %s", session.current_user.c_str());
                 if (ImGui::Button("Logout")) {
-                    Logout();
+                    Logout(session);
                     memset(username, 0, sizeof(username)); // Clear the username field
                     ImGui::CloseCurrentPopup();
                 }
+
+                // Bulk import into the watch list
+                static char import_path[512] = "";
+                ImGui::Separator();
+                ImGui::Text("Import watch list");
+                ImGui::InputText("File", import_path, IM_ARRAYSIZE(import_path));
+                ImGui::BeginDisabled(session.import_progress.running.load() || strlen(import_path) == 0);
+                if (ImGui::Button("Import")) {
+                    StartImport(session, import_path);
+                    ImGui::CloseCurrentPopup();
+                }
+                ImGui::EndDisabled();
+                ImGui::TextDisabled("IMDb CSV export, or one title / IMDb id per line");
             }
             ImGui::EndPopup();
         }
@@ -367,8 +569,8 @@ int main() {
 
             ImGui::BeginDisabled(strlen(login_username) == 0);
             if (ImGui::Button("Login") || (ImGui::IsKeyPressed(ImGuiKey_Enter) && strlen(login_username) > 0)) {
-                if (UserLogin(login_username)) {
-                    AddToWatchList(selected_movie);
+                if (UserLogin(session, login_username)) {
+                    AddToWatchList(session, session.selected_movie);
                     ImGui::CloseCurrentPopup();
                 }
                 else {
@@ -399,7 +601,7 @@ int main() {
 
         // Left column
         ImGui::BeginChild("LeftColumn", ImVec2(0, -1), true);
-        if (first_run) {
+        if (session.first_run) {
             ImGui::SetCursorPosY(40);  // Add some top padding
 
             ImFont* specialFont72 = io.Fonts->Fonts[4];  // Assuming it's the 5th font we loaded
@@ -437,30 +639,38 @@ int main() {
         }
 
         // Display movie details
-        if (selected_movie_index != -1) {
+        if (session.selected_movie_index != -1) {
             ImGui::BeginChild("MovieDetailsLayout", ImVec2(0, -1), false, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize);
 
             // Movie Information
-            if (fetch_in_progress.load()) {
-                ImGui::Text("Fetching movie details...");
+            if (session.fetch_in_progress.load()) {
+                ImGui::Text("Fetching movie details%s", loading_dots[frame_pacer.AnimationStep(3)]);
             }
             else {
-                ImGui::Text("Title: %s", selected_movie.title.c_str());
-                ImGui::Text("Year: %s", selected_movie.release_year.c_str());
-                ImGui::Text("Director: %s", selected_movie.producer.c_str());
-                ImGui::Text("Runtime: %s", selected_movie.runtime.c_str());
-                ImGui::Text("IMDb Rating: %s", selected_movie.rating.c_str());
-                ImGui::Text("Votes: %s", selected_movie.votes.c_str());
-                if (!selected_movie.genres.empty()) {
+                char field[32];
+                ImGui::Text("Title: %s", session.selected_movie->title.c_str());
+                movie_record::FormatYear(session.selected_movie->year_start, session.selected_movie->year_end, field, sizeof(field));
+                ImGui::Text("Year: %s", field);
+                const std::string& director = StringInterner::Global().Get(session.selected_movie->director);
+                ImGui::Text("Director: %s", director.empty() ? "Unknown" : director.c_str());
+                movie_record::FormatRuntime(session.selected_movie->runtime_minutes, field, sizeof(field));
+                ImGui::Text("Runtime: %s", field);
+                movie_record::FormatRating(session.selected_movie->rating_x10, field, sizeof(field));
+                ImGui::Text("IMDb Rating: %s", field);
+                movie_record::FormatVotes(session.selected_movie->votes, field, sizeof(field));
+                ImGui::Text("Votes: %s", field);
+                if (session.selected_movie->genres != 0) {
                     ImGui::Text("Genres:");
-                    for (const auto& genre : selected_movie.genres) {
-                        ImGui::BulletText("%s", genre.c_str());
+                    for (std::size_t g = 0; g < movie_record::kGenreNames.size(); ++g) {
+                        if (session.selected_movie->genres & (1u << g)) {
+                            ImGui::BulletText("%s", movie_record::kGenreNames[g]);
+                        }
                     }
                 }
-                if (!selected_movie.cast.empty()) {
+                if (session.selected_movie->cast_count > 0) {
                     ImGui::Text("Cast:");
-                    for (const auto& actor : selected_movie.cast) {
-                        ImGui::BulletText("%s", actor.c_str());
+                    for (int c = 0; c < session.selected_movie->cast_count; ++c) {
+                        ImGui::BulletText("%s", StringInterner::Global().Get(session.selected_movie->cast[c]).c_str());
                     }
                 }
             }
@@ -470,25 +680,22 @@ int main() {
             // Movie Poster
             float image_width = 200;
             float image_height = 300;
-            DisplayMoviePoster(selected_movie.poster_url, image_width, image_height);
+            {
+                ScopedTimer timer(frame_profiler, SECTION_POSTER);
+                AllocScope alloc_scope(alloc_tracker, ALLOC_SCOPE_POSTER);
+                DisplayMoviePoster(session, session.selected_movie->poster_url, image_width, image_height);
+            }
             ImGui::Spacing();
 
             // Add to watch list button
             if (ImGui::Button("Add to Watch List")) {
-                first_run = false;
-                if (current_user.empty()) {
+                session.first_run = false;
+                if (session.current_user.empty()) {
                     ImGui::OpenPopup("LoginRequiredPopup");
                 }
                 else {
-                    if (!IsInWatchList(selected_movie.id)) {
-                        AddToWatchList(selected_movie);
-                        selected_movie.in_watch_list = true;
-                        // Update the movie in movie_list if it exists there
-                        auto it = std::find_if(movie_list.begin(), movie_list.end(),
-                                               [&](const Movie& m) { return m.id == selected_movie.id; });
-                        if (it != movie_list.end()) {
-                            it->in_watch_list = true;
-                        }
+                    if (!IsInWatchList(session, session.selected_movie->id)) {
+                        AddToWatchList(session, session.selected_movie);
                     }
                 }
             }
@@ -496,42 +703,34 @@ int main() {
             ImGui::SameLine();
 
             if (ImGui::Button("Remove from Watch List")) {
-                if (current_selected_list != SelectedList::None && selected_movie_index != -1 && IsInWatchList(selected_movie.id)) {
-                    auto [removed, new_index] = RemoveFromWatchList(selected_movie.id);
+                if (session.current_selected_list != SelectedList::None && session.selected_movie_index != -1 && IsInWatchList(session, session.selected_movie->id)) {
+                    auto [removed, new_index] = RemoveFromWatchList(session, session.selected_movie->id);
                     if (removed) {
                         ImGui::OpenPopup("RemovedFromWatchList");
 
                         // If we're viewing the watch list, update the selection
-                        if (current_selected_list == SelectedList::WatchList) {
-                            if (watch_list.empty()) {
-                                current_selected_list = SelectedList::None;
-                                selected_movie_index = -1;
-                                selected_movie = Movie();
-                                image_url.clear();
+                        if (session.current_selected_list == SelectedList::WatchList) {
+                            if (session.watch_list.empty()) {
+                                session.current_selected_list = SelectedList::None;
+                                session.selected_movie_index = -1;
+                                session.selected_movie = MovieRef();
+                                session.image_url.clear();
                             }
                             else {
-                                selected_movie_index = new_index;
-                                selected_movie = watch_list[selected_movie_index];
-                                image_url = selected_movie.poster_url;
+                                session.selected_movie_index = new_index;
+                                session.selected_movie = session.watch_list[session.selected_movie_index];
+                                session.image_url = session.selected_movie->poster_url;
 
                                 // Fetch detailed movie info for the newly selected movie
-                                fetch_in_progress.store(true);
-                                if (fetch_thread.joinable()) {
-                                    fetch_thread.join();
-                                }
-                                fetch_thread = std::thread(FetchMovieInfoThread, selected_movie, selected_movie_index);
+                                StartShowMovie(session, session.selected_movie);
                             }
                         }
-                        else {
-                            // If we're in the search results, just update the status
-                            selected_movie.in_watch_list = false;
-                        }
                     }
                     else {
                         ImGui::OpenPopup("RemoveFromWatchListFailed");
                     }
                 }
-                else if (!IsInWatchList(selected_movie.id)) {
+                else if (!IsInWatchList(session, session.selected_movie->id)) {
                     ImGui::OpenPopup("MovieNotInWatchList");
                 }
                 else {
@@ -590,8 +789,8 @@ int main() {
 
                 ImGui::BeginDisabled(strlen(login_username) == 0);
                 if (ImGui::Button("Login") || (ImGui::IsKeyPressed(ImGuiKey_Enter) && strlen(login_username) > 0)) {
-                    if (UserLogin(login_username)) {
-                        AddToWatchList(selected_movie);
+                    if (UserLogin(session, login_username)) {
+                        AddToWatchList(session, session.selected_movie);
                         reset_username = true;
                         ImGui::CloseCurrentPopup();
                     }
@@ -617,7 +816,7 @@ int main() {
 
             // Messages for watch list status
             ImGui::BeginGroup();
-            bool in_watch_list = IsInWatchList(selected_movie.id);
+            bool in_watch_list = IsInWatchList(session, session.selected_movie->id);
             if (in_watch_list) {
                 ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "Movie is in watch list");
             }
@@ -642,166 +841,82 @@ int main() {
 
         // Title search
         ImGui::Text("Title:");
-        bool triggerSearch = ImGui::InputText("Title", title_input, IM_ARRAYSIZE(title_input),
+        bool triggerSearch = ImGui::InputText("Title", session.title_input, IM_ARRAYSIZE(session.title_input),
                                               ImGuiInputTextFlags_EnterReturnsTrue);
 
         ImGui::Text("Year (optional):");
-        triggerSearch |= ImGui::InputText("Year", year_input, IM_ARRAYSIZE(year_input),
+        triggerSearch |= ImGui::InputText("Year", session.year_input, IM_ARRAYSIZE(session.year_input),
                                           ImGuiInputTextFlags_EnterReturnsTrue | ImGuiInputTextFlags_CallbackCharFilter,
                                           FilterNumericInput);
 
         ImGui::SameLine();
         if (ImGui::Button("Search") || triggerSearch) {
-            if (fetcher_thread.joinable()) {
-                fetcher_thread.join();
-            }
-            movie_list.clear();
-            selected_movie = Movie();
-            image_url.clear();
-            movie_not_found = false;
-            connection_error = false;
-            selected_movie_index = -1;
-            search_in_progress.store(true);
-            movie_queue.clear();
+            // A new search supersedes whatever the previous one was still doing
+            session.search_token.cancel();
+            session.selection_token.cancel();
+            session.search_token = CancelToken();
+
+            ResetSearchResults(session);
+            session.selected_movie = MovieRef();
+            session.image_url.clear();
+            session.movie_not_found = false;
+            session.connection_error = false;
+            session.selected_movie_index = -1;
+            session.search_in_progress.store(true);
+            session.fetch_in_progress.store(false);
 
             // Trigger fetching movie list based on title and use year as a filter
-            fetcher_thread = std::thread([&]() {
-                FetchMovieList(title_input, year_input);
-            });
-        }
-
-        // Process movies from the queue
-        if (search_in_progress.load()) {
-            Movie movie;
-            while (movie_queue.pop(movie)) {
-                movie_list.push_back(movie);
-            }
-            if (movie_queue.is_finished()) {
-                search_in_progress.store(false);
-                if (!movie_list.empty()) {
-                    first_run = false;
-                }
-                if (movie_list.empty()) {
-                    movie_not_found = true;
-                }
-                else if (movie_list.size() == 1) {
-                    // Automatically select and display the movie if it's the only one in the list
-                    selected_movie_index = 0;
-                    selected_movie = movie_list[0];
-                    image_url.clear();
-
-                    // Fetch detailed movie info
-                    bool fetch_success = FetchMovieInfo(selected_movie);
-                    if (fetch_success) {
-                        // Update the movie in the list with the fetched details
-                        movie_list[selected_movie_index] = selected_movie;
-
-                        // Load the image if it's not already loaded
-                        if (!image_url.empty()) {
-                            std::unique_lock<std::mutex> lock(mtx);
-                            if (textureMap.find(image_url) == textureMap.end()) {
-                                image_queue.push(image_url);
-                                cv.notify_one();
-                            }
-                        }
-                    }
-                    else {
-                        std::cerr << "Failed to fetch movie details. Please try again." << std::endl;
-                    }
-                }
-            }
+            spawn(SearchFlow(session, session.title_input, session.year_input, session.search_token));
         }
 
         // Display search results or messages
-        if (search_in_progress.load()) {
-            ImGui::Text("Searching...");
+        if (session.search_in_progress.load()) {
+            ImGui::Text("Searching%s", loading_dots[frame_pacer.AnimationStep(3)]);
         }
-        else if (!movie_list.empty()) {
+        else if (!session.movie_list.empty()) {
             ImGui::Text("Search Results:");
             // Create a child window for the scrollable list
             ImGui::BeginChild("SearchResults", ImVec2(0, float(display_h) * 0.3f), true);
-            if (ImGui::BeginTable("SearchResultsTable", 2, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Sortable | ImGuiTableFlags_Resizable | ImGuiTableFlags_SizingStretchProp)) {
-                ImGui::TableSetupColumn("Title", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_WidthStretch, 0.7f);
-                ImGui::TableSetupColumn("Year", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_WidthStretch, 0.3f);
-                ImGui::TableHeadersRow();
-
-                if (ImGui::TableGetSortSpecs()->SpecsDirty) {
-                    ImGuiTableSortSpecs* sorts_specs = ImGui::TableGetSortSpecs();
-                    if (sorts_specs->Specs->ColumnIndex == 0) {
-                        sort_movie_list_by_year = false;
-                        sort_movie_list_ascending = sorts_specs->Specs->SortDirection == ImGuiSortDirection_Ascending;
-                    }
-                    else {
-                        sort_movie_list_by_year = true;
-                        sort_movie_list_ascending = sorts_specs->Specs->SortDirection == ImGuiSortDirection_Ascending;
-                    }
-                    sortMovieList();
-                    sorts_specs->SpecsDirty = false;
+            if (movie_table::Begin("SearchResultsTable")) {
+                AllocScope alloc_scope(alloc_tracker, ALLOC_SCOPE_SEARCH_TABLE);
+                if (movie_table::SortRequested(session.sort_movie_list_by_year, session.sort_movie_list_ascending)) {
+                    sortMovieList(session);
                 }
 
-                for (int i = 0; i < movie_list.size(); ++i) {
-                    ImGui::TableNextRow();
-                    ImGui::TableSetColumnIndex(0);
-                    std::string selectable_label = movie_list[i].title + "##" + std::to_string(i);
-                    if (ImGui::Selectable(selectable_label.c_str(),
-                                          current_selected_list == SelectedList::SearchResults && selected_movie_index == i,
-                                          ImGuiSelectableFlags_SpanAllColumns)) {
-                        try {
-                            first_run = false;
-                            selected_movie_index = i;
-                            current_selected_list = SelectedList::SearchResults;
-                            selected_movie = movie_list[i];
-                            image_url = selected_movie.poster_url;
-
-                            // Fetch detailed movie info when selected
-                            fetch_in_progress.store(true);
-                            if (fetch_thread.joinable()) {
-                                fetch_thread.join();
-                            }
-                            fetch_thread = std::thread([i]() {
-                                try {
-                                    Movie temp_movie = movie_list[i];
-                                    bool fetch_success = FetchMovieInfo(temp_movie);
-                                    if (fetch_success) {
-                                        std::lock_guard<std::mutex> lock(mtx);
-                                        movie_list[i] = temp_movie;
-                                        if (selected_movie_index == i && current_selected_list == SelectedList::SearchResults) {
-                                            selected_movie = temp_movie;
-                                            selected_movie.in_watch_list = IsInWatchList(selected_movie.id);
-                                            // Load the image if it's not already loaded
-                                            if (!selected_movie.poster_url.empty()) {
-                                                if (textureMap.find(selected_movie.poster_url) == textureMap.end()) {
-                                                    image_queue.push(selected_movie.poster_url);
-                                                    cv.notify_one();
-                                                }
-                                            }
-                                        }
-                                    }
-                                    else {
-                                        logError("Failed to fetch movie info for: " + temp_movie.title);
-                                    }
-                                }
-                                catch (const std::exception& e) {
-                                    logError("Exception in fetch thread: " + std::string(e.what()));
-                                }
-                                fetch_in_progress.store(false);
-                            });
+                // The row index is the ID: a search may list the same movie twice
+                int selected = session.current_selected_list == SelectedList::SearchResults ? session.selected_movie_index : -1;
+                movie_table::DrawRows(int(session.movie_list.size()), selected,
+                    [&session](int i) -> const Movie& { return *session.movie_list[i]; },
+                    [](int i) { return i; },
+                    [&session](int i, bool clicked) {
+                        // A short hover is a likely click; rows already queued are ignored without allocating
+                        if (!session.movie_list[i]->has_details && ImGui::IsItemHovered(ImGuiHoveredFlags_DelayShort)) {
+                            QueuePrefetch(session, session.movie_list[i]->id, true);
                         }
-                        catch (const std::exception& e) {
-                            logError("Exception in movie selection: " + std::string(e.what()));
+                        if (clicked) {
+                            try {
+                                session.first_run = false;
+                                session.selected_movie_index = i;
+                                session.current_selected_list = SelectedList::SearchResults;
+                                session.selected_movie = session.movie_list[i];
+                                session.image_url = session.selected_movie->poster_url;
+
+                                // Fetch detailed movie info when selected
+                                StartShowMovie(session, session.movie_list[i]);
+                            }
+                            catch (const std::exception& e) {
+                                logError("Exception in movie selection: " + std::string(e.what()));
+                            }
                         }
-                    }
-                    ImGui::TableSetColumnIndex(1);
-                    ImGui::Text("%s", movie_list[i].release_year.c_str());
-                }
+                    });
                 ImGui::EndTable();
             }
             ImGui::EndChild();
         }
-        else if (movie_not_found) {
+        else if (session.movie_not_found) {
             ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "No movies found. Please try another search.");
         }
-        else if (connection_error) {
+        else if (session.connection_error) {
             ImGui::Text("Connection error occurred. Please check your internet connection and try again.");
         }
 
@@ -812,107 +927,124 @@ int main() {
         ImGui::TextColored(ImVec4(0.7f, 0.3f, 0.7f, 1.0f), "My Watch List:");
         ImGui::SetWindowFontScale(1.0f);
         ImGui::PopFont();
+        DrawImportProgress(session);
 
-        if (current_user.empty()) {
+        if (session.current_user.empty()) {
             ImGui::TextColored(ImVec4(0.0f, 1.0f, 1.0f, 1.0f), "Log in to see your watch list");
         }
-        else if (watch_list.empty()) {
+        else if (session.watch_list.empty()) {
             ImGui::TextColored(ImVec4(0.0f, 1.0f, 1.0f, 1.0f), "No movies in your watch list");
         }
         else {
             // Create a child window for the scrollable watch list
             ImGui::BeginChild("WatchList", ImVec2(0, float(display_h) * 0.3f), true);
-            if (ImGui::BeginTable("WatchListTable", 2, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Sortable | ImGuiTableFlags_Resizable | ImGuiTableFlags_SizingStretchProp)) {
-                ImGui::TableSetupColumn("Title", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_WidthStretch, 0.7f);
-                ImGui::TableSetupColumn("Year", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_WidthStretch, 0.3f);
-                ImGui::TableHeadersRow();
-
-                if (ImGui::TableGetSortSpecs()->SpecsDirty) {
-                    ImGuiTableSortSpecs* sorts_specs = ImGui::TableGetSortSpecs();
-                    if (sorts_specs->Specs->ColumnIndex == 0) {
-                        sort_watch_list_by_year = false;
-                        sort_watch_list_ascending = sorts_specs->Specs->SortDirection == ImGuiSortDirection_Ascending;
-                    }
-                    else {
-                        sort_watch_list_by_year = true;
-                        sort_watch_list_ascending = sorts_specs->Specs->SortDirection == ImGuiSortDirection_Ascending;
-                    }
-                    sortWatchList();
-                    sorts_specs->SpecsDirty = false;
+            if (movie_table::Begin("WatchListTable")) {
+                AllocScope alloc_scope(alloc_tracker, ALLOC_SCOPE_WATCH_TABLE);
+                if (movie_table::SortRequested(session.sort_watch_list_by_year, session.sort_watch_list_ascending)) {
+                    sortWatchList(session);
                 }
 
-                for (int i = 0; i < watch_list.size(); ++i) {
-                    ImGui::TableNextRow();
-                    ImGui::TableSetColumnIndex(0);
-                    std::string selectable_label = watch_list[i].title + "##" + watch_list[i].id;
-                    if (ImGui::Selectable(selectable_label.c_str(),
-                                          current_selected_list == SelectedList::WatchList && selected_movie_index == i,
-                                          ImGuiSelectableFlags_SpanAllColumns)) {
-                        first_run = false;
-                        selected_movie_index = i;
-                        current_selected_list = SelectedList::WatchList;
-                        selected_movie = watch_list[i];
-                        image_url = selected_movie.poster_url;
-
-                        // Fetch detailed movie info when selected
-                        bool fetch_success = FetchMovieInfo(selected_movie);
-                        if (fetch_success) {
-                            // Load the image if it's not already loaded
-                            if (!image_url.empty()) {
-                                std::unique_lock<std::mutex> lock(mtx);
-                                if (textureMap.find(image_url) == textureMap.end()) {
-                                    image_queue.push(image_url);
-                                    cv.notify_one();
-                                }
-                            }
-                        }
-                        else {
-                            ImGui::Text("Failed to fetch movie details. Please try again.");
+                // The imdbID is the ID, so a row keeps its ImGui state when the list re-sorts
+                int selected = session.current_selected_list == SelectedList::WatchList ? session.selected_movie_index : -1;
+                movie_table::VisibleRows visible = movie_table::DrawRows(int(session.watch_list.size()), selected,
+                    [&session](int i) -> const Movie& { return *session.watch_list[i]; },
+                    [&session](int i) { return int(session.watch_list[i]->id); },
+                    [&session](int i, bool clicked) {
+                        if (clicked) {
+                            session.first_run = false;
+                            session.selected_movie_index = i;
+                            session.current_selected_list = SelectedList::WatchList;
+                            session.selected_movie = session.watch_list[i];
+                            session.image_url = session.selected_movie->poster_url;
+
+                            // Fetch detailed movie info when selected
+                            StartShowMovie(session, session.selected_movie);
                         }
-                    }
-                    ImGui::TableSetColumnIndex(1);
-                    ImGui::Text("%s", watch_list[i].release_year.c_str());
-                }
+                    });
+                session.watch_list_visible_first = visible.first;
+                session.watch_list_visible_last = visible.last;
                 ImGui::EndTable();
             }
             ImGui::EndChild();
         }
 
+        DrawNetworkStatus(session);
         ImGui::EndChild();
         ImGui::Columns(1);
 
         ImGui::End(); // Main content
 
+        if (ImGui::IsKeyPressed(ImGuiKey_F2, false)) {
+            show_frame_stats = !show_frame_stats;
+        }
+        if (show_frame_stats) {
+            DrawFrameStats(session);
+        }
+        if (ImGui::IsKeyPressed(ImGuiKey_F3, false)) {
+            show_profiler = !show_profiler;
+        }
+        if (show_profiler) {
+            DrawProfilerOverlay();
+        }
+
         // Rendering
         ImGui::Render();
+        frame_profiler.EndSection(SECTION_IMGUI_BUILD);
+        frame_profiler.BeginSection(SECTION_RENDER);
         glViewport(0, 0, display_w, display_h);
         glClearColor(0.45f, 0.55f, 0.60f, 1.00f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        {
+            ScopedGpuTimer gpu_timing(gpu_timer, SECTION_GPU_RENDER, frame_profiler.FrameIndex());
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
 
         glfwSwapBuffers(window);
+        frame_profiler.EndSection(SECTION_RENDER);
+        frame_profiler.EndFrame();
+        frame_pacer.EndFrame();
+
+        // A frame that only redraws an unchanged screen must not touch the heap
+        if (!alloc_tracker.EndFrame(idle_frame)) {
+            const AllocTracker::Counts& counts = alloc_tracker.LastIdleViolation();
+            std::string report = "Idle frame allocated " + std::to_string(counts.allocations) + " times ("
+                                 + std::to_string(counts.bytes) + " bytes)";
+            logError(report);
+            if (fail_on_idle_allocation) {
+                std::cerr << report << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+        }
     }
 
     glfwSetWindowSizeCallback(window, [](GLFWwindow* window, int width, int height) {
         glViewport(0, 0, width, height);
     });
 
-    // Cleanup
-    image_thread_running = false;  // Signal the image loading thread to stop
-    cv.notify_all();  // Wake up the image loading thread if it's waiting
-    if (image_thread.joinable()) {
-        image_thread.join();
-    }
-    if (fetcher_thread.joinable()) {
-        fetcher_thread.join();
-    }
-    if (fetch_thread.joinable()) {
-        fetch_thread.join();
+    // Cancel running flows and let them unwind. A flow may hop between the UI thread and background stages
+    // several times on its way out, so drain until no background stage is running and nothing is queued.
+    session.search_token.cancel();
+    session.selection_token.cancel();
+    session.import_token.cancel();
+    session.hydration_token.cancel();
+    ResumeIdleWaiters(session);
+    auto shutdown_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (true) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(shutdown_deadline - std::chrono::steady_clock::now());
+        if (!BackgroundJobs::wait_idle(std::max(remaining, std::chrono::milliseconds(0)))) {
+            std::cerr << "Background work still running at shutdown" << std::endl;
+            break;
+        }
+        // Nothing ran in the background, so only what this drains could start more
+        if (session.ui_executor.drain() == 0) break;
     }
 
-    // Clear any remaining items in the queue
-    movie_queue.clear();
+    // Make the watch list durable and fold its journal into the snapshot
+    session.watch_list_store.Close();
+    engine.omdb_quota.Save();
+
+    gpu_timer.Shutdown();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -924,17 +1056,6 @@ int main() {
     return 0;
 }
 
-std::string GetExecutablePath() {
-    char path[1024];
-    uint32_t size = sizeof(path);
-    if (_NSGetExecutablePath(path, &size) == 0) {
-        std::filesystem::path execPath(path);
-        // Go up two levels: from debug folder to the directory containing main
-        return execPath.parent_path().parent_path().string();
-    }
-    return "";
-}
-
 void CheckGLError(const char* operation) {
     GLenum error;
     while ((error = glGetError()) != GL_NO_ERROR) {
@@ -943,16 +1064,6 @@ void CheckGLError(const char* operation) {
 }
 
 
-void logError(const std::string& message) {
-    std::ofstream logFile("error_log.txt", std::ios_base::app);
-    if (logFile.is_open()) {
-        time_t now = time(nullptr);
-        char* dt = ctime(&now);
-        logFile << dt << ": " << message << std::endl;
-        logFile.close();
-    }
-}
-
 int FilterNumericInput(ImGuiInputTextCallbackData* data)
 {
     if (data->EventChar < '0' || data->EventChar > '9')
@@ -989,20 +1100,135 @@ void LoadFonts(ImGuiIO& io) {
     }
 }
 
-void ResetApplication() {
-    first_run = true;
-    movie_list.clear();
-    selected_movie = Movie();
-    image_url.clear();
-    movie_not_found = false;
-    connection_error = false;
-    selected_movie_index = -1;
-    search_in_progress.store(false);
-    movie_queue.clear();
-    memset(title_input, 0, sizeof(title_input));
-    memset(year_input, 0, sizeof(year_input));
-    std::queue<std::string> empty;
-    std::swap(image_queue, empty);
+void InstallActivityCallbacks(GLFWwindow* window) {
+    glfwSetCursorPosCallback(window, [](GLFWwindow*, double, double) { frame_pacer.NotifyInput(); });
+    glfwSetMouseButtonCallback(window, [](GLFWwindow*, int, int, int) { frame_pacer.NotifyInput(); });
+    glfwSetScrollCallback(window, [](GLFWwindow*, double, double) { frame_pacer.NotifyInput(); });
+    glfwSetKeyCallback(window, [](GLFWwindow*, int, int, int, int) { frame_pacer.NotifyInput(); });
+    glfwSetCharCallback(window, [](GLFWwindow*, unsigned int) { frame_pacer.NotifyInput(); });
+    glfwSetWindowFocusCallback(window, [](GLFWwindow*, int) { frame_pacer.NotifyInput(); });
+    glfwSetWindowIconifyCallback(window, [](GLFWwindow*, int) { frame_pacer.NotifyInput(); });
+    glfwSetFramebufferSizeCallback(window, [](GLFWwindow*, int, int) { frame_pacer.NotifyInput(); });
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow*) { frame_pacer.NotifyInput(); });
+}
+
+void DrawFrameStats(Session& session) {
+    const FramePacer::Stats& stats = frame_pacer.GetStats();
+    ImGui::SetNextWindowPos(ImVec2(10, 90), ImGuiCond_FirstUseEver);
+    ImGui::Begin("Frame Stats (F2)", &show_frame_stats, ImGuiWindowFlags_AlwaysAutoResize);
+    ImGui::Text("Frames/s: %.1f", stats.fps);
+    ImGui::Text("Wakeups/s: %.1f", stats.wakeups_per_sec);
+    ImGui::Text("Frame CPU: %.2f ms", stats.frame_ms);
+    ImGui::Text("Process CPU: %.1f%%", stats.cpu_percent);
+    ImGui::Text("Frames rendered: %lld", stats.frames);
+
+    ImGui::Separator();
+    ImGui::Text("Search arena: %zu bytes in generation %llu, %llu heap blocks", session.search_arena.BytesUsed(),
+                (unsigned long long)session.search_arena.Generation(), (unsigned long long)session.search_arena.HeapBlocks());
+    ImGui::Text("Movie records: %zu shared", session.movie_registry.Size());
+    if (!AllocTracker::Enabled()) {
+        ImGui::TextDisabled("Allocation tracking off (build with AGM_TRACK_ALLOCATIONS)");
+    }
+    else {
+        const AllocTracker::Counts& frame = alloc_tracker.LastFrame();
+        ImGui::Text("Allocations last frame: %llu (%llu bytes)",
+                    (unsigned long long)frame.allocations, (unsigned long long)frame.bytes);
+        for (int i = 0; i < alloc_tracker.ScopeCount(); ++i) {
+            const AllocTracker::Counts& scope = alloc_tracker.ScopeLastFrame(i);
+            ImGui::BulletText("%s: %llu (%llu bytes)", alloc_tracker.ScopeName(i),
+                              (unsigned long long)scope.allocations, (unsigned long long)scope.bytes);
+        }
+        ImGui::Text("Process allocations: %llu", (unsigned long long)AllocTracker::ProcessAllocations());
+        ImVec4 color = alloc_tracker.IdleFramesWithAllocations() == 0 ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f) : ImVec4(1.0f, 0.0f, 0.0f, 1.0f);
+        ImGui::TextColored(color, "Idle frames allocating: %llu of %llu",
+                           (unsigned long long)alloc_tracker.IdleFramesWithAllocations(),
+                           (unsigned long long)alloc_tracker.IdleFrames());
+    }
+
+    ImGui::Separator();
+    event_http::Client::Stats http = session.engine.http_client.GetStats();
+    ImGui::Text("HTTP: %d in flight, %d connections open", http.in_flight, http.open_connections);
+    ImGui::BulletText("requests %llu, connections opened %llu, reused %llu, timed out %llu",
+                      (unsigned long long)http.requests, (unsigned long long)http.connections_opened,
+                      (unsigned long long)http.connections_reused, (unsigned long long)http.timeouts);
+    session.engine.http_resilience.ForEachEndpoint([](const std::string& host, const RequestResilience::Stats& endpoint) {
+        ImGui::Text("%s", host.c_str());
+        ImGui::BulletText("p50 %lld ms, p95 %lld ms, p99 %lld ms (%d samples)", (long long)endpoint.p50.count(),
+                          (long long)endpoint.p95.count(), (long long)endpoint.p99.count(), endpoint.samples);
+        ImGui::BulletText("requests %llu, hedges %llu (won %llu), retries %llu, over budget %llu", endpoint.requests,
+                          endpoint.hedges, endpoint.hedge_wins, endpoint.retries, endpoint.budget_denied);
+    });
+    ImGui::End();
+}
+
+void DrawProfilerOverlay() {
+    ImGui::SetNextWindowPos(ImVec2(10, 250), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(560, 0), ImGuiCond_FirstUseEver);
+    ImGui::Begin("Frame Profiler (F3)", &show_profiler);
+    ImGui::Text("Frame %lld, last %d frames (ms)", frame_profiler.FrameIndex(), frame_profiler.CompletedFrames());
+
+    if (ImGui::BeginTable("ProfilerSections", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Section");
+        ImGui::TableSetupColumn("Last");
+        ImGui::TableSetupColumn("Avg");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p95");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableSetupColumn("Max");
+        ImGui::TableHeadersRow();
+        for (int i = 0; i < frame_profiler.SectionCount(); ++i) {
+            FrameProfiler::Summary summary = frame_profiler.Summarize(i);
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::TextUnformatted(frame_profiler.SectionName(i));
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%.2f", summary.last);
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%.2f", summary.avg);
+            ImGui::TableSetColumnIndex(3);
+            ImGui::Text("%.2f", summary.p50);
+            ImGui::TableSetColumnIndex(4);
+            ImGui::Text("%.2f", summary.p95);
+            ImGui::TableSetColumnIndex(5);
+            ImGui::Text("%.2f", summary.p99);
+            ImGui::TableSetColumnIndex(6);
+            ImGui::Text("%.2f", summary.max);
+        }
+        ImGui::EndTable();
+    }
+
+    // History plots, scaled to each section's p99 so one hitch does not flatten the rest
+    for (int i = 0; i < frame_profiler.SectionCount(); ++i) {
+        FrameProfiler::Summary summary = frame_profiler.Summarize(i);
+        ImGui::PushID(i);
+        ImGui::PlotLines(frame_profiler.SectionName(i), frame_profiler.History(i), FrameProfiler::kHistory,
+                         frame_profiler.PlotOffset(), nullptr, 0.0f, summary.p99 * 1.25f + 0.01f, ImVec2(0, 40));
+        ImGui::PopID();
+    }
+
+    if (ImGui::Button("Dump to frame_profile.json")) {
+        std::string dumpPath = GetExecutablePath() + "/frame_profile.json";
+        if (!frame_profiler.DumpJson(dumpPath)) {
+            logError("Failed to write frame profile to " + dumpPath);
+        }
+    }
+    ImGui::End();
+}
+
+void ResetApplication(Session& session) {
+    session.first_run = true;
+    ResetSearchResults(session);
+    session.selected_movie = MovieRef();
+    session.image_url.clear();
+    session.movie_not_found = false;
+    session.connection_error = false;
+    session.selected_movie_index = -1;
+    session.search_in_progress.store(false);
+    session.fetch_in_progress.store(false);
+    session.search_token.cancel();
+    session.selection_token.cancel();
+    memset(session.title_input, 0, sizeof(session.title_input));
+    memset(session.year_input, 0, sizeof(session.year_input));
 }
 
 void DrawTexturedQuad(GLuint texture_id) {
@@ -1023,146 +1249,291 @@ void DrawTexturedQuad(GLuint texture_id) {
     glfwSwapBuffers(window);
 }
 
-bool IsInWatchList(const std::string& id) {
-    return watch_list_titles.find(id) != watch_list_titles.end();
+bool IsInWatchList(Session& session, std::uint32_t id) {
+    return session.watch_list.contains(id);
 }
 
-void FetchMovieList(const std::string& title, const std::string& year) {
-    std::string encoded_title = httplib::detail::encode_url(title);
-    std::string url = "/?s=" + encoded_title + "&type=movie&apikey=" + api_key;
-
-    httplib::Client cli("https://www.omdbapi.com");
-    auto res = cli.Get(url);
+// Parses the search reply into movie_list, interning each result so a movie the watch list (or an earlier
+// search) already holds is shown with the record it has. UI thread only, like everything else that
+// touches the arena.
+void LoadSearchResults(Session& session, const HttpResponse& res, const std::string& title, const std::string& year) {
+    session.movie_list.clear();
 
-    if (!res) {
-        connection_error = true;
-        movie_queue.setFinished();
+    if (res.status == 0 || res.status == kQuotaRejectedStatus) {
+        if (res.status == kQuotaRejectedStatus) {
+            logError("OMDb quota used up for today; search for " + title + " not sent");
+        }
+        session.connection_error = true;
         return;
     }
 
-    if (res->status == 200) {
-        json response = json::parse(res->body);
-        if (response["Response"] == "True" && response.contains("Search")) {
-            for (const auto& item : response["Search"]) {
-                Movie movie;
-                movie.id = item.value("imdbID", "");
-                movie.title = item.value("Title", "Unknown");
-                movie.release_year = item.value("Year", "Unknown");
-                movie.poster_url = item.value("Poster", "");
-
-                // Apply year filter here if specified
-                if (year.empty() || movie.release_year.find(year) != std::string::npos) {
-                    movie_queue.push(movie);
-                }
+    if (res.status == 200) {
+        omdb_json::Reply reply = ParseSearchResults(res.body, [&session, &year](Movie&& movie) {
+            // Apply year filter here if specified
+            char year_text[16];
+            movie_record::FormatYear(movie.year_start, movie.year_end, year_text, sizeof(year_text));
+            if (year.empty() || std::string_view(year_text).find(year) != std::string_view::npos) {
+                session.movie_list.push_back(InternMovie(session, std::move(movie)));
             }
-            connection_error = false;
+        });
+        if (reply == omdb_json::Reply::True) {
+            session.connection_error = false;
+        }
+        else if (reply == omdb_json::Reply::Malformed) {
+            logError("Invalid search response for " + title);
+            session.movie_list.clear();
+            session.connection_error = true;
         }
         else {
             // No movies found or error in response
-            connection_error = false; // It's not a connection error, just no results
-            movie_not_found = true;
+            session.movie_list.clear();
+            session.connection_error = false; // It's not a connection error, just no results
+            session.movie_not_found = true;
         }
     }
     else {
-        connection_error = true;
+        session.connection_error = true;
     }
+}
 
-    movie_queue.setFinished();
+// Drops the current results and everything their search allocated in one step. The containers give
+// their memory back (by taking fresh empty ones) before the arena forgets it.
+void ResetSearchResults(Session& session) {
+    session.movie_list = std::pmr::vector<MovieRef>(&session.search_arena);
+    session.prefetch_queue = std::pmr::vector<std::uint32_t>(&session.search_arena);
+    session.prefetch_requested = std::pmr::vector<std::uint32_t>(&session.search_arena);
+    session.search_arena.Reset();
 }
 
-bool FetchMovieInfo(Movie& movie) { // info of a spesific movie
-    try {
-        std::string encoded_title = httplib::detail::encode_url(movie.title);
-        std::string url = "/?t=" + encoded_title + "&y=" + movie.release_year + "&apikey=" + api_key;
+// The shared record for movie's imdbID: the one some view already holds - taking movie's poster if it
+// had none - or else movie itself.
+MovieRef InternMovie(Session& session, Movie movie) {
+    MovieRef existing = session.movie_registry.Find(movie.id);
+    if (!existing) {
+        return session.movie_registry.Publish(std::move(movie));
+    }
+    if (existing->poster_url.empty() && !movie.poster_url.empty()) {
+        Movie merged = *existing;
+        merged.poster_url = std::move(movie.poster_url);
+        session.movie_registry.Publish(std::move(merged)); // not a sort key, so no view has to move it
+    }
+    return existing;
+}
 
-        httplib::Client cli("https://www.omdbapi.com");
-        auto res = cli.Get(url);
+// Publishes the details looked up for the movie known as id, once, for every view: the watch list and
+// the search results move the entry to where its full title and year sort, and the selection keeps
+// pointing at its row. A lookup that resolved another imdbID replaces id wherever it was shown.
+MovieRef UpdateMovie(Session& session, std::uint32_t id, Movie detailed) {
+    std::uint32_t new_id = detailed.id;
+    MovieRef updated;
+    auto publish = [&](const MovieRef&) { updated = session.movie_registry.Publish(std::move(detailed)); };
+    if (!session.watch_list.update(new_id, publish)) {
+        publish(updated);
+    }
+    if (new_id != id) {
+        session.watch_list.replace(id, updated);
+        std::replace_if(session.movie_list.begin(), session.movie_list.end(), [id](const MovieRef& m) { return m->id == id; }, updated);
+        if (session.selected_movie->id == id) {
+            session.selected_movie = updated;
+        }
+    }
 
-        if (!res) {
-            logError("Connection error in FetchMovieInfo for movie: " + movie.title);
-            connection_error = true;
-            return false;
-        }
-
-        if (res->status == 200) {
-            json response = json::parse(res->body);
-            if (response["Response"] == "True") {
-                movie.title = response.value("Title", movie.title);
-                movie.producer = response.value("Director", "Unknown");
-                movie.release_year = response.value("Year", movie.release_year);
-                movie.runtime = response.value("Runtime", "Unknown");
-                movie.rating = response.value("imdbRating", "N/A");
-                movie.votes = response.value("imdbVotes", "N/A");
-                movie.id = response.value("imdbID", "");
-
-                // Handle Genre
-                movie.genres.clear();
-                std::string genre_str = response.value("Genre", "");
-                std::istringstream ss(genre_str);
-                std::string genre;
-                while (std::getline(ss, genre, ',')) {
-                    movie.genres.push_back(genre);
-                }
+    // One entry is moved into place; a search that lists the movie twice is rare enough to re-sort
+    auto shown = std::count(session.movie_list.begin(), session.movie_list.end(), updated);
+    if (shown == 1) {
+        auto it = std::find(session.movie_list.begin(), session.movie_list.end(), updated);
+        movie_sort::Reposition(session.movie_list, session.movie_list_sort, std::size_t(it - session.movie_list.begin()));
+    }
+    else if (shown > 1) {
+        session.movie_list_sort.sorted = false;
+    }
+    sortMovieList(session); // both keep the selected row pointing at the selected movie
+    sortWatchList(session);
+    return updated;
+}
 
-                // Handle Cast
-                movie.cast.clear();
-                std::string cast_str = response.value("Actors", "");
-                std::istringstream cast_ss(cast_str);
-                std::string actor;
-                while (std::getline(cast_ss, actor, ',')) {
-                    movie.cast.push_back(actor);
-                }
+task<FetchOutcome> FetchMovieInfo(Engine& engine, Movie& movie, CancelToken token) { // info of a spesific movie
+    FetchOutcome outcome;
+    try {
+        // By imdbID when known: exact, and the same URL the background lookups use, so they coalesce
+        std::string query;
+        if (movie.id != 0) {
+            query = "i=" + movie_record::ImdbIdString(movie.id);
+        }
+        else {
+            std::string encoded_title = httplib::detail::encode_url(movie.title);
+            std::string year = movie.year_start != 0 ? std::to_string(movie.year_start) : "";
+            query = "t=" + encoded_title + "&y=" + year;
+        }
 
-                // Handle Poster
-                if (response.contains("Poster") && response["Poster"] != "N/A") {
-                    image_url = response["Poster"].get<std::string>();
-                    movie.poster_url = image_url;
-                }
-                else {
-                    image_url = "";
-                    movie.poster_url = "";
-                }
+        HttpResponse res = co_await AsyncOmdbGet(engine, query, QuotaManager::Priority::Interactive, token);
+        if (token.cancelled()) {
+            co_return outcome;
+        }
 
-                connection_error = false;
-                return true;
+        if (res.status == 0) {
+            logError("Connection error in FetchMovieInfo for movie: " + movie.title);
+            outcome.connection_error = true;
+            co_return outcome;
+        }
+
+        if (res.status == 200) {
+            if (ParseMovieDetails(res.body, movie) == omdb_json::Reply::True) {
+                outcome.fetched = true;
+                outcome.image_url = movie.poster_url;
+                co_return outcome;
             }
             else {
                 logError("API returned false response for movie: " + movie.title);
             }
         }
         else {
-            logError("API returned non-200 status for movie: " + movie.title + ". Status: " + std::to_string(res->status));
+            logError("API returned non-200 status for movie: " + movie.title + ". Status: " + std::to_string(res.status));
         }
     }
     catch (const std::exception& e) {
         logError("Exception in FetchMovieInfo for movie: " + movie.title + ". Error: " + e.what());
     }
+    co_return outcome;
+}
 
-    connection_error = false;
-    return false;
+task<ImageData> AsyncDecodeImage(std::string body) {
+    co_return co_await RunInBackground([body = std::move(body)] {
+        ImageData image;
+        image.data = stbi_load_from_memory(reinterpret_cast<const unsigned char*>(body.data()), (int)body.size(),
+                                           &image.width, &image.height, &image.channels, 0);
+        if (image.data == nullptr) {
+            std::cerr << "Failed to decode image: " << stbi_failure_reason() << std::endl;
+            image.state = ImageState::Error;
+        }
+        else {
+            image.state = ImageState::Loaded;
+        }
+        return image;
+    });
 }
 
-void FetchMovieInfoThread(const Movie& movie, int index) { // when removing a movie from watch list, fetches the next one
-    Movie temp_movie = movie;
-    bool fetch_success = FetchMovieInfo(temp_movie);
-    if (fetch_success) {
-        std::lock_guard<std::mutex> lock(mtx);
-        selected_movie = temp_movie;
-        if (index >= 0 && index < watch_list.size()) {
-            watch_list[index] = temp_movie;
-        }
-        // Load the image if it's not already loaded
-        if (!temp_movie.poster_url.empty()) {
-            if (textureMap.find(temp_movie.poster_url) == textureMap.end()) {
-                image_queue.push(temp_movie.poster_url);
-                cv.notify_one();
-            }
+task<void> SearchFlow(Session& session, std::string title, std::string year, CancelToken token) {
+    try {
+        HttpResponse res = co_await AsyncOmdbGet(session.engine, SearchQuery(title), QuotaManager::Priority::Interactive,
+                                                 token);
+        co_await session.ui_executor.schedule();
+        token.throw_if_cancelled();
+
+        LoadSearchResults(session, res, title, year);
+        session.movie_list_sort.sorted = false;
+        sortMovieList(session); // results arrive in API order; apply the table's current sort once
+        session.search_in_progress.store(false);
+        if (session.movie_list.empty()) {
+            session.movie_not_found = true;
+            co_return;
         }
+        session.first_run = false;
+
+        StartPrefetch(session);
+
+        if (session.movie_list.size() == 1) {
+            // Automatically select and display the movie if it's the only one in the list
+            session.selected_movie_index = 0;
+            session.current_selected_list = SelectedList::SearchResults;
+            session.selected_movie = session.movie_list[0];
+            session.image_url.clear();
+
+            session.selection_token.cancel();
+            session.selection_token = CancelToken();
+            session.fetch_in_progress.store(true);
+            co_await ShowMovieFlow(session, session.movie_list[0], session.selection_token);
+        }
+    }
+    catch (const TaskCancelled&) {
+    }
+    catch (const std::exception& e) {
+        logError("Exception in search flow: " + std::string(e.what()));
+        session.search_in_progress.store(false);
+    }
+}
+
+task<void> ShowMovieFlow(Session& session, MovieRef shown, CancelToken token) {
+    try {
+        if (shown->has_details) {
+            // Hydrated in the background (or fetched earlier): only the poster may still be missing
+            session.fetch_in_progress.store(false);
+            co_await LoadPosterFlow(session, shown->poster_url, token);
+            co_return;
+        }
+
+        // The lookup works on a copy; the shared record only changes once the details are published
+        Movie detailed = *shown;
+        FetchOutcome outcome = co_await FetchMovieInfo(session.engine, detailed, token);
+        co_await session.ui_executor.schedule();
+        token.throw_if_cancelled();
+        session.fetch_in_progress.store(false);
+        session.connection_error = outcome.connection_error;
+
+        if (!outcome.fetched) {
+            logError("Failed to fetch movie info for: " + shown->title);
+            co_return;
+        }
+        session.image_url = outcome.image_url;
+
+        MovieRef updated = UpdateMovie(session, shown->id, std::move(detailed));
+        co_await LoadPosterFlow(session, updated->poster_url, token);
+    }
+    catch (const TaskCancelled&) {
+    }
+    catch (const std::exception& e) {
+        logError("Exception in fetch flow: " + std::string(e.what()));
+        session.fetch_in_progress.store(false);
+    }
+}
+
+task<void> LoadPosterFlow(Session& session, std::string url, CancelToken token) {
+    if (url.empty() || url == "N/A") co_return;
+    token.throw_if_cancelled();
+    {
+        std::lock_guard<std::mutex> lock(session.mtx);
+        auto it = session.textureMap.find(url);
+        if (it != session.textureMap.end() && it->second.state != ImageState::NotLoaded) co_return;
+        session.textureMap[url] = { nullptr, 0, 0, 0, 0, ImageState::Loading };
+    }
+
+    auto [host, path] = SplitUrl(url);
+    HttpResponse res = co_await AsyncHttpGet(session.engine, host, path, PosterHeaders(), token);
+    if (res.status == 0 && token.cancelled()) {
+        // Stopped waiting on a download someone else started; that caller publishes the poster
+        co_await session.ui_executor.schedule();
+        std::lock_guard<std::mutex> lock(session.mtx);
+        auto it = session.textureMap.find(url);
+        if (it != session.textureMap.end() && it->second.state == ImageState::Loading && it->second.data == nullptr) {
+            session.textureMap.erase(it);
+        }
+        co_return;
+    }
+    ImageData image;
+    if (res.status == 200) {
+        image = co_await AsyncDecodeImage(std::move(res.body));
     }
     else {
-        logError("Failed to fetch movie info for: " + temp_movie.title);
+        std::cerr << "Failed to download image from URL: " << url << ". Status: " << res.status << std::endl;
+        image.state = ImageState::Error;
+    }
+
+    // Publish even if cancelled meanwhile: the download is done and the entry must not stay in Loading
+    co_await session.ui_executor.schedule();
+    {
+        std::lock_guard<std::mutex> lock(session.mtx);
+        session.textureMap[url] = image;
+    }
+    if (image.state == ImageState::Loaded) {
+        CreateTexture(session, url);
     }
-    fetch_in_progress.store(false);
+}
+
+void StartShowMovie(Session& session, const MovieRef& movie) {
+    session.selection_token.cancel();
+    session.selection_token = CancelToken();
+    session.fetch_in_progress.store(true);
+    spawn(ShowMovieFlow(session, movie, session.selection_token));
 }
 
 void error_callback(int error, const char* description)
@@ -1240,13 +1611,13 @@ void CleanupOnError(ImageData& imageData) {
     imageData.state = ImageState::Error;
 }
 
-bool CreateTexture(const std::string& url) {
+bool CreateTexture(Session& session, const std::string& url) {
     const int MAX_RETRIES = 3;
     for (int retry = 0; retry < MAX_RETRIES; ++retry) {
         try {
-            std::lock_guard<std::mutex> lock(mtx);
-            auto it = textureMap.find(url);
-            if (it == textureMap.end()) {
+            std::lock_guard<std::mutex> lock(session.mtx);
+            auto it = session.textureMap.find(url);
+            if (it == session.textureMap.end()) {
                 std::cerr << "Image data not found for URL: " << url << std::endl;
                 return false;
             }
@@ -1281,8 +1652,12 @@ bool CreateTexture(const std::string& url) {
                 GLenum internalFormat = (imageData.channels == 4) ? GL_RGBA : GL_RGB;
                 GLenum format = (imageData.channels == 4) ? GL_RGBA : GL_RGB;
 
-                glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, imageData.width, imageData.height, 0,
-                             format, GL_UNSIGNED_BYTE, imageData.data);
+                {
+                    ScopedTimer timer(frame_profiler, SECTION_TEXTURE_UPLOAD);
+                    ScopedGpuTimer gpu_timing(gpu_timer, SECTION_GPU_TEXTURE_UPLOAD, frame_profiler.FrameIndex());
+                    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, imageData.width, imageData.height, 0,
+                                 format, GL_UNSIGNED_BYTE, imageData.data);
+                }
                 CheckGLError("glTexImage2D");
 
                 imageData.state = ImageState::Loaded;
@@ -1305,32 +1680,23 @@ bool CreateTexture(const std::string& url) {
     return false;
 }
 
-void EnsureImageLoaded(const std::string& url) {
-    if (url.empty()) return;
-
-    std::lock_guard<std::mutex> lock(mtx);
-    auto it = textureMap.find(url);
-    if (it == textureMap.end() || it->second.state == ImageState::NotLoaded) {
-        // Image not loaded, start loading
-        textureMap[url] = { nullptr, 0, 0, 0, 0, ImageState::Loading };
-        image_queue.push(url);
-        cv.notify_one();
-    }
-}
-
-void DisplayMoviePoster(const std::string& poster_url, float image_width, float image_height) {
+void DisplayMoviePoster(Session& session, std::string_view poster_url, float image_width, float image_height) {
     static const std::thread::id main_thread_id = std::this_thread::get_id();
 
-    if (!poster_url.empty()) {
-        EnsureImageLoaded(poster_url);
-        auto it = textureMap.find(poster_url);
-        if (it != textureMap.end()) {
+    if (!poster_url.empty() && poster_url != "N/A") {
+        auto it = session.textureMap.find(poster_url);
+        if (it == session.textureMap.end() && !session.selection_token.cancelled()) {
+            // Not requested by the flow that showed this movie (e.g. its details fetch failed): load it now
+            spawn(LoadPosterFlow(session, std::string(poster_url), session.selection_token));
+            it = session.textureMap.find(poster_url);
+        }
+        if (it != session.textureMap.end()) {
             switch (it->second.state) {
                 case ImageState::Loaded:
                     if (it->second.texture_id == 0) {
                         if (std::this_thread::get_id() == main_thread_id) {
                             InitializeOpenGL();
-                            CreateTexture(poster_url);
+                            CreateTexture(session, std::string(poster_url));
                         } else {
                             std::cerr << "Attempting to create texture from non-main thread" << std::endl;
                         }
@@ -1399,169 +1765,400 @@ GLuint LoadWelcomeImage(const char* filename)
     return texture_id;
 }
 
-void LoadImageFromUrl(const std::string& url) {
-    if (url.empty()) {
-        std::cerr << "Empty URL provided to LoadImageFromUrl" << std::endl;
-        return;
+void AddToWatchList(Session& session, const MovieRef& movie) {
+    if (session.watch_list.insert(movie) && !session.current_user.empty()) {
+        char year_text[16];
+        movie_record::FormatYear(movie->year_start, movie->year_end, year_text, sizeof(year_text));
+        session.watch_list_store.AppendAdd({ movie_record::ImdbIdString(movie->id), movie->title, year_text });
     }
+}
 
-    httplib::SSLClient cli("m.media-amazon.com");
-    cli.set_follow_location(true);
-    cli.set_connection_timeout(10);
-    cli.set_read_timeout(10);
-
-    httplib::Headers headers = {
-            {"User-Agent", "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/91.0.4472.124 Safari/537.36"}
-    };
-
-    std::string path = url.substr(url.find("/images"));
-
-    auto res = cli.Get(path, headers);
-    if (res && res->status == 200) {
-        int width, height, channels;
-        unsigned char* data = stbi_load_from_memory(
-                reinterpret_cast<const unsigned char*>(res->body.c_str()),
-                (int)res->body.size(), &width, &height, &channels, 0
-        );
+std::pair<bool, int> RemoveFromWatchList(Session& session, std::uint32_t id) {
+    std::size_t removed_row = session.watch_list.row_of(id);
+    if (removed_row == WatchList::npos) {
+        return { false, -1 };  // The movie is not in the watch list, so we can't remove it
+    }
 
-        if (data == nullptr) {
-            std::cerr << "Failed to load image from " << url << ": " << stbi_failure_reason() << std::endl;
-            return;
-        }
+    session.watch_list.erase(id);
+    if (!session.current_user.empty()) {
+        session.watch_list_store.AppendRemove(movie_record::ImdbIdString(id));
+    }
 
+    // The row below takes the removed one's place; clamp when the last row was removed
+    std::size_t new_index = removed_row;
+    if (new_index >= session.watch_list.size()) {
+        new_index = session.watch_list.size() - 1;
+    }
+    return { true, int(new_index) };
+}
 
+void LoadWatchList(Session& session, const std::string& username) {
+    session.watch_list.clear();
+    std::string exePath = GetExecutablePath();
 
-        std::unique_lock<std::mutex> lock(mtx);
-        textureMap[url] = { data, width, height, channels, 0, ImageState::Loaded };
-        glfwPostEmptyEvent();
+    std::string userDirPath = exePath + "/" + USER_DIRECTORY;
+    // Snapshot plus any journaled edits that were not compacted yet. Movies are built straight from
+    // the parsed records and handed to the watch list in one batch, so its sorted views are built once.
+    // A movie the current search shows already keeps its record (and any details it has).
+    std::vector<MovieRef> movies;
+    session.watch_list_store.Open(fs::path(userDirPath), username, [&session, &movies](const WatchListStore::Record& entry) {
+        Movie movie;
+        movie.id = movie_record::ParseImdbId(entry.id);
+        movie.title = entry.title;
+        movie_record::ParseYear(entry.year, movie.year_start, movie.year_end);
+        movie_sort::ComputeSortKeys(movie);
+        movies.push_back(InternMovie(session, std::move(movie)));
+    });
+    session.watch_list.assign(std::move(movies));
 
-    }
-    else {
-        std::cerr << "Failed to download image from URL: " << url << ". Status: " << (res ? res->status : 0) << std::endl;
-        std::lock_guard<std::mutex> lock(mtx);
-        textureMap[url] = { nullptr, 0, 0, 0, 0, ImageState::Error };
-    }
+    session.hydration_pending.clear();
+    session.watch_list.for_each([&session](const MovieRef& movie) {
+        if (!movie->has_details) session.hydration_pending.push_back(movie->id);
+    });
 }
 
-void ImageLoadingThread() {
-    while (image_thread_running) {
-        std::unique_lock<std::mutex> lock(mtx);
-        if (cv.wait_for(lock, std::chrono::seconds(1), [] { return !image_queue.empty() || !image_thread_running; })) {
-            if (!image_thread_running) break;
-            std::string url = image_queue.front();
-            image_queue.pop();
-            lock.unlock();
-
-            if (!url.empty() && url != "N/A") {
-                try {
-                    LoadImageFromUrl(url);
-                }
-                catch (const std::exception& e) {
-                    std::cerr << "Exception in LoadImageFromUrl: " << e.what() << std::endl;
-                }
-                catch (...) {
-                    std::cerr << "Unknown exception in LoadImageFromUrl" << std::endl;
-                }
+task<void> ImportFlow(Session& session, std::string path, CancelToken token) {
+    try {
+        std::vector<watch_list_import::Item> items = co_await RunInBackground([path] {
+            return watch_list_import::ParseFile(path);
+        });
+        co_await session.ui_executor.schedule();
+        token.throw_if_cancelled();
+
+        // Drop entries the list already has, and repeats within the file, before spending requests on them
+        std::vector<watch_list_import::Item> pending;
+        std::unordered_set<std::string> seen;
+        for (auto& item : items) {
+            std::string key = item.id.empty() ? "title:" + item.title + "|" + item.year : item.id;
+            bool known = !item.id.empty() && IsInWatchList(session, movie_record::ParseImdbId(item.id));
+            if (known || !seen.insert(std::move(key)).second) {
+                ++session.import_progress.duplicates;
+                continue;
             }
-            else {
-                std::cerr << "Empty URL in image queue" << std::endl;
+            pending.push_back(std::move(item));
+        }
+        session.import_progress.total = int(pending.size());
+
+        // The import was asked for, so it goes in as interactive, but it may spend at most half of what is
+        // left of today's quota
+        ImportOptions options;
+        options.concurrency = kImportConcurrency;
+        options.requests_per_second = kImportRequestsPerSecond;
+        options.quota_share = 0.5;
+        std::vector<ImportResult> resolved = co_await RunInBackground([&session, pending = std::move(pending), token, options] {
+            return ResolveImportItems(session.engine, pending, token, session.import_progress, options);
+        });
+        co_await session.ui_executor.schedule();
+        token.throw_if_cancelled();
+
+        // Titles may have resolved to movies the list already has; the rest goes in as one batch
+        std::vector<MovieRef> batch;
+        std::vector<WatchListStore::Entry> entries;
+        std::unordered_set<std::uint32_t> added;
+        for (ImportResult& resolution : resolved) {
+            if (resolution.result != LookupResult::Found) continue;
+            Movie& movie = resolution.movie;
+            if (IsInWatchList(session, movie.id) || !added.insert(movie.id).second) {
+                ++session.import_progress.duplicates;
+                continue;
             }
+            char year_text[16];
+            movie_record::FormatYear(movie.year_start, movie.year_end, year_text, sizeof(year_text));
+            entries.push_back({ movie_record::ImdbIdString(movie.id), movie.title, year_text });
+            batch.push_back(movie.has_details ? UpdateMovie(session, movie.id, std::move(movie)) : InternMovie(session, std::move(movie)));
+        }
+        std::vector<std::uint32_t> bare; // taken from the file as they were; hydrated like the rest of the list
+        for (const MovieRef& movie : batch) {
+            if (!movie->has_details) bare.push_back(movie->id);
+        }
+        session.import_progress.added = int(session.watch_list.append(std::move(batch)));
+        QueueHydration(session, bare);
+        session.watch_list_store.AppendAdds(entries);
+        sortWatchList(session); // keeps the selected row pointing at the selected movie
+
+        session.import_status = "Imported " + std::to_string(session.import_progress.added.load()) + " movies";
+        if (items.empty()) {
+            session.import_status = "Nothing to import from " + path;
+        }
+        if (int duplicates = session.import_progress.duplicates.load()) {
+            session.import_status += ", " + std::to_string(duplicates) + " already in the list";
         }
+        if (int not_found = session.import_progress.not_found.load()) {
+            session.import_status += ", " + std::to_string(not_found) + " not found";
+        }
+        if (int failed = session.import_progress.failed.load()) {
+            session.import_status += ", " + std::to_string(failed) + " failed";
+        }
+        if (int deferred = session.import_progress.deferred.load()) {
+            session.import_status += ", " + std::to_string(deferred) + " skipped (request quota reached)";
+        }
+    }
+    catch (const TaskCancelled&) {
     }
+    catch (const std::exception& e) {
+        logError("Exception in import flow: " + std::string(e.what()));
+        session.import_status = "Import failed";
+    }
+    session.import_progress.running = false;
 }
 
-void SaveWatchList() {
-    if (current_user.empty()) return;
-    std::string exePath = GetExecutablePath();
-    std::string userDirPath = exePath + "/" + USER_DIRECTORY;
-    fs::path user_file = fs::path(userDirPath) / (current_user + ".txt");
-    std::ofstream file(user_file);
-    if (file.is_open()) {
-        for (const auto& movie : watch_list) {
-            file << movie.id << "|" << movie.title << "|" << movie.release_year << "\n";
+void StartImport(Session& session, const std::string& path) {
+    if (session.import_progress.running.load() || session.current_user.empty()) return;
+    session.import_token.cancel();
+    session.import_token = CancelToken();
+    session.import_progress.Reset();
+    session.import_progress.running = true;
+    session.import_status.clear();
+    spawn(ImportFlow(session, path, session.import_token));
+}
+
+void DrawImportProgress(Session& session) {
+    if (session.import_progress.running.load()) {
+        int total = session.import_progress.total.load();
+        int processed = session.import_progress.processed.load();
+        char overlay[64];
+        std::snprintf(overlay, sizeof(overlay), "Importing %d/%d", processed, total);
+        ImGui::ProgressBar(total > 0 ? float(processed) / float(total) : 0.0f, ImVec2(-1.0f, 0.0f), overlay);
+    }
+    else if (!session.import_status.empty()) {
+        ImGui::TextUnformatted(session.import_status.c_str());
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Dismiss")) {
+            session.import_status.clear();
         }
-        file.close();
     }
 }
 
-void AddToWatchList(const Movie& movie) {
-    if (watch_list_titles.find(movie.id) == watch_list_titles.end()) {
-        Movie watch_list_movie = movie;
-        watch_list_movie.in_watch_list = true;
-        watch_list.push_back(watch_list_movie);
-        watch_list_titles.insert(movie.id);
-        if (!current_user.empty()) {
-            SaveWatchList();
+// Picks the next entry to hydrate on the UI thread. Rows on screen come first - a missing poster there is
+// worth fetching too - then the rest of the list in load order, details only.
+bool NextHydrationCandidate(Session& session, Movie& movie, bool& needs_details) {
+    int last = std::min(session.watch_list_visible_last, int(session.watch_list.size()));
+    for (int row = std::max(session.watch_list_visible_first, 0); row < last; ++row) {
+        const Movie& entry = *session.watch_list[row];
+        if (session.hydration_skipped.count(entry.id)) continue;
+        if (!entry.has_details) {
+            movie = entry;
+            needs_details = true;
+            return true;
         }
-        if (selected_movie.id == movie.id) {
-            selected_movie.in_watch_list = true;
+        // A poster that could not be loaded (or an "N/A" kept from an older snapshot) leaves no texture
+        // entry behind, so what was tried is remembered separately
+        if (!entry.poster_url.empty() && !session.hydration_posters.count(entry.id)) {
+            std::lock_guard<std::mutex> lock(session.mtx);
+            if (session.textureMap.find(entry.poster_url) == session.textureMap.end()) {
+                movie = entry;
+                needs_details = false;
+                return true;
+            }
+        }
+    }
+    while (!session.hydration_pending.empty()) {
+        std::uint32_t id = session.hydration_pending.front();
+        session.hydration_pending.pop_front();
+        const MovieRef* entry = session.watch_list.find(id);
+        if (entry != nullptr && !(*entry)->has_details && !session.hydration_skipped.count(id)) {
+            movie = **entry;
+            needs_details = true;
+            return true;
         }
     }
+    return false;
 }
 
-std::pair<bool, int> RemoveFromWatchList(const std::string& id) {
-    if (!IsInWatchList(id)) {
-        return { false, -1 };  // The movie is not in the watch list, so we can't remove it
+// Low-priority prefetch of the watch list's details and on-screen posters. Each lookup waits until no
+// search, selection or import is in flight, is spaced to kHydrationRequestsPerSecond and goes in at
+// background priority; the flow stops after kHydrationRequestBudget lookups or when the quota turns it away.
+task<void> HydrationFlow(Session& session, CancelToken token) {
+    try {
+        int budget = kHydrationRequestBudget;
+        auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / kHydrationRequestsPerSecond));
+        auto next_request = std::chrono::steady_clock::now();
+
+        Movie movie;
+        bool needs_details = false;
+        while (NextHydrationCandidate(session, movie, needs_details)) {
+            if (needs_details) {
+                if (budget-- <= 0) break;
+                co_await WaitForIdleNetwork(session, next_request, token);
+                token.throw_if_cancelled();
+                auto [result, detailed] = co_await AsyncRequestMovieDetails(
+                    session.engine, "i=" + movie_record::ImdbIdString(movie.id), QuotaManager::Priority::Background, movie, token);
+                co_await session.ui_executor.schedule();
+                token.throw_if_cancelled();
+                next_request = std::chrono::steady_clock::now() + interval;
+
+                if (result == LookupResult::QuotaExceeded) break;
+                if (result != LookupResult::Found || detailed.id != movie.id) {
+                    session.hydration_skipped.insert(movie.id);
+                    continue;
+                }
+                movie = *UpdateMovie(session, movie.id, std::move(detailed));
+            }
+
+            // Posters only for rows on screen: every decoded poster is a texture that stays resident
+            int row = int(session.watch_list.row_of(movie.id));
+            if (row >= session.watch_list_visible_first && row < session.watch_list_visible_last) {
+                session.hydration_posters.insert(movie.id);
+                co_await LoadPosterFlow(session, movie.poster_url, token);
+            }
+        }
     }
+    catch (const TaskCancelled&) {
+    }
+    catch (const std::exception& e) {
+        logError("Exception in hydration flow: " + std::string(e.what()));
+    }
+    // A cancelled flow was already replaced by StopHydration; a newer one may own the flag by now
+    if (!token.cancelled()) {
+        session.hydration_running = false;
+    }
+}
 
-    auto it = std::find_if(watch_list.begin(), watch_list.end(),
-                           [&id](const Movie& movie) { return movie.id == id; });
+void QueueHydration(Session& session, const std::vector<std::uint32_t>& ids) {
+    if (ids.empty()) return;
+    session.hydration_pending.insert(session.hydration_pending.end(), ids.begin(), ids.end());
+    StartHydration(session);
+}
 
-    if (it != watch_list.end()) {
-        auto removed_index = static_cast<std::size_t>(std::distance(watch_list.begin(), it));
-        watch_list.erase(it);
-        watch_list_titles.erase(id);
+void StartHydration(Session& session) {
+    if (session.hydration_running || session.current_user.empty() || session.engine.omdb_quota.Empty()) return;
+    session.hydration_token = CancelToken();
+    session.hydration_running = true;
+    spawn(HydrationFlow(session, session.hydration_token));
+}
 
-        // Update the in_watch_list status for all movies in movie_list
-        for (auto& movie : movie_list) {
-            if (movie.id == id) {
-                movie.in_watch_list = false;
-            }
-        }
+void StopHydration(Session& session) {
+    session.hydration_token.cancel();
+    session.hydration_running = false;
+    session.hydration_pending.clear();
+    session.hydration_skipped.clear();
+    session.hydration_posters.clear();
+}
 
-        if (!current_user.empty()) {
-            SaveWatchList();
-        }
+// A search, selection or import is in flight
+bool NetworkBusy(const Session& session) {
+    return session.search_in_progress.load() || session.fetch_in_progress.load() || session.import_progress.running.load();
+}
 
-        // Determine the new selected index
-        std::size_t new_index = removed_index;
-        if (new_index >= watch_list.size()) {
-            new_index = watch_list.size() - 1;
-        }
+// UI-thread wait for the speculative flows: co_await resumes on the UI thread once the network is not busy
+// and not_before has passed, or once token is cancelled - check it afterwards. No thread waits meanwhile:
+// the flow is parked in idle_waiters, and a timer on the engine wakes the main loop at not_before.
+IdleNetworkAwaiter WaitForIdleNetwork(Session& session, std::chrono::steady_clock::time_point not_before, CancelToken token) {
+    return IdleNetworkAwaiter{ session, not_before, std::move(token) };
+}
+
+bool IdleNetworkAwaiter::await_ready() const {
+    return token.cancelled() || (!NetworkBusy(session) && std::chrono::steady_clock::now() >= not_before);
+}
 
-        return { true, new_index };
+void IdleNetworkAwaiter::await_suspend(std::coroutine_handle<> h) {
+    IdleWaiter waiter{ h, not_before, token };
+    auto now = std::chrono::steady_clock::now();
+    if (not_before > now) {
+        waiter.timer = session.engine.http_client.After(
+            std::chrono::ceil<std::chrono::milliseconds>(not_before - now), [] { glfwPostEmptyEvent(); });
     }
-    return { false, -1 };
+    session.idle_waiters.push_back(std::move(waiter));
 }
 
-void LoadWatchList(const std::string& username) {
-    watch_list.clear();
-    watch_list_titles.clear();
-    std::string exePath = GetExecutablePath();
+// Every flag NetworkBusy reads is cleared on the UI thread, in a drained flow or the frame, so the main
+// loop calls this before it waits for events, and at shutdown once the tokens are cancelled. Waiters that
+// may go (or were cancelled) are handed to the UI executor; the rest stay parked, in place, so an idle
+// frame does not allocate.
+void ResumeIdleWaiters(Session& session) {
+    if (session.idle_waiters.empty()) return;
+    bool busy = NetworkBusy(session);
+    auto now = std::chrono::steady_clock::now();
+    auto parked = session.idle_waiters.begin();
+    for (IdleWaiter& waiter : session.idle_waiters) {
+        if (waiter.token.cancelled() || (!busy && now >= waiter.not_before)) {
+            if (waiter.timer != 0) session.engine.http_client.Cancel(waiter.timer);
+            session.ui_executor.post(waiter.handle);
+        }
+        else {
+            if (&*parked != &waiter) *parked = std::move(waiter);
+            ++parked;
+        }
+    }
+    session.idle_waiters.erase(parked, session.idle_waiters.end());
+}
 
-    std::string userDirPath = exePath + "/" + USER_DIRECTORY;
-    fs::path user_file = fs::path(userDirPath) / (username + ".txt");
-    std::ifstream file(user_file);
-    if (file.is_open()) {
-        std::string line;
-        while (std::getline(file, line)) {
-            std::istringstream iss(line);
-            std::string id, title, year;
-            if (std::getline(iss, id, '|') && std::getline(iss, title, '|') && std::getline(iss, year)) {
-                Movie movie;
-                movie.id = id;
-                movie.title = title;
-                movie.release_year = year;
-                movie.in_watch_list = true;
-                watch_list.push_back(movie);
-                watch_list_titles.insert(id);
-            }
+// Fetches details, then the poster, for queued search results so a click finds them ready. Runs under the
+// search token, so a new search (or a reset) stops it. Lookups are speculative: the quota manager sheds
+// them first and caps them at prefetch_quota_share of the day.
+task<void> PrefetchFlow(Session& session, CancelToken token) {
+    try {
+        auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / kPrefetchRequestsPerSecond));
+        auto next_request = std::chrono::steady_clock::now();
+
+        while (!session.prefetch_queue.empty()) {
+            std::uint32_t id = session.prefetch_queue.front();
+            session.prefetch_queue.erase(session.prefetch_queue.begin());
+            auto it = std::find_if(session.movie_list.begin(), session.movie_list.end(), [id](const MovieRef& m) { return m->id == id; });
+            if (it == session.movie_list.end() || (*it)->has_details) continue;
+
+            // A copy: the list may change while this waits
+            Movie movie = **it;
+            co_await WaitForIdleNetwork(session, next_request, token);
+            token.throw_if_cancelled();
+            auto [result, detailed] = co_await AsyncRequestMovieDetails(
+                session.engine, "i=" + movie_record::ImdbIdString(id), QuotaManager::Priority::Speculative, movie, token);
+            co_await session.ui_executor.schedule();
+            token.throw_if_cancelled();
+            next_request = std::chrono::steady_clock::now() + interval;
+
+            if (result == LookupResult::QuotaExceeded) break;
+            if (result != LookupResult::Found || detailed.id != id) continue;
+
+            MovieRef updated = UpdateMovie(session, id, std::move(detailed));
+            co_await LoadPosterFlow(session, updated->poster_url, token);
         }
-        file.close();
+    }
+    catch (const TaskCancelled&) {
+    }
+    catch (const std::exception& e) {
+        logError("Exception in prefetch flow: " + std::string(e.what()));
+    }
+    // A cancelled flow was superseded by the next search's
+    if (!token.cancelled()) {
+        session.prefetch_running = false;
     }
 }
 
-bool UserLogin(const std::string& username) {
+// urgent ids (the hovered row) go ahead of the top results still waiting
+void QueuePrefetch(Session& session, std::uint32_t id, bool urgent) {
+    if (id == 0 || session.search_token.cancelled() ||
+        std::find(session.prefetch_requested.begin(), session.prefetch_requested.end(), id) != session.prefetch_requested.end()) {
+        return;
+    }
+    session.prefetch_requested.push_back(id);
+    if (urgent) {
+        session.prefetch_queue.insert(session.prefetch_queue.begin(), id);
+    }
+    else {
+        session.prefetch_queue.push_back(id);
+    }
+    if (!session.prefetch_running && !session.engine.omdb_quota.Empty()) {
+        session.prefetch_running = true;
+        spawn(PrefetchFlow(session, session.search_token));
+    }
+}
+
+// Called with fresh search results: queue the rows shown first. The previous search's flow was cancelled
+// along with its token.
+void StartPrefetch(Session& session) {
+    session.prefetch_running = false;
+    session.prefetch_queue.clear();
+    session.prefetch_requested.clear();
+    std::size_t count = std::min<std::size_t>(kPrefetchTopResults, session.movie_list.size());
+    for (std::size_t i = 0; i < count; ++i) {
+        QueuePrefetch(session, session.movie_list[i]->id, false);
+    }
+}
+
+bool UserLogin(Session& session, const std::string& username) {
     std::string exePath = GetExecutablePath();
     std::string userDirPath = exePath + "/" + USER_DIRECTORY;
 
@@ -1572,8 +2169,10 @@ bool UserLogin(const std::string& username) {
     fs::path user_file = fs::path(userDirPath) / (username + ".txt");
     if (fs::exists(user_file)) {
         // User exists, load their watch list
-        current_user = username;
-        LoadWatchList(username);
+        session.current_user = username;
+        session.greeting = "Hello " + session.current_user;
+        LoadWatchList(session, username);
+        StartHydration(session);
         return true;
     }
     else {
@@ -1581,62 +2180,64 @@ bool UserLogin(const std::string& username) {
         std::ofstream file(user_file);
         if (file.is_open()) {
             file.close();
-            current_user = username;
-            watch_list.clear();
-            watch_list_titles.clear();
+            session.current_user = username;
+            session.greeting = "Hello " + session.current_user;
+            LoadWatchList(session, username);
             return true;
         }
     }
     return false;
 }
 
-void Logout() {
-    current_user = "";
-    watch_list.clear();
-    watch_list_titles.clear();
-    ResetApplication();
-}
-
-bool compareMoviesByTitle(const Movie& a, const Movie& b, bool ascending) {
-    return ascending ? (a.title < b.title) : (a.title > b.title);
+void Logout(Session& session) {
+    session.import_token.cancel();
+    StopHydration(session);
+    session.watch_list_store.Close();
+    session.current_user = "";
+    session.greeting.clear();
+    session.watch_list.clear();
+    ResetApplication(session);
 }
 
-bool compareMoviesByYear(const Movie& a, const Movie& b, bool ascending) {
-    return ascending ? (a.release_year < b.release_year) : (a.release_year > b.release_year);
-}
-
-void sortWatchList() {
-    std::sort(watch_list.begin(), watch_list.end(),
-              [](const Movie& a, const Movie& b) {
-                  if (sort_watch_list_by_year) {
-                      return compareMoviesByYear(a, b, sort_watch_list_ascending);
-                  }
-                  else {
-                      return compareMoviesByTitle(a, b, sort_watch_list_ascending);
-                  }
-              });
+// The watch list keeps both orderings up to date, so this only switches views
+void sortWatchList(Session& session) {
+    session.watch_list.set_view(session.sort_watch_list_by_year ? WatchList::Order::Year : WatchList::Order::Title,
+                        session.sort_watch_list_ascending);
+    if (session.current_selected_list == SelectedList::WatchList && session.selected_movie_index != -1) {
+        session.selected_movie_index = int(session.watch_list.row_of(session.selected_movie->id));
+    }
 }
 
-void sortMovieList() {
-    std::sort(movie_list.begin(), movie_list.end(),
-              [](const Movie& a, const Movie& b) {
-                  if (sort_movie_list_by_year) {
-                      return compareMoviesByYear(a, b, sort_movie_list_ascending);
-                  }
-                  else {
-                      return compareMoviesByTitle(a, b, sort_movie_list_ascending);
-                  }
-              });
+// Re-sorts only when the column changed or the contents were replaced; a direction flip is a reverse
+void sortMovieList(Session& session) {
+    ScopedTimer timer(frame_profiler, SECTION_SORT);
+    AllocScope alloc_scope(alloc_tracker, ALLOC_SCOPE_SORT);
+    movie_sort::Sort(session.movie_list, session.movie_list_sort,
+                     session.sort_movie_list_by_year ? movie_sort::Column::Year : movie_sort::Column::Title,
+                     session.sort_movie_list_ascending);
+    if (session.current_selected_list == SelectedList::SearchResults && session.selected_movie_index != -1) {
+        auto it = std::find(session.movie_list.begin(), session.movie_list.end(), session.selected_movie);
+        session.selected_movie_index = it == session.movie_list.end() ? -1 : int(it - session.movie_list.begin());
+    }
 }
 
-void read_api_key() {
-    std::string exePath = GetExecutablePath();
-    std::string apiKeyPath = exePath + "/api_key.txt";
-    std::ifstream file(apiKeyPath);
-    if (file.is_open()) {
-        std::getline(file, api_key);
-        file.close();
-    } else {
-        std::cerr << "Unable to open api_key.txt at path: " << apiKeyPath << std::endl;
+// Offline notice and today's API usage at the bottom of the right column; per-key detail on hover
+void DrawNetworkStatus(Session& session) {
+    if (session.engine.circuit_breakers.GetState(kOmdbHost) != CircuitBreaker::State::Closed) {
+        ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.0f, 1.0f), "OMDb unreachable - showing cached results only");
+    }
+    QuotaManager::Totals totals = session.engine.omdb_quota.GetTotals();
+    if (totals.keys == 0) {
+        ImGui::TextDisabled("No OMDb API key (api_key.txt)");
+        return;
+    }
+    ImGui::TextDisabled("API requests today: %d / %d", totals.used, totals.limit);
+    if (ImGui::IsItemHovered()) {
+        ImGui::BeginTooltip();
+        session.engine.omdb_quota.ForEachKey([](const char* label, int used, int limit, double tokens, bool exhausted) {
+            ImGui::Text("...%s  %d / %d  (%.0f ready)%s", label, used, limit, tokens, exhausted ? "  exhausted" : "");
+        });
+        ImGui::Text("Prefetch today: %d", totals.speculative_used);
+        ImGui::EndTooltip();
     }
 }